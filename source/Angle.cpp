@@ -0,0 +1,133 @@
+/*---------------------------------------------------------------------------------
+
+Angle.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Angle.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// sin(i * 90 / 256) in 4.12, one extra entry so the last step can lerp
+static const short SIN_TABLE[257] = {
+    0, 25, 50, 75, 101, 126, 151, 176, 201, 226, 251, 276, 301, 326, 351, 376,
+    401, 426, 451, 476, 501, 526, 551, 576, 601, 626, 651, 675, 700, 725, 750,
+    774, 799, 824, 848, 873, 897, 922, 946, 971, 995, 1020, 1044, 1068, 1092,
+    1117, 1141, 1165, 1189, 1213, 1237, 1261, 1285, 1309, 1332, 1356, 1380,
+    1404, 1427, 1451, 1474, 1498, 1521, 1544, 1567, 1591, 1614, 1637, 1660,
+    1683, 1706, 1729, 1751, 1774, 1797, 1819, 1842, 1864, 1886, 1909, 1931,
+    1953, 1975, 1997, 2019, 2041, 2062, 2084, 2106, 2127, 2149, 2170, 2191,
+    2213, 2234, 2255, 2276, 2296, 2317, 2338, 2359, 2379, 2399, 2420, 2440,
+    2460, 2480, 2500, 2520, 2540, 2559, 2579, 2598, 2618, 2637, 2656, 2675,
+    2694, 2713, 2732, 2751, 2769, 2788, 2806, 2824, 2843, 2861, 2878, 2896,
+    2914, 2932, 2949, 2967, 2984, 3001, 3018, 3035, 3052, 3068, 3085, 3102,
+    3118, 3134, 3150, 3166, 3182, 3198, 3214, 3229, 3244, 3260, 3275, 3290,
+    3305, 3320, 3334, 3349, 3363, 3378, 3392, 3406, 3420, 3433, 3447, 3461,
+    3474, 3487, 3500, 3513, 3526, 3539, 3551, 3564, 3576, 3588, 3600, 3612,
+    3624, 3636, 3647, 3659, 3670, 3681, 3692, 3703, 3713, 3724, 3734, 3745,
+    3755, 3765, 3775, 3784, 3794, 3803, 3812, 3822, 3831, 3839, 3848, 3857,
+    3865, 3873, 3881, 3889, 3897, 3905, 3912, 3920, 3927, 3934, 3941, 3948,
+    3954, 3961, 3967, 3973, 3979, 3985, 3991, 3996, 4002, 4007, 4012, 4017,
+    4022, 4027, 4031, 4036, 4040, 4044, 4048, 4052, 4055, 4059, 4062, 4065,
+    4068, 4071, 4074, 4076, 4079, 4081, 4083, 4085, 4087, 4088, 4090, 4091,
+    4092, 4093, 4094, 4095, 4095, 4096, 4096, 4096,
+};
+
+// atan(i / 256) in quarter binary angles, so the lerp rounds once at the
+// end. 16384 is 45 degrees.
+static const short ATAN_TABLE[257] = {
+    0, 81, 163, 244, 326, 407, 489, 570, 652, 733, 814, 896, 977, 1058, 1140,
+    1221, 1302, 1383, 1464, 1545, 1626, 1707, 1788, 1869, 1950, 2031, 2111,
+    2192, 2273, 2353, 2434, 2514, 2594, 2674, 2754, 2834, 2914, 2994, 3074,
+    3154, 3233, 3313, 3392, 3472, 3551, 3630, 3709, 3788, 3866, 3945, 4024,
+    4102, 4180, 4259, 4337, 4415, 4493, 4570, 4648, 4725, 4803, 4880, 4957,
+    5034, 5110, 5187, 5264, 5340, 5416, 5492, 5568, 5644, 5719, 5795, 5870,
+    5945, 6020, 6095, 6170, 6244, 6318, 6393, 6467, 6540, 6614, 6688, 6761,
+    6834, 6907, 6980, 7052, 7125, 7197, 7269, 7341, 7413, 7484, 7556, 7627,
+    7698, 7769, 7839, 7910, 7980, 8050, 8120, 8189, 8259, 8328, 8397, 8466,
+    8535, 8603, 8671, 8740, 8807, 8875, 8943, 9010, 9077, 9144, 9211, 9277,
+    9344, 9410, 9476, 9541, 9607, 9672, 9737, 9802, 9867, 9931, 9995, 10060,
+    10123, 10187, 10250, 10314, 10377, 10440, 10502, 10565, 10627, 10689, 10751,
+    10812, 10874, 10935, 10996, 11057, 11117, 11177, 11238, 11298, 11357, 11417,
+    11476, 11535, 11594, 11653, 11711, 11770, 11828, 11886, 11943, 12001, 12058,
+    12115, 12172, 12229, 12285, 12341, 12397, 12453, 12509, 12564, 12619, 12674,
+    12729, 12784, 12838, 12893, 12947, 13000, 13054, 13107, 13161, 13214, 13267,
+    13319, 13372, 13424, 13476, 13528, 13579, 13631, 13682, 13733, 13784, 13835,
+    13885, 13936, 13986, 14036, 14086, 14135, 14184, 14234, 14283, 14331, 14380,
+    14428, 14477, 14525, 14573, 14620, 14668, 14715, 14762, 14809, 14856, 14903,
+    14949, 14995, 15041, 15087, 15133, 15179, 15224, 15269, 15314, 15359, 15404,
+    15448, 15492, 15536, 15580, 15624, 15668, 15711, 15755, 15798, 15841, 15883,
+    15926, 15969, 16011, 16053, 16095, 16137, 16178, 16220, 16261, 16302, 16343,
+    16384,
+};
+
+static const int SIN_STEP_SHIFT = 5;    // Binary angle units per sine table step
+static const int ATAN_RATIO_SHIFT = 16; // Fixed point of the folded tangent
+static const int ATAN_TABLE_SHIFT = 2;  // ATAN_TABLE's bits below a unit
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Sine of an angle within the first quarter turn
+ */
+static int quarterSin(int angle) {
+  int index = angle >> SIN_STEP_SHIFT;
+  int frac = angle & ((1 << SIN_STEP_SHIFT) - 1);
+  if (frac == 0) return SIN_TABLE[index];
+  int step = SIN_TABLE[index + 1] - SIN_TABLE[index];
+  return SIN_TABLE[index] +
+         ((step * frac + (1 << (SIN_STEP_SHIFT - 1))) >> SIN_STEP_SHIFT);
+}
+
+/**
+ * @brief atan(small / large) for 0 <= small <= large, large > 0
+ */
+static int octantAtan(int small, int large) {
+  int ratio = (small << ATAN_RATIO_SHIFT) / large;
+  int index = ratio >> 8;
+  int frac = ratio & 0xFF;
+  if (index >= 256) return ANGLE_EIGHTH;
+  int step = ATAN_TABLE[index + 1] - ATAN_TABLE[index];
+  int shift = 8 + ATAN_TABLE_SHIFT;
+  return ((ATAN_TABLE[index] << 8) + step * frac + (1 << (shift - 1))) >>
+         shift;
+}
+
+int angleSin(int angle) {
+  angle &= ANGLE_MASK;
+  // Mirror the quarter wave into the other three quadrants
+  if (angle < ANGLE_QUARTER) return quarterSin(angle);
+  if (angle < ANGLE_HALF) return quarterSin(ANGLE_HALF - angle);
+  if (angle < ANGLE_HALF + ANGLE_QUARTER)
+    return -quarterSin(angle - ANGLE_HALF);
+  return -quarterSin(ANGLE_CIRCLE - angle);
+}
+
+int angleCos(int angle) { return angleSin(angle + ANGLE_QUARTER); }
+
+int angleAtan2(int y, int x) {
+  if (x == 0 && y == 0) return 0;
+  int ax = x < 0 ? -x : x;
+  int ay = y < 0 ? -y : y;
+
+  // Fold into the first octant, then unfold into the right quadrant
+  int angle =
+      ay <= ax ? octantAtan(ay, ax) : ANGLE_QUARTER - octantAtan(ax, ay);
+  if (x < 0) angle = ANGLE_HALF - angle;
+  if (y < 0) angle = ANGLE_CIRCLE - angle;
+  return angle & ANGLE_MASK;
+}
@@ -0,0 +1,77 @@
+#ifndef ANGLE_H
+#define ANGLE_H
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Binary angles, a full turn is the same 32768 libnds' oamRotateScale takes
+const int ANGLE_CIRCLE = 1 << 15;
+const int ANGLE_MASK = ANGLE_CIRCLE - 1;
+const int ANGLE_HALF = ANGLE_CIRCLE / 2;
+const int ANGLE_QUARTER = ANGLE_CIRCLE / 4;
+const int ANGLE_EIGHTH = ANGLE_CIRCLE / 8;
+
+const int TRIG_SHIFT = 12;            // Sines and cosines are 4.12
+const int TRIG_ONE = 1 << TRIG_SHIFT; // sin(90)
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Converts whole degrees to a binary angle
+ */
+constexpr int angleFromDegrees(int degrees) {
+  return degrees * ANGLE_CIRCLE / 360;
+}
+
+/**
+ * @brief Wraps any binary angle into [0, ANGLE_CIRCLE)
+ */
+inline int wrapAngle(int angle) { return angle & ANGLE_MASK; }
+
+/**
+ * @brief The signed shortest turn from one angle to another
+ * @return A binary angle in [-ANGLE_HALF, ANGLE_HALF)
+ */
+inline int angleDelta(int from, int to) {
+  return ((to - from + ANGLE_HALF) & ANGLE_MASK) - ANGLE_HALF;
+}
+
+/**
+ * @brief Sine of a binary angle from a quarter wave table, within 1 / 4096
+ *        of the real sine (utils/anglebench checks)
+ * @return 4.12 fixed point
+ */
+int angleSin(int angle);
+
+/**
+ * @brief Cosine of a binary angle from a quarter wave table
+ * @return 4.12 fixed point
+ */
+int angleCos(int angle);
+
+/**
+ * @brief The angle of the vector (x, y), like atan2(y, x). The vector is
+ *        folded into the first octant and looked up in an atan table, so
+ *        it is within 0.75 of a binary angle unit (utils/anglebench
+ *        checks). Components must stay below 32768 in magnitude.
+ * @return A binary angle in [0, ANGLE_CIRCLE), 0 for the zero vector
+ */
+int angleAtan2(int y, int x);
+
+/**
+ * @brief Interpolates num/den of the way from a to b, rounded to nearest
+ * @param den Must be positive
+ */
+inline int lerpInt(int a, int b, int num, int den) {
+  int scaled = (b - a) * num;
+  return a + (scaled >= 0 ? scaled + den / 2 : scaled - den / 2) / den;
+}
+
+#endif // ANGLE_H
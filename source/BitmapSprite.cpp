@@ -1,4 +1,5 @@
 #include "BitmapSprite.h"
+#include "Stage.h"
 
 //-------------------------------------------------------------------------------
 //
@@ -57,6 +58,7 @@ void BitmapSprite::setBitmapData(const unsigned int *bitmapData, int bitDepth,
                                palette_data,    // Palette data
                                (u8 *)bitmapData // Bitmap data
   );
+  Stage::memory.add(MEM_TEXTURE_VRAM, 8 * 8 * bitDepth / 8 + paletteWidth * 2);
 }
 
 void BitmapSprite::setPaletteData(const u16 *palette) {
@@ -67,32 +69,31 @@ void BitmapSprite::setPaletteData(const u16 *palette) {
 // Render Functions
 //-------------------------------------------------------------------------------
 
-void BitmapSprite::draw() {
+void BitmapSprite::draw(DrawList &list) {
   if (!visible) return;
 
   int BULLET_RENDER_PRIORITY = 0;
-  int SCALE_FACTOR = 1;
 
   if (rotation_angle > 0) {
     // Enable alpha blending and anti-aliasing for smoother rotation
-    glPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE | POLY_FORMAT_LIGHT0 |
-              POLY_MODULATION | POLY_ID(BULLET_RENDER_PRIORITY));
+    list.setPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE | POLY_FORMAT_LIGHT0 |
+                    POLY_MODULATION | POLY_ID(BULLET_RENDER_PRIORITY));
 
     // Calculate center point for rotation
     int centerX = pos.x + (sprite_image[0].width >> 1);
     int centerY = pos.y + (sprite_image[0].height >> 1);
 
     // Use glSpriteRotateScale for better quality
-    glSpriteRotateScale(centerX, centerY, degreesToAngle(360 - rotation_angle),
-                        inttof32(SCALE_FACTOR), // Scale = 1.0
-                        GL_FLIP_NONE, &sprite_image[0]);
+    list.spriteRotated(centerX, centerY, degreesToAngle(360 - rotation_angle),
+                       &sprite_image[0]);
   } else {
     // Set higher priority number to make bullets render underneath tanks
-    glPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE | GL_TEXTURE_COLOR0_TRANSPARENT |
-              POLY_ID(BULLET_RENDER_PRIORITY)); // Priority 3 = underneath tanks
+    list.setPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE |
+                    GL_TEXTURE_COLOR0_TRANSPARENT |
+                    POLY_ID(BULLET_RENDER_PRIORITY)); // Priority 3 = underneath tanks
 
     // Use gl2d's sprite drawing function
-    glSprite(pos.x + sprite_offset.x, pos.y + sprite_offset.y, GL_FLIP_NONE,
-             &sprite_image[0]);
+    list.sprite(pos.x + sprite_offset.x, pos.y + sprite_offset.y,
+                &sprite_image[0]);
   }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef BITMAP_SPRITE_H
 #define BITMAP_SPRITE_H
 
+#include "DrawList.h"
 #include "Position.h"
 #include <gl2d.h>
 #include <nds.h>
@@ -26,7 +27,7 @@ public:
                      u32 width);
   void setPaletteData(const u16 *palette);
 
-  virtual void draw();
+  virtual void draw(DrawList &list);
 };
 
 #endif // BITMAP_SPRITE_H
\ No newline at end of file
@@ -11,9 +11,10 @@ Camdyn Rasque
 //---------------------------------------------------------------------------------
 
 #include "Bullet.h"
+#include "Angle.h"
 #include "Tank.h"
+#include "Tcm.h"
 #include "bullet-sprite.h"
-#include "math.h"
 
 //---------------------------------------------------------------------------------
 //
@@ -21,94 +22,73 @@ Camdyn Rasque
 //
 //---------------------------------------------------------------------------------
 
-float Bullet::calculateReflectionDirection(BulletRicochetDir wallDir) {
-  switch (wallDir) {
-  case B_RIC_DIR_CORNER:
-    // For corners, reflect back 180 degrees
-    return fmod(direction + 180.0f, 360.0f);
-  case B_RIC_DIR_N:
-    if (direction < 90 && direction > 0) return 540 - direction;
-    else if (direction > 270)
-      return 180 - direction;
-    else
-      return 180;
-    break;
-  case B_RIC_DIR_S:
-    if (direction > 180) return 540 - direction;
-    else if (direction < 180)
-      return 180 - direction;
-    else
-      return 0;
-    break;
-  case B_RIC_DIR_E:
-    return 360 - direction;
-    break;
-  case B_RIC_DIR_W:
-    return 360 - direction;
-    break;
-  default:
-    return 0;
-  }
-}
-
-BulletRicochetDir Bullet::checkForRicochet(Position &pos) {
+RICOCHET_CODE const WallSegment *Bullet::findFaceAhead(bool alongX,
+                                                      int step) {
   // Adjusted position for gap in sprite pixels from edge of tile
   int adjPosX = pos.x + 13;
   int adjPosY = pos.y + 13;
 
-  bool northCollision = false;
-  bool southCollision = false;
-  bool eastCollision = false;
-  bool westCollision = false;
-
-  // Check North and South
-  for (int i = 1; i < width - 1; ++i) {
-      if (adjPosY <= 0 || stage->barriers[adjPosY][adjPosX + i] == 1) return B_RIC_DIR_N;
-      if (adjPosY + height - 1 >= SCREEN_HEIGHT || stage->barriers[adjPosY + height - 1][adjPosX + i] == 1) return B_RIC_DIR_S;
-  }
-  // Check East and West
-  for (int i = 1; i < height - 1; ++i) {
-      if (adjPosX <= 0 || stage->barriers[adjPosY + i][adjPosX] == 1) return B_RIC_DIR_W;
-      if (adjPosX + width - 1 >= SCREEN_WIDTH || stage->barriers[adjPosY + i][adjPosX + width - 1] == 1) return B_RIC_DIR_E;
+  // The leading edge, less its corner pixels
+  if (alongX) {
+    int line = step > 0 ? adjPosX + width : adjPosX;
+    return stage->walls.findFace(line, true, adjPosY + 1,
+                                 adjPosY + height - 1, -step);
   }
+  int line = step > 0 ? adjPosY + height : adjPosY;
+  return stage->walls.findFace(line, false, adjPosX + 1, adjPosX + width - 1,
+                               -step);
+}
 
-  // Check for corner collisions
-  if ((northCollision && eastCollision) || 
-      (northCollision && westCollision) ||
-      (southCollision && eastCollision) || 
-      (southCollision && westCollision)) {
-      return B_RIC_DIR_CORNER;
+RICOCHET_CODE void Bullet::ricochet(const WallSegment *face) {
+  // Sparks fly off the face
+  Position center = getCenter();
+  Stage::particles.emit(PARTICLES_RICOCHET, center.x, center.y,
+                        angleAtan2(face->ny, face->nx));
+  Stage::telemetry.event(TELEMETRY_RICOCHET, tank->color, center.x, center.y);
+  if (num_ricochets >= max_ricochets) {
+    explode();
+    return;
   }
+  num_ricochets++;
 
-  // Regular directional checks
-  if (northCollision) return B_RIC_DIR_N;
-  if (southCollision) return B_RIC_DIR_S;
-  if (eastCollision) return B_RIC_DIR_E;
-  if (westCollision) return B_RIC_DIR_W;
-
-  return B_NO_RICOCHET; // No collisions with barriers
+  // Normals are unit axes, so reflecting (v - 2(v.n)n) just flips the
+  // velocity along the normal. The fraction on that axis starts afresh.
+  if (face->nx != 0) {
+    velocity.x = -velocity.x;
+    sub_pixel.x = 0;
+  }
+  if (face->ny != 0) {
+    velocity.y = -velocity.y;
+    sub_pixel.y = 0;
+  }
 }
 
-void Bullet::updateDirection(float direction, BulletRicochetDir wallDir) {
-  this->direction = direction;
-
-  // Convert to standard mathematical angle (clockwise from East = 0°)
-  float math_angle = 90 - direction;
-  float angle_rad = math_angle * (M_PI / 180.0f);
+bool Bullet::isInsideWall() {
+  int adjPosX = pos.x + 13;
+  int adjPosY = pos.y + 13;
+  for (int y = adjPosY; y < adjPosY + height; y++) {
+    for (int x = adjPosX; x < adjPosX + width; x++) {
+      if (!stage->terrain.inBounds(x, y)) return true;
+      if (stage->terrain.blocksBullets(x, y)) return true;
+    }
+  }
+  return false;
+}
 
-  // Calculate velocity components
-  velocity = {-cosf(angle_rad) * speed, -sinf(angle_rad) * speed};
-  // Reset sub_pixel
-  sub_pixel = {0.0f, 0.0f};
+void Bullet::onReloadTimer(void *context) {
+  Bullet *bullet = (Bullet *)context;
+  if (bullet->has_exploded) bullet->reset();
 }
 
 void Bullet::reset() {
+  stage->live_bullets.remove(&live_hook);
+  stage->bullet_grid.remove(&grid_hook);
+
   // Hide the bullet
   in_flight = false;
   hide = true;
   has_exploded = false;
   // Reset variables back to zero
-  direction = 0;
   num_ricochets = 0;
   pos = {0, 0};
   velocity = {0, 0};
@@ -121,146 +101,171 @@ void Bullet::reset() {
 //
 //-------------------------------------------------------------------------------
 
-Bullet::Bullet(Stage *stage, Tank *tank, BulletSpeed speed, int max_ricochets)
-    : stage(stage), tank(tank), speed(speed), max_ricochets(max_ricochets) {
+Bullet::Bullet() {
+  // Set the animation from the sprite atlas
+  this->anim = SPRITE_ANIM_BULLET;
 
-  // Set sprite sheet position
-  this->sprite_sheet_pos = {3, 13};
-
-  // Assign an ID
-  this->id = Sprite::num_sprites++;
-  this->palette_alpha = this->id;
-  this->affine_index = -1;
+  this->rank = S_RANK_BULLET;
   this->priority = 2;
   // Hide until shown on screen
   this->hide = true;
+}
+
+Bullet::~Bullet() { detach(); }
+
+void Bullet::attach(Stage *stage, Tank *tank, BulletSpeed speed,
+                    int max_ricochets) {
+  this->stage = stage;
+  this->tank = tank;
+  this->speed = speed;
+  this->max_ricochets = max_ricochets;
+
+  // Whatever the last stage left it doing
+  reset();
+  fired_frame = -1;
 
-  // Initialize the ricochet effect graphics
-  this->ricochet_effect = new Sprite();
-  this->ricochet_effect->id = Sprite::num_sprites++;
-  this->ricochet_effect->sprite_sheet_pos = {1, 11};
-  this->ricochet_effect->palette_alpha = this->ricochet_effect->id;
-  this->ricochet_effect->affine_index = -1;
-  this->ricochet_effect->priority = 2;
-  this->ricochet_effect->num_anim_frames = 3;
-  this->ricochet_effect->anim_speed = 3;
-  this->ricochet_effect->hide = true;
-
-  // Initialize graphics and copy to VRAM
+  // Initialize graphics, shared with every other bullet
   this->initGfx();
-  this->copyGfxFrameToVRAM();
-  this->ricochet_effect->initGfx();
-  this->ricochet_effect->copyGfxFrameToVRAM();
+}
+
+void Bullet::detach() {
+  if (stage == nullptr) return;
+
+  stage->live_bullets.remove(&live_hook);
+  stage->bullet_grid.remove(&grid_hook);
+  Stage::timers.cancel(&reload_timer);
+  releaseGfx();
+  stage = nullptr;
+  tank = nullptr;
 }
 
 void Bullet::fire() {
   this->in_flight = true;
   this->hide = false;
+  stage->live_bullets.pushBack(&live_hook);
 
   // Grab initial position from tank
   this->pos = tank->getOffsetPosition();
-  // Convert angle to radians and adjust for coordinate system
-  float rotation_angle = tank->turret->rotation_angle;
-  float angle_rad = rotation_angle * M_PI / 180.0f;
+  // Turret angles start at +y, so the barrel points along (-sin, -cos)
+  int sine = angleSin(tank->turret->rotation_angle);
+  int cosine = angleCos(tank->turret->rotation_angle);
+  // The first frame sweeps out of the barrel, so anything right in front
+  // of the turret is still hit
+  this->swept_from = this->pos;
+  this->fired_frame = Stage::frame_counter;
   // Update position based on rotation angle
-  this->pos.x -= (int)(12 * sin(angle_rad));
-  this->pos.y -= (int)(12 * cos(angle_rad));
+  this->pos.x -= 12 * sine / TRIG_ONE;
+  this->pos.y -= 12 * cosine / TRIG_ONE;
 
-  // Update the position of the ricochet effect and show it
-  ricochet_effect->pos = this->pos;
-  this->ricochet_effect->hide = false;
+  // Aim along the turret, trig is only needed here, bounces just flip signs
+  velocity = {-sine * speed * SUBPIXEL_ONE / TRIG_ONE,
+              -cosine * speed * SUBPIXEL_ONE / TRIG_ONE};
+  sub_pixel = {0, 0};
 
-  // Update direction based on tank turret rotation
-  updateDirection(rotation_angle, B_NO_RICOCHET);
-}
+  Position center = getCenter();
+  Stage::particles.emit(PARTICLES_MUZZLE_FLASH, center.x, center.y,
+                        angleAtan2(velocity.y, velocity.x));
+  Stage::telemetry.event(TELEMETRY_FIRE, tank->color, center.x, center.y);
 
-void Bullet::updatePosition() {
-  if (!in_flight) return;
+  // Fired point blank into a wall, it pops straight away
+  if (isInsideWall()) {
+    explode();
+    return;
+  }
 
-  // Animate the ricochet effect if it is active
-  if (!ricochet_effect->hide) {
-    ricochet_effect->copyGfxFrameToVRAM();
-    ricochet_effect->incrementAnimationFrame(false, false);
+  stage->bullet_grid.move(&grid_hook, center.x, center.y);
+}
 
-    // Check if animation finished (reached last frame)
-    if (has_exploded) {
-      hide = true;
-      if (ricochet_effect->hide) reset();
-      return;
-    }
-  }
+BULLET_MOVE_CODE void Bullet::updatePosition() {
+  // Exploded bullets wait out their reload
+  if (!in_flight || has_exploded) return;
+  if (fired_frame != Stage::frame_counter) swept_from = pos;
 
   // Keep track of sub-pixel position
   sub_pixel.x += velocity.x;
   sub_pixel.y += velocity.y;
-
-  Position newPos = { pos.x, pos.y };
-  Position stepPos = { pos.x, pos.y };
   bool collision = false;
 
   // Handle X movement one pixel at a time
-  while (sub_pixel.x >= 1.0f || sub_pixel.x <= -1.0f) {
+  while (sub_pixel.x >= SUBPIXEL_ONE || sub_pixel.x <= -SUBPIXEL_ONE) {
     int step = (sub_pixel.x > 0) ? 1 : -1;
-    stepPos.x += step;
-    
-    BulletRicochetDir dir = checkForRicochet(stepPos);
-    if (dir != B_NO_RICOCHET) {
+    const WallSegment *face = findFaceAhead(true, step);
+    if (face != nullptr) {
       collision = true;
-      // Show the ricochet effect
-      this->ricochet_effect->hide = false;
-      if (num_ricochets < max_ricochets) {
-        num_ricochets++;
-        float new_dir = calculateReflectionDirection(dir);
-        updateDirection(new_dir, dir);
-      } else {
-        explode();
-      }
+      ricochet(face);
       break;
     }
-    
-    newPos.x = stepPos.x;
-    sub_pixel.x += (step > 0) ? -1.0f : 1.0f;
+    pos.x += step;
+    sub_pixel.x -= step * SUBPIXEL_ONE;
   }
 
   // Only check Y movement if no X collision occurred
   if (!collision) {
-    while (sub_pixel.y >= 1.0f || sub_pixel.y <= -1.0f) {
+    while (sub_pixel.y >= SUBPIXEL_ONE || sub_pixel.y <= -SUBPIXEL_ONE) {
       int step = (sub_pixel.y > 0) ? 1 : -1;
-      stepPos.y += step;
-      
-      BulletRicochetDir dir = checkForRicochet(stepPos);
-      if (dir != B_NO_RICOCHET) {
-        // Show the ricochet effect
-        this->ricochet_effect->hide = false;
-        if (num_ricochets < max_ricochets) {
-          num_ricochets++;
-          float new_dir = calculateReflectionDirection(dir);
-          updateDirection(new_dir, dir);
-        } else {
-          explode();
-        }
+      const WallSegment *face = findFaceAhead(false, step);
+      if (face != nullptr) {
+        ricochet(face);
         break;
       }
-      
-      newPos.y = stepPos.y;
-      sub_pixel.y += (step > 0) ? -1.0f : 1.0f;
+      pos.y += step;
+      sub_pixel.y -= step * SUBPIXEL_ONE;
     }
   }
 
-  pos = newPos;
-  if (ricochet_effect->hide) {
-    ricochet_effect->pos = pos;
+  if (!has_exploded) {
+    Position center = getCenter();
+    stage->bullet_grid.move(&grid_hook, center.x, center.y);
+
+    // A puff of smoke left behind every few frames
+    if ((Stage::frame_counter & (BULLET_TRAIL_INTERVAL - 1)) == 0) {
+      Stage::particles.emit(PARTICLES_BULLET_TRAIL, center.x, center.y,
+                            angleAtan2(-velocity.y, -velocity.x));
+    }
   }
 }
 
 void Bullet::explode() {
-  // Show the ricochet effect
-  this->ricochet_effect->hide = false;
-  // Mark has exploded, let animation finish
+  if (has_exploded) return;
+
+  // Mark has exploded, the bullet reloads once the pop has cleared
   has_exploded = true;
+  hide = true;
+  stage->live_bullets.remove(&live_hook);
+  stage->bullet_grid.remove(&grid_hook);
+  Stage::timers.schedule(&reload_timer, BULLET_RELOAD_FRAMES);
+  updateOAM();
+
+  Position center = getCenter();
+  Stage::particles.emit(PARTICLES_BULLET_POP, center.x, center.y, 0);
+}
+
+Position Bullet::getCenter() {
+  return {pos.x + 13 + width / 2, pos.y + 13 + height / 2};
+}
+
+Tank *Bullet::getOwner() { return tank; }
+
+void Bullet::captureState(BulletState &state) {
+  state = {};
+  state.velocity = velocity;
+  state.sub_pixel = sub_pixel;
+  state.pos = pos;
+  state.in_flight = in_flight;
+  state.has_exploded = has_exploded;
+  state.num_ricochets = num_ricochets;
+  state.hide = hide;
+  Stage::timers.captureState(&reload_timer, state.reload);
 }
 
-void Bullet::updateOAM() {
-  Sprite::updateOAM();
-  ricochet_effect->updateOAM();
+void Bullet::restoreState(const BulletState &state) {
+  velocity = state.velocity;
+  sub_pixel = state.sub_pixel;
+  pos = state.pos;
+  swept_from = state.pos;
+  in_flight = state.in_flight;
+  has_exploded = state.has_exploded;
+  num_ricochets = state.num_ricochets;
+  hide = state.hide;
+  Stage::timers.restoreState(&reload_timer, state.reload);
 }
@@ -1,54 +1,71 @@
 #ifndef BULLET_H
 #define BULLET_H
 
+#include "Kinematics.h"
 #include "Sprite.h"
 #include "Stage.h"
+#include "TankArchetype.h"
 
-enum BulletSpeed { B_SPEED_NORMAL = 2, B_SPEED_FAST = 3 };
-enum BulletRicochetDir {
-  B_NO_RICOCHET,
-  B_RIC_DIR_N,
-  B_RIC_DIR_E,
-  B_RIC_DIR_S,
-  B_RIC_DIR_W,
-  B_RIC_DIR_CORNER
-};
+// Farthest a bullet's box moves in a frame, from the turret to the muzzle
+// plus a step at B_SPEED_FAST
+const int BULLET_MAX_SWEEP = 16;
+
+// Frames between the smoke puffs left behind a bullet, a power of 2
+const int BULLET_TRAIL_INTERVAL = 4;
 
+// Frames after popping before the bullet can be fired again
+const int BULLET_RELOAD_FRAMES = 9;
+
+/**
+ * @brief Pixels per frame in SUBPIXEL_ONE units
+ */
 struct Velocity {
-  float x;
-  float y;
+  int x;
+  int y;
 };
 
-class Bullet : public Sprite {
-private:
-  Stage *stage; // Stage bullet is attached to
-  Tank *tank;   // The tank in the stage the bullet is attached to
+/**
+ * @brief Plain copy of everything that moves a bullet from one frame to the
+ *        next. Fixed layout so snapshots of it delta-compress well.
+ */
+struct BulletState {
   Velocity velocity;
   Velocity sub_pixel;
-  BulletSpeed speed;
-  float direction = 0;
-  int max_ricochets;     // Max number of ricochets allowed
+  Position pos;
+  TimerState reload;
+  u8 in_flight;
+  u8 has_exploded;
+  u8 num_ricochets;
+  u8 hide;
+};
 
-  Sprite *ricochet_effect;
+class Bullet : public Sprite {
+private:
+  Stage *stage = nullptr; // Stage bullet is attached to
+  Tank *tank = nullptr;   // The tank in the stage the bullet is attached to
+  Velocity velocity = {0, 0};
+  Velocity sub_pixel = {0, 0};
+  BulletSpeed speed = B_SPEED_NORMAL;
+  int max_ricochets = 0; // Max number of ricochets allowed
 
   /**
-   * @brief: Checks to see if a wall has been hit
-   * @param wallDir the direction of the wall to reflect against
-   * @returns The direction angle of reflection
+   * @brief: Finds the wall face the bullet would cross moving one pixel
+   * @param alongX Whether the bullet is moving along x (or y)
+   * @param step The direction of the move (1 or -1)
+   * @returns The face, or nullptr if the way is open
    */
-  float calculateReflectionDirection(BulletRicochetDir wallDir);
+  const WallSegment *findFaceAhead(bool alongX, int step);
 
   /**
-   * @brief: Checks to see if a wall has been hit
-   * @param pos The new position to check
-   * @returns BulletRicochetDir The direction the wall was hit
+   * @brief: Bounces off a face by flipping the velocity along its normal,
+   *         or explodes if out of ricochets
    */
-  BulletRicochetDir checkForRicochet(Position &pos);
+  void ricochet(const WallSegment *face);
 
   /**
-   * @brief: Changes directions (for use after hitting wall)
+   * @brief: Whether any visible pixel of the bullet is inside a wall
    */
-  void updateDirection(float direction, BulletRicochetDir wallDir);
+  bool isInsideWall();
 
   /**
    * @brief: After bullet has finished firing, reset all
@@ -56,7 +73,20 @@ private:
    */
   void reset();
 
+  /**
+   * @brief: Reloads an exploded bullet once BULLET_RELOAD_FRAMES have passed
+   */
+  static void onReloadTimer(void *context);
+
 public:
+  Timer reload_timer = Timer(&Bullet::onReloadTimer, this);
+  ListHook<Bullet> live_hook = ListHook<Bullet>(this); // Stage::live_bullets
+  GridHook<Bullet> grid_hook = GridHook<Bullet>(this); // Stage::bullet_grid
+
+  Position swept_from = {0, 0}; // Where the bullet started this frame
+  int fired_frame = -1;         // Stage::frame_counter when last fired
+  int live_index = 0;           // Place in Stage::live_bullets this frame
+
   bool in_flight = false;
   bool has_exploded = false; // True when bullet has hit a tank / wall
   int num_ricochets = 0; // Current number of in-flight ricochets
@@ -64,13 +94,27 @@ public:
   const int width = 6;
 
   /**
-   * @brief: Set initial position and direction for shooting
+   * @brief: An unattached bullet, for a stage's bullet pool (see
+   *         Stage::claimBullets)
+   */
+  Bullet();
+
+  ~Bullet();
+
+  /**
+   * @brief: Hands the bullet to a tank, hidden until fired
    * @param stage The stage to attach the bullet to
    * @param tank The tank in the stage to attach the bullet to
    * @param speed The speed the bullet should travel
    * @param max_ricochets The max number of ricochets the bullet has
    */
-  Bullet(Stage *stage, Tank *tank, BulletSpeed speed, int max_ricochets);
+  void attach(Stage *stage, Tank *tank, BulletSpeed speed, int max_ricochets);
+
+  /**
+   * @brief: Takes the bullet off its stage and lets go of its gfx, so the
+   *         pool can be attached again for the next stage
+   */
+  void detach();
 
   /**
    * @brief: Set initial position and direction for shooting
@@ -83,15 +127,32 @@ public:
   void updatePosition();
 
   /**
-   * @brief: Marks the bullet for explosion so the necessary
-   *         animations can be played and the position resets
+   * @brief: Pops the bullet, it can be fired again once
+   *         BULLET_RELOAD_FRAMES have passed
    */
   void explode();
 
   /**
-   * @brief: Updates the object attribute memory with new data
+   * @brief: The center of the visible bullet within its tile
+   */
+  Position getCenter();
+
+  /**
+   * @brief: The tank that fired the bullet
+   */
+  Tank *getOwner();
+
+  /**
+   * @brief: Copies the bullet's simulation state out
+   * @param state The state to fill in
+   */
+  void captureState(BulletState &state);
+
+  /**
+   * @brief: Overwrites the bullet's simulation state and refreshes its gfx
+   * @param state The state to restore
    */
-  void updateOAM();
+  void restoreState(const BulletState &state);
 };
 
 #endif // BULLET_H
\ No newline at end of file
@@ -0,0 +1,143 @@
+/*---------------------------------------------------------------------------------
+
+Camera.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Camera.h"
+#include "Terrain.h"
+#include <nds.h>
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+u16 *Camera::slot(int tx, int ty) {
+  // A 512 wide map is two 32x32 screen blocks side by side
+  int col = tx % CAMERA_RING_COLS, row = ty % CAMERA_RING_ROWS;
+  return bgGetMapPtr(bg) + (col / 32) * 32 * 32 + row * 32 + col % 32;
+}
+
+void Camera::streamTile(int tx, int ty) {
+  if (tx < 0 || ty < 0 || tx >= arena_width / 8 || ty >= arena_height / 8) {
+    return;
+  }
+  Terrain::uploads.queue(slot(tx, ty), terrain->mapEntry(tx, ty));
+}
+
+void Camera::fillView() {
+  loaded_col = x / 8;
+  loaded_row = y / 8;
+
+  // Nothing of the old view is kept, so writes still queued for it would
+  // only land on the new one
+  u16 *map = bgGetMapPtr(bg);
+  Terrain::uploads.discard(map, map + CAMERA_RING_COLS * CAMERA_RING_ROWS);
+
+  // Straight to VRAM, the view is over three times what the queue holds.
+  // Whatever is drawn before the VBlank shows the new view at the old
+  // scroll, for a frame.
+  int lastCol = loaded_col + CAMERA_VIEW_COLS;
+  int lastRow = loaded_row + CAMERA_VIEW_ROWS;
+  if (lastCol > arena_width / 8) lastCol = arena_width / 8;
+  if (lastRow > arena_height / 8) lastRow = arena_height / 8;
+  for (int ty = loaded_row; ty < lastRow; ty++) {
+    for (int tx = loaded_col; tx < lastCol; tx++) {
+      *(vu16 *)slot(tx, ty) = terrain->mapEntry(tx, ty);
+    }
+  }
+}
+
+void Camera::onTerrainChanged(void *context, int col, int row) {
+  Camera *camera = (Camera *)context;
+  if (camera->bg < 0) return;
+
+  // Tiles out of view are written with the blast when they come back in
+  for (int ty = row * 2; ty < row * 2 + 2; ty++) {
+    for (int tx = col * 2; tx < col * 2 + 2; tx++) {
+      if (tx < camera->loaded_col ||
+          tx >= camera->loaded_col + CAMERA_VIEW_COLS ||
+          ty < camera->loaded_row ||
+          ty >= camera->loaded_row + CAMERA_VIEW_ROWS) {
+        continue;
+      }
+      camera->streamTile(tx, ty);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void Camera::attach(int bg, Terrain *terrain) {
+  this->bg = bg;
+  this->terrain = terrain;
+  arena_width = terrain->getWidth();
+  arena_height = terrain->getHeight();
+  terrain->addListener(&Camera::onTerrainChanged, this);
+
+  x = 0;
+  y = 0;
+  bgSetScroll(bg, 0, 0);
+  fillView();
+}
+
+void Camera::follow(Position target) {
+  // Only scroll once the point nears an edge
+  if (target.x < x + CAMERA_MARGIN_X) x = target.x - CAMERA_MARGIN_X;
+  if (target.x >= x + SCREEN_WIDTH - CAMERA_MARGIN_X) {
+    x = target.x - SCREEN_WIDTH + CAMERA_MARGIN_X + 1;
+  }
+  if (target.y < y + CAMERA_MARGIN_Y) y = target.y - CAMERA_MARGIN_Y;
+  if (target.y >= y + SCREEN_HEIGHT - CAMERA_MARGIN_Y) {
+    y = target.y - SCREEN_HEIGHT + CAMERA_MARGIN_Y + 1;
+  }
+  if (x > arena_width - SCREEN_WIDTH) x = arena_width - SCREEN_WIDTH;
+  if (y > arena_height - SCREEN_HEIGHT) y = arena_height - SCREEN_HEIGHT;
+  if (x < 0) x = 0;
+  if (y < 0) y = 0;
+  if (bg < 0) return;
+
+  int col = x / 8, row = y / 8;
+  if (col != loaded_col || row != loaded_row) {
+    int dc = col - loaded_col, dr = row - loaded_row;
+    if (dc >= CAMERA_VIEW_COLS || -dc >= CAMERA_VIEW_COLS ||
+        dr >= CAMERA_VIEW_ROWS || -dr >= CAMERA_VIEW_ROWS) {
+      // Nothing in view is still on the map
+      fillView();
+    } else {
+      // The columns that came in, then the rows, each across the new view.
+      // They overwrite the ones that just left, which are out of view.
+      int from = dc > 0 ? loaded_col + CAMERA_VIEW_COLS : col;
+      int to = dc > 0 ? col + CAMERA_VIEW_COLS : loaded_col;
+      for (int tx = from; tx < to; tx++) {
+        for (int ty = row; ty < row + CAMERA_VIEW_ROWS; ty++) {
+          streamTile(tx, ty);
+        }
+      }
+      from = dr > 0 ? loaded_row + CAMERA_VIEW_ROWS : row;
+      to = dr > 0 ? row + CAMERA_VIEW_ROWS : loaded_row;
+      for (int ty = from; ty < to; ty++) {
+        for (int tx = col; tx < col + CAMERA_VIEW_COLS; tx++) {
+          streamTile(tx, ty);
+        }
+      }
+      loaded_col = col;
+      loaded_row = row;
+    }
+  }
+
+  // Takes effect with the map writes, both in the VBlank (see bgUpdate)
+  bgSetScroll(bg, x, y);
+}
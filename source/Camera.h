@@ -0,0 +1,106 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "Position.h"
+#include "calico/types.h"
+#include "nds/arm9/video.h"
+
+class Terrain;
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// How close the followed point may get to the edge of the view before it
+// scrolls
+const int CAMERA_MARGIN_X = 96;
+const int CAMERA_MARGIN_Y = 72;
+
+// Map entries a view touches when it isn't on a tile boundary
+const int CAMERA_VIEW_COLS = SCREEN_WIDTH / 8 + 1;
+const int CAMERA_VIEW_ROWS = SCREEN_HEIGHT / 8 + 1;
+
+// The BG map is 512x256, the view's tiles wrap around it
+const int CAMERA_RING_COLS = 64;
+const int CAMERA_RING_ROWS = 32;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * The screen's view of the arena. It follows a point (the player) and
+ * scrolls the stage BG with it. The arena's map can be far bigger than the
+ * hardware's, so only the tiles in view are kept on it, wrapping around: as
+ * the view moves, the row or column coming into it is written over one that
+ * just left, in the VBlank. It also keeps the tiles in view in step with
+ * walls being destroyed. A whole new view (a new stage, or a jump further
+ * than the view) is written straight away instead.
+ *
+ * Everything else works in arena coordinates. SpriteRenderer and DrawList
+ * move what they draw into the view and skip what's outside it.
+ */
+class Camera {
+private:
+  Terrain *terrain = nullptr;
+  int bg = -1;
+  int arena_width = SCREEN_WIDTH;
+  int arena_height = SCREEN_HEIGHT;
+  int loaded_col = 0; // Top left tile of the view on the map
+  int loaded_row = 0;
+
+  /**
+   * @brief Where an arena tile goes on the wrapping BG map
+   */
+  u16 *slot(int tx, int ty);
+
+  /**
+   * @brief Writes an arena tile's current map entry to its slot, in the
+   *        VBlank
+   */
+  void streamTile(int tx, int ty);
+
+  /**
+   * @brief Writes every tile in view straight to the map, on a new stage or
+   *        a jump. That's more writes than the VBlank queue holds.
+   */
+  void fillView();
+
+  /**
+   * @brief Rewrites the tiles of a cell that was blasted (or put back) if
+   *        they're in view
+   */
+  static void onTerrainChanged(void *context, int col, int row);
+
+public:
+  int x = 0; // Top left of the view in the arena
+  int y = 0;
+
+  /**
+   * @brief Shows an arena on a BG layer, from its top left
+   * @param bg A 512x256 text BG
+   * @param terrain The arena's terrain, for its size and map
+   */
+  void attach(int bg, Terrain *terrain);
+
+  /**
+   * @brief Scrolls just enough to keep a point CAMERA_MARGIN_X/Y inside the
+   *        view without showing past the arena, and streams in the tiles
+   *        that came into view. Call once a frame before drawing.
+   */
+  void follow(Position target);
+
+  /**
+   * @brief Whether any of a box in arena coordinates is on screen
+   */
+  bool isVisible(int x, int y, int width, int height) const {
+    return x + width > this->x && y + height > this->y &&
+           x < this->x + SCREEN_WIDTH && y < this->y + SCREEN_HEIGHT;
+  }
+};
+
+#endif // CAMERA_H
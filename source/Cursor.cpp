@@ -11,6 +11,7 @@ Camdyn Rasque
 //---------------------------------------------------------------------------------
 
 #include "Cursor.h"
+#include "Angle.h"
 
 //---------------------------------------------------------------------------------
 //
@@ -24,17 +25,14 @@ void Cursor::createTail() {
     Sprite *tailSegment = new Sprite();
 
     // Set initial sprite data
-    tailSegment->sprite_sheet_pos = {0, 12};
-    tailSegment->id = Sprite::num_sprites++;
-    tailSegment->palette_alpha = tailSegment->id;
-    tailSegment->affine_index = -1;
+    tailSegment->anim = SPRITE_ANIM_CURSOR_TAIL;
+    tailSegment->rank = S_RANK_CURSOR;
     // Hide until shown on screen
     tailSegment->hide = true;
     tailSegment->tile_offset = {15, 15};
 
     // Update the gfx
     tailSegment->initGfx();
-    tailSegment->copyGfxFrameToVRAM();
 
     // Add to tail
     tail.push_back(tailSegment);
@@ -49,22 +47,12 @@ void Cursor::connectToTank(Tank *playerTank) {
   int tankCenterX = tankPos.x + playerTank->body->tile_offset.x;
   int tankCenterY = tankPos.y + playerTank->body->tile_offset.y;
 
-  // Math to connect the two points
-  int dx = pos.x - tankCenterX;
-  int dy = pos.y - tankCenterY;
-  float xIncrement = dx / (float)(numTailSprites + 2);
-  float yIncrement = dy / (float)(numTailSprites + 2);
-  float x = tankCenterX;
-  float y = tankCenterY;
-
-  // Position each tail sprite along the line
-  for (int i = 0; i < numTailSprites + 1; i++) {
-    x += xIncrement;
-    y += yIncrement;
-    if (i < 1) continue;
-    // Update the position of each tail sprite
-    tail[i - 1]->pos = { (int)x, (int)y };
-    tail[i - 1]->hide = false;  // Make sure the sprite is visible
+  // Space the tail evenly along the line, leaving a gap at both ends
+  int steps = numTailSprites + 2;
+  for (int i = 0; i < numTailSprites; i++) {
+    tail[i]->pos = {lerpInt(tankCenterX, pos.x, i + 2, steps),
+                    lerpInt(tankCenterY, pos.y, i + 2, steps)};
+    tail[i]->hide = i % tailStep != 0; // Gaps if the tail is thinned out
   }
 }
 
@@ -75,13 +63,10 @@ void Cursor::connectToTank(Tank *playerTank) {
 //---------------------------------------------------------------------------------
 
 Cursor::Cursor() {
-  // Set sprite sheet position
-  this->sprite_sheet_pos = {0, 11};
+  // Set the animation from the sprite atlas
+  this->anim = SPRITE_ANIM_CURSOR;
 
-  // Assign an ID
-  this->id = Sprite::num_sprites++;
-  this->palette_alpha = this->id;
-  this->affine_index = -1;
+  this->rank = S_RANK_CURSOR;
   // Hide until shown on screen
   this->hide = true;
   this->tile_offset = {16, 16};
@@ -89,9 +74,8 @@ Cursor::Cursor() {
   // Create all of the tail sprites
   createTail();
 
-  // Initialize graphics and copy to VRAM
+  // Initialize graphics
   initGfx();
-  copyGfxFrameToVRAM();
 }
 
 void Cursor::showSprites(Position cursorPos, Tank *playerTank) {
@@ -109,6 +93,8 @@ void Cursor::hideSprites() {
   }
 }
 
+void Cursor::setTailStep(int step) { tailStep = step; }
+
 void Cursor::updateOAM() {
   Sprite::updateOAM();
   for (int i = 0; i < numTailSprites; i++) {
@@ -4,7 +4,6 @@
 #include "Sprite.h"
 #include "Tank.h"
 #include "calico/types.h"
-#include "sprite-sheet.h"
 // #include <gl2d.h>
 #include <vector>
 #include <nds.h>
@@ -21,6 +20,7 @@ private:
   int width = 14;
   std::vector<Sprite*> tail;
   int numTailSprites = 7;
+  int tailStep = 1; // Every nth tail sprite is shown
 
   /**
    * @brief: Creates the necessary tail sprites for the cursor
@@ -57,6 +57,12 @@ public:
    * @brief: Updates the cursor and tail sprites
    */
   void updateOAM();
+
+  /**
+   * @brief: Shows only every nth tail sprite from now on, fewer sprites for
+   * the quality governor
+   */
+  void setTailStep(int step);
 };
 
 //---------------------------------------------------------------------------------
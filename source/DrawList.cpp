@@ -0,0 +1,189 @@
+/*---------------------------------------------------------------------------------
+
+DrawList.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "DrawList.h"
+#include "Stage.h"
+#include <algorithm>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// What each kind of draw costs the geometry engine. gl2d draws lines as a
+// single degenerate triangle and everything else as a quad.
+static const int KIND_POLYGONS[] = {1, 1, 1, 1};
+static const int KIND_VERTICES[] = {3, 4, 4, 4};
+
+// The low bits of a sort key hold the command's index
+static const u64 INDEX_MASK = (1 << 24) - 1;
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void DrawList::add(Kind kind, int x1, int y1, int x2, int y2, u16 color,
+                   const glImage *image) {
+  // Skip what's out of view, move the rest into it
+  int left, top, right, bottom;
+  if (kind == LINE || kind == BOX) {
+    left = x1 < x2 ? x1 : x2;
+    right = x1 < x2 ? x2 : x1;
+    top = y1 < y2 ? y1 : y2;
+    bottom = y1 < y2 ? y2 : y1;
+  } else if (kind == SPRITE) {
+    left = x1;
+    top = y1;
+    right = x1 + image->width;
+    bottom = y1 + image->height;
+  } else {
+    // Any turn stays within the longer side of the center
+    int reach = image->width > image->height ? image->width : image->height;
+    left = x1 - reach;
+    top = y1 - reach;
+    right = x1 + reach;
+    bottom = y1 + reach;
+  }
+  const Camera &camera = Stage::camera;
+  if (!camera.isVisible(left, top, right - left + 1, bottom - top + 1)) {
+    culling++;
+    return;
+  }
+  x1 -= camera.x;
+  y1 -= camera.y;
+  if (kind == LINE || kind == BOX) {
+    x2 -= camera.x;
+    y2 -= camera.y;
+  }
+
+  queued_polygons += KIND_POLYGONS[kind];
+  queued_vertices += KIND_VERTICES[kind];
+
+  int index = commands.size();
+  commands.push_back({poly_fmt, image, (s16)x1, (s16)y1, (s16)x2, (s16)y2,
+                      color, (u8)layer, kind});
+
+  // Layer, then poly ID, alpha and texture, then the order they were added
+  u64 polyId = (poly_fmt >> 24) & 0x3F;
+  u64 alpha = (poly_fmt >> 16) & 0x1F;
+  u64 texture = image ? image->textureID & 0xFFFF : 0;
+  order.push_back((u64)layer << 56 | polyId << 48 | alpha << 40 |
+                  texture << 24 | index);
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+DrawList::DrawList() {
+  MemoryScope scope(Stage::memory, MEM_RENDER);
+  commands.reserve(GL_MAX_POLYGONS);
+  order.reserve(GL_MAX_POLYGONS);
+}
+
+void DrawList::setLayer(DrawLayer layer) { this->layer = layer; }
+
+void DrawList::setPolyFmt(u32 poly_fmt) { this->poly_fmt = poly_fmt; }
+
+void DrawList::line(int x1, int y1, int x2, int y2, u16 color) {
+  add(LINE, x1, y1, x2, y2, color, nullptr);
+}
+
+void DrawList::boxFilled(int x1, int y1, int x2, int y2, u16 color) {
+  add(BOX, x1, y1, x2, y2, color, nullptr);
+}
+
+void DrawList::sprite(int x, int y, const glImage *image) {
+  add(SPRITE, x, y, 0, 0, 0, image);
+}
+
+void DrawList::spriteRotated(int x, int y, int angle, const glImage *image) {
+  add(SPRITE_ROTATED, x, y, angle, 0, 0, image);
+}
+
+int DrawList::spritesLeft() const {
+  int polygons = (GL_MAX_POLYGONS - queued_polygons) / KIND_POLYGONS[SPRITE];
+  int vertices = (GL_MAX_VERTICES - queued_vertices) / KIND_VERTICES[SPRITE];
+  int left = polygons < vertices ? polygons : vertices;
+  return left > 0 ? left : 0;
+}
+
+void DrawList::flush() {
+  std::sort(order.begin(), order.end());
+
+  // Keep as much of the top of the frame as the geometry RAM holds
+  int start = order.size();
+  polygons = 0;
+  vertices = 0;
+  while (start > 0) {
+    Kind kind = commands[order[start - 1] & INDEX_MASK].kind;
+    if (polygons + KIND_POLYGONS[kind] > GL_MAX_POLYGONS ||
+        vertices + KIND_VERTICES[kind] > GL_MAX_VERTICES) {
+      break;
+    }
+    polygons += KIND_POLYGONS[kind];
+    vertices += KIND_VERTICES[kind];
+    start--;
+  }
+  dropped = start;
+
+  state_switches = 0;
+  u32 currentFmt = 0;
+  int currentTexture = -1;
+  glBegin2D();
+  for (int i = start; i < (int)order.size(); i++) {
+    const Command &command = commands[order[i] & INDEX_MASK];
+
+    if (command.poly_fmt != currentFmt || i == start) {
+      glPolyFmt(command.poly_fmt);
+      currentFmt = command.poly_fmt;
+      state_switches++;
+    }
+    int texture = command.image ? command.image->textureID : 0;
+    if (texture != currentTexture) {
+      // Images are tinted by the current color, go back to white for them
+      if (texture != 0) glColor(RGB15(31, 31, 31));
+      currentTexture = texture;
+      state_switches++;
+    }
+
+    switch (command.kind) {
+    case LINE:
+      glLine(command.x1, command.y1, command.x2, command.y2, command.color);
+      break;
+    case BOX:
+      glBoxFilled(command.x1, command.y1, command.x2, command.y2,
+                  command.color);
+      break;
+    case SPRITE:
+      glSprite(command.x1, command.y1, GL_FLIP_NONE, command.image);
+      break;
+    case SPRITE_ROTATED:
+      glSpriteRotateScale(command.x1, command.y1, (u16)command.x2,
+                          inttof32(1), GL_FLIP_NONE, command.image);
+      break;
+    }
+  }
+  glEnd2D();
+
+  commands.clear();
+  order.clear();
+  culled = culling;
+  culling = 0;
+  queued_polygons = 0;
+  queued_vertices = 0;
+}
@@ -0,0 +1,134 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <gl2d.h>
+#include <nds.h>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int GL_MAX_POLYGONS = 2048; // Polygon RAM holds this many per frame
+const int GL_MAX_VERTICES = 6144; // Vertex RAM holds this many per frame
+
+//---------------------------------------------------------------------------------
+//
+// ENUMS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Painter's order of the 3D layer, later layers are drawn on top and
+ *        are the last to be dropped when the frame runs out of geometry
+ */
+enum DrawLayer {
+  D_LAYER_TREADS = 0,
+  D_LAYER_MINES = 1,
+  D_LAYER_PARTICLES = 2,
+  D_LAYER_SPRITES = 3,
+};
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Collects a frame's gl2d draws and emits them together, sorted by layer,
+ * then poly ID, then alpha, then texture, so the poly format and texture
+ * only change between runs instead of on every draw. Draws with the same
+ * key keep the order they were added in.
+ *
+ * Draws are given in arena coordinates and moved into the camera's view as
+ * they're added. Ones entirely out of view are skipped there and then.
+ *
+ * The frame is trimmed to the geometry engine's polygon and vertex RAM
+ * before anything is emitted, dropping from the bottom layer up.
+ */
+class DrawList {
+private:
+  enum Kind : u8 { LINE, BOX, SPRITE, SPRITE_ROTATED };
+
+  struct Command {
+    u32 poly_fmt;
+    const glImage *image; // Textured draws only
+    s16 x1;
+    s16 y1;
+    s16 x2; // Or the angle of a rotated sprite
+    s16 y2;
+    u16 color;
+    u8 layer;
+    Kind kind;
+  };
+
+  std::vector<Command> commands;
+  std::vector<u64> order; // Sort keys, the command index in the low bits
+  u32 poly_fmt = POLY_ALPHA(31) | POLY_CULL_NONE;
+  DrawLayer layer = D_LAYER_TREADS;
+  int culling = 0;         // Out of view so far this frame
+  int queued_polygons = 0; // What the draws queued so far cost
+  int queued_vertices = 0;
+
+  void add(Kind kind, int x1, int y1, int x2, int y2, u16 color,
+           const glImage *image);
+
+public:
+  // What the last flush emitted, for the debug overlay
+  int polygons = 0;       // Polygons sent to the geometry engine
+  int vertices = 0;       // Vertices sent to the geometry engine
+  int state_switches = 0; // Poly format, texture and color changes
+  int dropped = 0;        // Draws that didn't fit in the frame
+  int culled = 0;         // Draws out of view, never queued
+
+  DrawList();
+
+  /**
+   * @brief Sets the layer the next draws go on
+   */
+  void setLayer(DrawLayer layer);
+
+  /**
+   * @brief Sets the poly format of the next draws, like glPolyFmt()
+   */
+  void setPolyFmt(u32 poly_fmt);
+
+  /**
+   * @brief Queues a one pixel line, like glLine()
+   */
+  void line(int x1, int y1, int x2, int y2, u16 color);
+
+  /**
+   * @brief Queues a filled box between two corners, like glBoxFilled()
+   */
+  void boxFilled(int x1, int y1, int x2, int y2, u16 color);
+
+  /**
+   * @brief Queues an image with its top left at a point, like glSprite()
+   */
+  void sprite(int x, int y, const glImage *image);
+
+  /**
+   * @brief Queues an image rotated about its center, like
+   *        glSpriteRotateScale() at a scale of 1
+   * @param angle Binary angle, 32768 per turn
+   */
+  void spriteRotated(int x, int y, int angle, const glImage *image);
+
+  /**
+   * @brief How many more sprites (plain or rotated) fit in the geometry
+   *        engine's polygon and vertex RAM after what's queued this frame
+   */
+  int spritesLeft() const;
+
+  /**
+   * @brief Sorts and emits everything queued this frame inside its own
+   *        glBegin2D()/glEnd2D(), then empties the list
+   */
+  void flush();
+};
+
+#endif // DRAW_LIST_H
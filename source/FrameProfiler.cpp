@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------------
+
+FrameProfiler.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "FrameProfiler.h"
+#include "Tcm.h"
+#include <nds.h>
+#include <stdio.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+static const char *SECTION_NAMES[PROFILE_SECTION_COUNT] = {
+    "input", "ai", "bullets", "collision", "sprites", "gl2d", "minimap",
+    "frame"};
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void FrameProfiler::start() { cpuStartTiming(0); }
+
+void FrameProfiler::begin(ProfileSection section) {
+  started[section] = cpuGetTiming();
+}
+
+void FrameProfiler::end(ProfileSection section) {
+  // Unsigned, so it's right across the timer wrapping too
+  current[section] += cpuGetTiming() - started[section];
+}
+
+void FrameProfiler::beginFrame() {
+  for (int i = 0; i < PROFILE_SECTION_COUNT; i++) current[i] = 0;
+  begin(PROFILE_FRAME);
+}
+
+void FrameProfiler::endFrame() {
+  end(PROFILE_FRAME);
+
+  // Swap the oldest frame in the window for this one
+  for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+    sums[i] += current[i] - history[history_pos][i];
+    history[history_pos][i] = current[i];
+    last[i] = current[i];
+  }
+  history_pos = (history_pos + 1) % PROFILE_WINDOW;
+  if (frames < PROFILE_WINDOW) frames++;
+}
+
+void FrameProfiler::print(int row) {
+  for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+    u32 micros = averageTicks((ProfileSection)i) * 1000 / PROFILE_TICKS_PER_MS;
+    // Marked when the build has a TCM placement this section times
+    printf("\x1b[%d;0H%-9s%c %6lu us", row + i, SECTION_NAMES[i],
+           tcmPlacedIn((ProfileSection)i) ? '*' : ' ', (unsigned long)micros);
+  }
+}
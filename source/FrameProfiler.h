@@ -0,0 +1,103 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include "calico/types.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief The parts of a frame that are timed. PROFILE_FRAME is the whole
+ *        frame up to the VBlank wait.
+ */
+enum ProfileSection {
+  PROFILE_INPUT,     // Buttons and touch
+  PROFILE_AI,        // Computer tanks thinking
+  PROFILE_BULLETS,   // Moving bullets and bouncing them off walls
+  PROFILE_COLLISION, // Bullets against bullets, tanks and mines
+  PROFILE_SPRITES,   // OAM updates, effects, particles and OAM assignment
+  PROFILE_GL2D,      // Building and sorting the gl2d draw list
+  PROFILE_MINIMAP,   // Moving the marks on the bottom screen
+  PROFILE_FRAME,
+  PROFILE_SECTION_COUNT
+};
+
+const int PROFILE_WINDOW = 32; // Frames the rolling averages cover
+// cpuGetTiming counts at the bus clock, 33.51 MHz
+const u32 PROFILE_TICKS_PER_MS = 33514;
+const u32 PROFILE_FRAME_BUDGET = PROFILE_TICKS_PER_MS * 1000 / 60;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Times each section of the frame with the cascaded hardware timers (0 and
+ * 1), keeping the last frame's cost and a rolling average of the last
+ * PROFILE_WINDOW frames. A section may be entered several times a frame,
+ * its times add up.
+ */
+class FrameProfiler {
+private:
+  u32 started[PROFILE_SECTION_COUNT] = {};
+  u32 current[PROFILE_SECTION_COUNT] = {}; // Adding up this frame
+  u32 last[PROFILE_SECTION_COUNT] = {};    // The last whole frame
+  u32 history[PROFILE_WINDOW][PROFILE_SECTION_COUNT] = {};
+  u32 sums[PROFILE_SECTION_COUNT] = {}; // Of history
+  int history_pos = 0;
+  int frames = 0; // Recorded so far, up to PROFILE_WINDOW
+
+public:
+  /**
+   * @brief Starts the hardware timers, once at boot
+   */
+  void start();
+
+  /**
+   * @brief Starts timing a section
+   */
+  void begin(ProfileSection section);
+
+  /**
+   * @brief Stops timing a section, adding to its time this frame
+   */
+  void end(ProfileSection section);
+
+  /**
+   * @brief Starts a new frame
+   */
+  void beginFrame();
+
+  /**
+   * @brief Ends the frame, call before waiting for the VBlank. The frame's
+   *        times move into the rolling averages.
+   */
+  void endFrame();
+
+  /**
+   * @brief A section's time in the last whole frame, in timer ticks
+   */
+  u32 lastTicks(ProfileSection section) { return last[section]; }
+
+  /**
+   * @brief A section's average time over the last PROFILE_WINDOW frames, in
+   *        timer ticks
+   */
+  u32 averageTicks(ProfileSection section) {
+    return frames ? sums[section] / frames : 0;
+  }
+
+  /**
+   * @brief Prints the averages in microseconds on the console, starting at
+   *        a row. Sections a TCM placement in the build should speed up are
+   *        marked with a *, see Tcm.h.
+   */
+  void print(int row);
+};
+
+#endif // FRAME_PROFILER_H
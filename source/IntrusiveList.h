@@ -0,0 +1,91 @@
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Link embedded in an object so it can sit in an IntrusiveList without
+ *        the list allocating. An object needs one hook per list it joins.
+ */
+template <typename T> struct ListHook {
+  T *owner;
+  ListHook *prev = nullptr;
+  ListHook *next = nullptr;
+
+  explicit ListHook(T *owner = nullptr) : owner(owner) {}
+
+  bool linked() const { return next != nullptr; }
+};
+
+/**
+ * Doubly linked list threaded through ListHooks. Adding and removing are O(1)
+ * and safe to repeat. While iterating, the current element may remove itself
+ * but must not remove any other element.
+ */
+template <typename T> class IntrusiveList {
+private:
+  ListHook<T> head; // Sentinel, the list is circular through it
+  int count = 0;
+
+public:
+  class Iterator {
+  private:
+    ListHook<T> *current;
+    ListHook<T> *upcoming; // Saved so current can unlink itself
+
+  public:
+    explicit Iterator(ListHook<T> *hook)
+        : current(hook), upcoming(hook->next) {}
+    T *operator*() const { return current->owner; }
+    Iterator &operator++() {
+      current = upcoming;
+      upcoming = current->next;
+      return *this;
+    }
+    bool operator!=(const Iterator &other) const {
+      return current != other.current;
+    }
+  };
+
+  IntrusiveList() {
+    head.next = &head;
+    head.prev = &head;
+  }
+
+  IntrusiveList(const IntrusiveList &) = delete;
+  IntrusiveList &operator=(const IntrusiveList &) = delete;
+
+  void pushBack(ListHook<T> *hook) {
+    if (hook->linked()) return;
+    hook->next = &head;
+    hook->prev = head.prev;
+    head.prev->next = hook;
+    head.prev = hook;
+    count++;
+  }
+
+  void remove(ListHook<T> *hook) {
+    if (!hook->linked()) return;
+    hook->prev->next = hook->next;
+    hook->next->prev = hook->prev;
+    hook->next = nullptr;
+    hook->prev = nullptr;
+    count--;
+  }
+
+  void clear() {
+    while (head.next != &head) remove(head.next);
+  }
+
+  int size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  Iterator begin() { return Iterator(head.next); }
+  Iterator end() { return Iterator(&head); }
+};
+
+#endif // INTRUSIVE_LIST_H
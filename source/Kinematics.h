@@ -0,0 +1,58 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int SUBPIXEL_SHIFT = 8;                   // Fixed point 24.8
+const int SUBPIXEL_ONE = 1 << SUBPIXEL_SHIFT;   // One whole pixel
+const int DIAGONAL_SCALE = 181;                 // 1/sqrt(2) in 1/256ths
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Sub-pixel motion for a single entity. Whole pixels are handed back to
+ *        the owner to move by, the fraction carries over to the next frame.
+ */
+struct Kinematics {
+  int sub_x = 0; // Fractional x movement carried between frames
+  int sub_y = 0; // Fractional y movement carried between frames
+
+  /**
+   * @brief Accumulates one frame of movement in a compass direction.
+   * @param dx The x direction (-1, 0 or 1).
+   * @param dy The y direction (-1, 0 or 1).
+   * @param speed Pixels per frame in SUBPIXEL_ONE units (along the diagonal
+   *        too, each axis is scaled down when moving diagonally).
+   * @param moveX Set to the whole pixels to move along x.
+   * @param moveY Set to the whole pixels to move along y.
+   */
+  void advance(int dx, int dy, int speed, int &moveX, int &moveY) {
+    int axisSpeed = (dx != 0 && dy != 0)
+                        ? (speed * DIAGONAL_SCALE) >> SUBPIXEL_SHIFT
+                        : speed;
+    sub_x += dx * axisSpeed;
+    sub_y += dy * axisSpeed;
+
+    // Division truncates towards zero so both directions behave the same
+    moveX = sub_x / SUBPIXEL_ONE;
+    moveY = sub_y / SUBPIXEL_ONE;
+    sub_x -= moveX * SUBPIXEL_ONE;
+    sub_y -= moveY * SUBPIXEL_ONE;
+  }
+
+  /**
+   * @brief Drops the carried fraction on an axis that was blocked.
+   */
+  void stopX() { sub_x = 0; }
+  void stopY() { sub_y = 0; }
+};
+
+#endif // KINEMATICS_H
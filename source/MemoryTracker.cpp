@@ -0,0 +1,145 @@
+/*---------------------------------------------------------------------------------
+
+MemoryTracker.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "MemoryTracker.h"
+#include "Stage.h"
+#include <nds.h>
+#include <new>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+static const char *TAG_NAMES[MEM_TAG_COUNT] = {
+    "other",   "stage", "tanks",  "bullets", "mines",
+    "effects", "ui",    "render", "audio",   "debug"};
+
+static const char *RESOURCE_NAMES[MEM_RESOURCE_COUNT] = {
+    "heap", "sprite vram", "tex vram", "oam", "affine"};
+
+// Byte counts are shown in KB, OAM and affine as they are
+static const bool RESOURCE_IN_BYTES[MEM_RESOURCE_COUNT] = {true, true, true,
+                                                           false, false};
+
+//---------------------------------------------------------------------------------
+//
+// HEAP HOOKS
+//
+//---------------------------------------------------------------------------------
+
+#ifdef ARM9
+// Every allocation is prefixed with its size and tag so freeing it can be
+// refunded. 8 bytes keeps malloc's alignment.
+struct HeapHeader {
+  u32 size;
+  u32 tag;
+};
+
+void *operator new(size_t size) {
+  HeapHeader *header = (HeapHeader *)malloc(sizeof(HeapHeader) + size);
+  if (header == nullptr) abort(); // What failing to throw bad_alloc does
+  header->size = size;
+  header->tag = Stage::memory.tag;
+  Stage::memory.addHeap(Stage::memory.tag, size);
+  return header + 1;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *ptr) noexcept {
+  if (ptr == nullptr) return;
+  HeapHeader *header = (HeapHeader *)ptr - 1;
+  Stage::memory.addHeap((MemoryTag)header->tag, -(int)header->size);
+  free(header);
+}
+
+void operator delete[](void *ptr) noexcept { operator delete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { operator delete(ptr); }
+#endif
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void MemoryTracker::change(MemoryUsage &usage, int amount, const char *name) {
+  usage.current += amount;
+  if (usage.current > usage.peak) usage.peak = usage.current;
+
+#ifdef DEBUG_BUILD
+  if (usage.budget > 0 && usage.current > usage.budget) {
+    char message[64];
+    snprintf(message, sizeof(message), "%s over budget: %d of %d", name,
+             usage.current, usage.budget);
+    sassert(false, message);
+  }
+#else
+  (void)name;
+#endif
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void MemoryTracker::addHeap(MemoryTag tag, int bytes) {
+  change(tags[tag], bytes, TAG_NAMES[tag]);
+  change(resources[MEM_HEAP], bytes, RESOURCE_NAMES[MEM_HEAP]);
+}
+
+void MemoryTracker::add(MemoryResource resource, int amount) {
+  change(resources[resource], amount, RESOURCE_NAMES[resource]);
+}
+
+void MemoryTracker::set(MemoryResource resource, int amount) {
+  MemoryUsage &usage = resources[resource];
+  change(usage, amount - usage.current, RESOURCE_NAMES[resource]);
+}
+
+void MemoryTracker::print(int row) const {
+  printf("\x1b[%d;0H%-11s %6s %6s", row++, "memory", "now", "peak");
+  for (int i = 0; i < MEM_TAG_COUNT; i++) {
+    if (tags[i].peak == 0) continue; // Keep the overlay short
+    printf("\x1b[%d;0H%-11s %5dK %5dK", row++, TAG_NAMES[i],
+           tags[i].current / 1024, tags[i].peak / 1024);
+  }
+  for (int i = 0; i < MEM_RESOURCE_COUNT; i++) {
+    const MemoryUsage &usage = resources[i];
+    if (RESOURCE_IN_BYTES[i]) {
+      printf("\x1b[%d;0H%-11s %5dK %5dK", row++, RESOURCE_NAMES[i],
+             usage.current / 1024, usage.peak / 1024);
+    } else {
+      printf("\x1b[%d;0H%-11s %6d %6d", row++, RESOURCE_NAMES[i],
+             usage.current, usage.peak);
+    }
+  }
+}
+
+void MemoryTracker::dump(FILE *out) const {
+  fprintf(out, "%-12s %10s %10s %10s\n", "", "current", "peak", "budget");
+  for (int i = 0; i < MEM_TAG_COUNT; i++) {
+    fprintf(out, "heap/%-7s %10d %10d %10d\n", TAG_NAMES[i], tags[i].current,
+            tags[i].peak, tags[i].budget);
+  }
+  for (int i = 0; i < MEM_RESOURCE_COUNT; i++) {
+    const MemoryUsage &usage = resources[i];
+    fprintf(out, "%-12s %10d %10d %10d\n", RESOURCE_NAMES[i], usage.current,
+            usage.peak, usage.budget);
+  }
+}
@@ -0,0 +1,141 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include "calico/types.h"
+#include <stdio.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Who heap allocations are charged to, see MemoryScope
+ */
+enum MemoryTag {
+  MEM_OTHER,   // Anything allocated outside a scope
+  MEM_STAGE,   // The stage, its lists, grids and tank table
+  MEM_TANKS,   // Tanks and their sprites
+  MEM_BULLETS, // Bullets
+  MEM_MINES,   // Mines
+  MEM_EFFECTS, // Explosions, ricochets and other effect sprites
+  MEM_UI,      // The cursor and its tail
+  MEM_RENDER,  // The sprite atlas, renderer and draw list
+  MEM_AUDIO,   // Sound effects and music
+  MEM_DEBUG,   // Rewind history and other debug tooling
+  MEM_TAG_COUNT
+};
+
+/**
+ * @brief The limited resources tracked as a whole
+ */
+enum MemoryResource {
+  MEM_HEAP,         // Bytes, every tag together
+  MEM_SPRITE_VRAM,  // Bytes of sprite frames in VRAM bank B
+  MEM_TEXTURE_VRAM, // Bytes of gl2d textures and texture palettes
+  MEM_OAM,          // OAM entries used last frame
+  MEM_AFFINE,       // Affine matrices used last frame
+  MEM_RESOURCE_COUNT
+};
+
+// Default budgets, 0 for none. Change them with setBudget.
+const int MEM_HEAP_BUDGET = 2 * 1024 * 1024;  // Leaves room for the binary
+const int MEM_SPRITE_VRAM_BUDGET = 128 * 1024; // All of bank B
+const int MEM_TEXTURE_VRAM_BUDGET = 128 * 1024 + 16 * 1024; // Banks D and E
+const int MEM_OAM_BUDGET = 128;
+const int MEM_AFFINE_BUDGET = 32;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief How much of something is in use
+ */
+struct MemoryUsage {
+  int current = 0;
+  int peak = 0;
+  int budget = 0; // 0 for none
+};
+
+/**
+ * Keeps current and peak use of the heap, per tag, and of the DS's fixed
+ * graphics resources. On the DS every heap allocation goes through it (see
+ * MemoryTracker.cpp) and is charged to the innermost MemoryScope. Going over
+ * a budget asserts in debug builds.
+ */
+class MemoryTracker {
+private:
+  MemoryUsage tags[MEM_TAG_COUNT];
+  MemoryUsage resources[MEM_RESOURCE_COUNT] = {
+      {0, 0, MEM_HEAP_BUDGET},         {0, 0, MEM_SPRITE_VRAM_BUDGET},
+      {0, 0, MEM_TEXTURE_VRAM_BUDGET}, {0, 0, MEM_OAM_BUDGET},
+      {0, 0, MEM_AFFINE_BUDGET}};
+
+  /**
+   * @brief Moves the current use, updating the peak and checking the budget
+   */
+  void change(MemoryUsage &usage, int amount, const char *name);
+
+public:
+  MemoryTag tag = MEM_OTHER; // Charged for heap allocations right now
+
+  /**
+   * @brief Charges (or with a negative amount, refunds) heap bytes to a tag
+   */
+  void addHeap(MemoryTag tag, int bytes);
+
+  /**
+   * @brief Takes (or with a negative amount, gives back) some of a resource
+   */
+  void add(MemoryResource resource, int amount);
+
+  /**
+   * @brief Sets how much of a resource is in use, for ones counted afresh
+   *        every frame like OAM entries
+   */
+  void set(MemoryResource resource, int amount);
+
+  void setBudget(MemoryTag tag, int bytes) { tags[tag].budget = bytes; }
+  void setBudget(MemoryResource resource, int amount) {
+    resources[resource].budget = amount;
+  }
+
+  const MemoryUsage &usage(MemoryTag tag) const { return tags[tag]; }
+  const MemoryUsage &usage(MemoryResource resource) const {
+    return resources[resource];
+  }
+
+  /**
+   * @brief Prints current and peak use in KB on the console, starting at a
+   *        row, for the debug overlay
+   */
+  void print(int row) const;
+
+  /**
+   * @brief Writes the full report, budgets included, as text
+   */
+  void dump(FILE *out) const;
+};
+
+/**
+ * Charges heap allocations made while it's in scope to a tag, then puts the
+ * previous tag back. Scopes nest, the innermost wins.
+ */
+class MemoryScope {
+private:
+  MemoryTracker &tracker;
+  MemoryTag previous;
+
+public:
+  MemoryScope(MemoryTracker &tracker, MemoryTag tag)
+      : tracker(tracker), previous(tracker.tag) {
+    tracker.tag = tag;
+  }
+  ~MemoryScope() { tracker.tag = previous; }
+};
+
+#endif // MEMORY_TRACKER_H
@@ -0,0 +1,111 @@
+/*---------------------------------------------------------------------------------
+
+Mine.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Mine.h"
+#include "Stage.h"
+#include "Tank.h"
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void Mine::onFuseTimer(void *context) {
+  Mine *mine = (Mine *)context;
+  mine->stage->detonateMine(mine);
+}
+
+//-------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//-------------------------------------------------------------------------------
+
+// Mines are drawn with gl2d and their blast is particles, no sprites
+Mine::Mine(Stage *stage, Tank *tank) : stage(stage), tank(tank) {}
+
+Mine::~Mine() {
+  stage->live_mines.remove(&live_hook);
+  stage->mine_grid.remove(&grid_hook);
+  Stage::timers.cancel(&fuse_timer);
+  Stage::timers.cancel(&arming_timer);
+  Stage::timers.cancel(&blast_timer);
+}
+
+void Mine::lay(Position center) {
+  pos = center;
+  live = true;
+  stage->live_mines.pushBack(&live_hook);
+  stage->mine_grid.move(&grid_hook, pos.x, pos.y);
+
+  Stage::timers.schedule(&fuse_timer, MINE_FUSE_FRAMES);
+  Stage::timers.schedule(&arming_timer, MINE_ARM_FRAMES);
+  Stage::telemetry.event(TELEMETRY_MINE_LAID, tank->color, pos.x, pos.y);
+}
+
+void Mine::detonate() {
+  if (!live) return;
+
+  live = false;
+  stage->live_mines.remove(&live_hook);
+  stage->mine_grid.remove(&grid_hook);
+  Stage::timers.cancel(&fuse_timer);
+  Stage::timers.cancel(&arming_timer);
+
+  Stage::timers.schedule(&blast_timer, MINE_BLAST_FRAMES);
+  Stage::particles.emit(PARTICLES_MINE_BLAST, pos.x, pos.y, 0);
+  Stage::telemetry.event(TELEMETRY_MINE_DETONATE, tank->color, pos.x, pos.y);
+}
+
+bool Mine::isTrippedBy(Tank *other) {
+  // The layer gets a head start to drive away
+  if (other == tank && arming_timer.armed) return false;
+
+  int dx = other->getPosition('x') + TANK_SIZE / 2 - pos.x;
+  int dy = other->getPosition('y') + TANK_SIZE / 2 - pos.y;
+  return dx * dx + dy * dy <= MINE_TRIGGER_RADIUS * MINE_TRIGGER_RADIUS;
+}
+
+Tank *Mine::getOwner() { return tank; }
+
+void Mine::draw(DrawList &list) {
+  int half = MINE_SIZE / 2;
+  list.boxFilled(pos.x - half, pos.y - half, pos.x + half - 1,
+                 pos.y + half - 1, RGB15(8, 7, 4));
+  list.boxFilled(pos.x - half + 1, pos.y - half + 1, pos.x + half - 2,
+                 pos.y + half - 2, RGB15(29, 24, 6));
+
+  // The light flashes faster once the fuse is nearly out
+  int remaining = Stage::timers.remaining(&fuse_timer);
+  bool warning = remaining <= MINE_WARNING_FRAMES;
+  bool lit = warning ? (remaining / 8) % 2 == 0 : (remaining / 30) % 2 == 0;
+  int light = lit ? RGB15(31, 4, 2) : RGB15(14, 3, 2);
+  list.boxFilled(pos.x - 1, pos.y - 1, pos.x, pos.y, light);
+}
+
+void Mine::captureState(MineState &state) {
+  state = {};
+  state.pos = pos;
+  state.live = live;
+  Stage::timers.captureState(&fuse_timer, state.fuse);
+  Stage::timers.captureState(&arming_timer, state.arming);
+  Stage::timers.captureState(&blast_timer, state.blast);
+}
+
+void Mine::restoreState(const MineState &state) {
+  pos = state.pos;
+  live = state.live;
+  Stage::timers.restoreState(&fuse_timer, state.fuse);
+  Stage::timers.restoreState(&arming_timer, state.arming);
+  Stage::timers.restoreState(&blast_timer, state.blast);
+}
@@ -0,0 +1,114 @@
+#ifndef MINE_H
+#define MINE_H
+
+#include "DrawList.h"
+#include "Position.h"
+#include "SpatialGrid.h"
+#include "Sprite.h"
+#include "TimerWheel.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int MINE_SIZE = 8;
+const int MINE_FUSE_FRAMES = 600;    // A mine goes off on its own after 10s
+const int MINE_WARNING_FRAMES = 120; // It flashes for the last 2s
+const int MINE_ARM_FRAMES = 90;      // Before this the layer can't trip it
+const int MINE_TRIGGER_RADIUS = 20;  // Tank centers this close trip it
+const int MINE_BLAST_RADIUS = 40;    // Everything this close is caught
+const int MINE_BLAST_FRAMES = 18;    // Before the mine can be laid again
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Plain copy of a mine's simulation state
+ */
+struct MineState {
+  Position pos;
+  TimerState fuse;
+  TimerState arming;
+  TimerState blast;
+  u8 live;
+  u8 padding[3];
+};
+
+class Stage;
+class Tank;
+class Mine {
+private:
+  Stage *stage; // Stage the mine is laid on
+  Tank *tank;   // The tank that lays the mine
+
+  /**
+   * @brief Sets the mine off once its fuse runs out
+   */
+  static void onFuseTimer(void *context);
+
+public:
+  Position pos = {0, 0}; // Center of the mine
+  bool live = false;     // Laid and not yet gone off
+  Timer fuse_timer = Timer(&Mine::onFuseTimer, this);
+  Timer arming_timer; // Armed while the layer can still drive over it
+  Timer blast_timer;  // Armed while the blast clears
+  ListHook<Mine> live_hook = ListHook<Mine>(this); // Stage::live_mines
+  GridHook<Mine> grid_hook = GridHook<Mine>(this); // Stage::mine_grid
+
+  /**
+   * @brief Creates a mine for a tank's pool
+   * @param stage The stage to lay the mine on
+   * @param tank The tank that lays the mine
+   */
+  Mine(Stage *stage, Tank *tank);
+
+  ~Mine();
+
+  /**
+   * @brief Lays the mine and lights its fuse
+   * @param center Where to lay the mine
+   */
+  void lay(Position center);
+
+  /**
+   * @brief Takes the mine off the stage and throws out its blast. Use
+   *        Stage::detonateMine so the blast reaches its surroundings.
+   */
+  void detonate();
+
+  /**
+   * @brief Whether a tank this close should set the mine off
+   */
+  bool isTrippedBy(Tank *other);
+
+  /**
+   * @brief The tank that laid the mine
+   */
+  Tank *getOwner();
+
+  /**
+   * @brief Queues the mine to be drawn with gl2d, flashing near the end of
+   *        its fuse
+   * @param list This frame's draw list
+   */
+  void draw(DrawList &list);
+
+  /**
+   * @brief Copies the mine's simulation state out
+   * @param state The state to fill in
+   */
+  void captureState(MineState &state);
+
+  /**
+   * @brief Overwrites the mine's simulation state
+   * @param state The state to restore
+   */
+  void restoreState(const MineState &state);
+};
+
+#endif // MINE_H
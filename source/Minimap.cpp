@@ -0,0 +1,214 @@
+/*---------------------------------------------------------------------------------
+
+Minimap.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Minimap.h"
+#include "Bullet.h"
+#include "Mine.h"
+#include "Stage.h"
+#include "Tank.h"
+#include "Terrain.h"
+#include <nds.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// The wall layer's color for each barrier value
+static const u8 BARRIER_COLORS[] = {MINIMAP_FLOOR, MINIMAP_WALL, MINIMAP_HOLE,
+                                    MINIMAP_DESTRUCTIBLE};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief A mark's size on the minimap, big enough to see and no bigger
+ *        than its 8x8 tile
+ */
+static int markSize(int size) {
+  if (size < 2) return 2;
+  if (size > 8) return 8;
+  return size;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+int Minimap::colorAt(int mx, int my) {
+  int half = (1 << shift) / 2;
+  return BARRIER_COLORS[terrain->at((mx << shift) + half, (my << shift) + half)];
+}
+
+void Minimap::rasterize(int mx1, int my1, int mx2, int my2, bool queued) {
+  // VRAM only takes halfword writes, so two pixels at a time
+  mx1 &= ~1;
+  mx2 = (mx2 + 1) & ~1;
+  u16 *bitmap = bgGetGfxPtr(bg);
+  for (int my = my1; my < my2; my++) {
+    u16 *row = bitmap + ((top + my) * SCREEN_WIDTH + left) / 2;
+    for (int mx = mx1; mx < mx2; mx += 2) {
+      u16 pair = colorAt(mx, my) | colorAt(mx + 1, my) << 8;
+      if (queued) Terrain::uploads.queue(row + mx / 2, pair);
+      else row[mx / 2] = pair;
+    }
+  }
+}
+
+void Minimap::drawMarks() {
+  mark_size[MINIMAP_PLAYER] = markSize(TANK_SIZE >> shift);
+  mark_size[MINIMAP_ENEMY] = mark_size[MINIMAP_PLAYER];
+  mark_size[MINIMAP_BULLET] = 2;
+  mark_size[MINIMAP_MINE] = markSize(MINE_SIZE >> shift);
+
+  // A square in the tile's top left, 4 bits a pixel with the leftmost in
+  // the low bits, in the mark's own palette entry
+  for (int mark = 0; mark < MINIMAP_MARK_COUNT; mark++) {
+    int size = mark_size[mark];
+    for (int y = 0; y < 8; y++) {
+      for (int half = 0; half < 2; half++) {
+        u16 pixels = 0;
+        for (int x = 0; x < 4; x++) {
+          if (y < size && half * 4 + x < size) pixels |= (mark + 1) << (x * 4);
+        }
+        mark_gfx[mark][y * 2 + half] = pixels;
+      }
+    }
+  }
+}
+
+void Minimap::show(int entry, MinimapMark mark, Position center) {
+  if (entry >= MINIMAP_MAX_MARKS) return;
+  int size = mark_size[mark];
+  int x = left + (center.x >> shift) - size / 2;
+  int y = top + (center.y >> shift) - size / 2;
+
+  Shown &was = shown[entry];
+  if (was.mark == mark && was.x == x && was.y == y) return;
+  was = {(s16)x, (s16)y, (s8)mark};
+  oamSet(&oamSub, entry, x, y, 1, 0, SpriteSize_8x8,
+         SpriteColorFormat_16Color, mark_gfx[mark], -1, false, false, false,
+         false, false);
+  dirty = true;
+}
+
+void Minimap::onTerrainChanged(void *context, int col, int row) {
+  Minimap *minimap = (Minimap *)context;
+  if (minimap->bg < 0) return;
+
+  int shift = minimap->shift;
+  minimap->rasterize((col * GRID_CELL_SIZE) >> shift,
+                     (row * GRID_CELL_SIZE) >> shift,
+                     ((col + 1) * GRID_CELL_SIZE) >> shift,
+                     ((row + 1) * GRID_CELL_SIZE) >> shift, true);
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void Minimap::init() {
+  // The bitmap is the top 64 KB of bank C, the console's font and map sit
+  // under it. The console stays on top.
+  bg = bgInitSub(3, BgType_Bmp8, BgSize_B8_256x256, 4, 0);
+  bgSetPriority(bg, 3);
+  dmaFillHalfWords(0, bgGetGfxPtr(bg), SCREEN_WIDTH * SCREEN_HEIGHT);
+
+  BG_PALETTE_SUB[MINIMAP_FLOOR] = RGB15(18, 14, 9);
+  BG_PALETTE_SUB[MINIMAP_WALL] = RGB15(29, 27, 22);
+  BG_PALETTE_SUB[MINIMAP_HOLE] = RGB15(4, 4, 6);
+  BG_PALETTE_SUB[MINIMAP_DESTRUCTIBLE] = RGB15(24, 17, 8);
+
+  // Each mark draws in the entry after its number
+  SPRITE_PALETTE_SUB[1 + MINIMAP_PLAYER] = RGB15(6, 12, 31);
+  SPRITE_PALETTE_SUB[1 + MINIMAP_ENEMY] = RGB15(31, 6, 4);
+  SPRITE_PALETTE_SUB[1 + MINIMAP_BULLET] = RGB15(31, 31, 31);
+  SPRITE_PALETTE_SUB[1 + MINIMAP_MINE] = RGB15(31, 26, 0);
+  for (int mark = 0; mark < MINIMAP_MARK_COUNT; mark++) {
+    mark_gfx[mark] =
+        oamAllocateGfx(&oamSub, SpriteSize_8x8, SpriteColorFormat_16Color);
+  }
+  for (int i = 0; i < MINIMAP_MAX_MARKS; i++) shown[i].mark = MINIMAP_HIDDEN;
+}
+
+void Minimap::attach(Terrain *terrain) {
+  this->terrain = terrain;
+  terrain->addListener(&Minimap::onTerrainChanged, this);
+
+  // As big as fits the screen. Arenas are whole chunks, so the size and
+  // the centering stay on whole halfwords of the bitmap.
+  shift = MINIMAP_MIN_SHIFT;
+  while ((terrain->getWidth() >> shift) > SCREEN_WIDTH ||
+         (terrain->getHeight() >> shift) > SCREEN_HEIGHT) {
+    shift++;
+  }
+  width = terrain->getWidth() >> shift;
+  height = terrain->getHeight() >> shift;
+  left = (SCREEN_WIDTH - width) / 2;
+  top = (SCREEN_HEIGHT - height) / 2;
+  if (bg < 0) return;
+
+  // Loading, so straight to VRAM
+  dmaFillHalfWords(0, bgGetGfxPtr(bg), SCREEN_WIDTH * SCREEN_HEIGHT);
+  rasterize(0, 0, width, height, false);
+  drawMarks();
+
+  // The next update puts back whatever is still there, at the new scale
+  for (int i = 0; i < num_shown; i++) {
+    oamSetHidden(&oamSub, i, true);
+    shown[i].mark = MINIMAP_HIDDEN;
+  }
+  num_shown = 0;
+  dirty = true;
+}
+
+void Minimap::update(Stage *stage) {
+  if (bg < 0 || terrain == nullptr) return;
+
+  // Tanks first so they're drawn over what's under them
+  int entry = 0;
+  for (Tank *tank : stage->active_tanks) {
+    bool player = tank->archetype.behavior == T_BEHAVIOR_CONTROLLED;
+    show(entry++, player ? MINIMAP_PLAYER : MINIMAP_ENEMY,
+         {tank->getPosition('x') + TANK_SIZE / 2,
+          tank->getPosition('y') + TANK_SIZE / 2});
+  }
+  for (Bullet *bullet : stage->live_bullets) {
+    show(entry++, MINIMAP_BULLET, bullet->getCenter());
+  }
+  for (Mine *mine : stage->live_mines) {
+    show(entry++, MINIMAP_MINE, mine->pos);
+  }
+
+  // Whatever has gone since the last update
+  if (entry > MINIMAP_MAX_MARKS) entry = MINIMAP_MAX_MARKS;
+  for (int i = entry; i < num_shown; i++) {
+    oamSetHidden(&oamSub, i, true);
+    shown[i].mark = MINIMAP_HIDDEN;
+    dirty = true;
+  }
+  num_shown = entry;
+}
+
+void Minimap::flush() {
+  if (!dirty) return;
+  oamUpdate(&oamSub);
+  dirty = false;
+}
@@ -0,0 +1,138 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "Position.h"
+#include "calico/types.h"
+
+class Stage;
+class Terrain;
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Arena pixels a minimap pixel covers, as a shift. At least 2x2 so the
+// minimap stays a minimap, more for arenas that wouldn't fit the screen.
+const int MINIMAP_MIN_SHIFT = 1;
+const int MINIMAP_MAX_MARKS = 128; // All of the sub OAM
+
+/**
+ * @brief Sub BG palette entries of the wall layer. They stay clear of the
+ *        ones the console's font uses (every 16th, from 15).
+ */
+enum MinimapColor {
+  MINIMAP_FLOOR = 1,
+  MINIMAP_WALL = 2,
+  MINIMAP_HOLE = 3,
+  MINIMAP_DESTRUCTIBLE = 4,
+};
+
+/**
+ * @brief What a sub OAM sprite on the minimap stands for
+ */
+enum MinimapMark {
+  MINIMAP_PLAYER,
+  MINIMAP_ENEMY,
+  MINIMAP_BULLET,
+  MINIMAP_MINE,
+  MINIMAP_MARK_COUNT,
+  MINIMAP_HIDDEN = -1
+};
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * The whole arena in small on the bottom screen, under the console text.
+ * The walls are rasterised once a stage from the barriers into an 8 bit
+ * bitmap BG on the sub engine; a destroyed (or restored) wall only redraws
+ * the minimap pixels under its cell, through the VBlank queue. Tanks,
+ * bullets and mines are sub OAM sprites, and an entry is only rewritten
+ * when what it stands for moves a whole minimap pixel, so most frames the
+ * sub OAM isn't copied at all.
+ */
+class Minimap {
+private:
+  /**
+   * @brief A sub OAM entry as last written
+   */
+  struct Shown {
+    s16 x;
+    s16 y;
+    s8 mark; // MinimapMark, MINIMAP_HIDDEN if off
+  };
+
+  Terrain *terrain = nullptr;
+  int bg = -1;
+  u16 *mark_gfx[MINIMAP_MARK_COUNT] = {};
+  int mark_size[MINIMAP_MARK_COUNT] = {};
+  int shift = MINIMAP_MIN_SHIFT;
+  int left = 0; // Where the arena's top left is on the sub screen
+  int top = 0;
+  int width = 0; // The arena's size in minimap pixels
+  int height = 0;
+  Shown shown[MINIMAP_MAX_MARKS];
+  int num_shown = 0; // Entries that may be showing
+  bool dirty = false; // The sub OAM needs copying in the VBlank
+
+  /**
+   * @brief The wall layer's color for a minimap pixel, sampled at the
+   *        middle of the arena pixels it covers
+   */
+  int colorAt(int mx, int my);
+
+  /**
+   * @brief Redraws the wall layer over a box of minimap pixels
+   * @param queued Whether to write through the VBlank queue (during play)
+   *        or straight to VRAM (while loading)
+   */
+  void rasterize(int mx1, int my1, int mx2, int my2, bool queued);
+
+  /**
+   * @brief Draws each mark's square into its sprite tile, sized for the
+   *        scale
+   */
+  void drawMarks();
+
+  /**
+   * @brief Points a sub OAM entry at a mark over an arena position, if it
+   *        isn't already
+   */
+  void show(int entry, MinimapMark mark, Position center);
+
+  /**
+   * @brief Redraws the minimap pixels of a cell that was blasted (or put
+   *        back)
+   */
+  static void onTerrainChanged(void *context, int col, int row);
+
+public:
+  /**
+   * @brief Sets up the bitmap BG and the marks' sprite tiles, once at boot
+   *        after the sub engine's mode, banks and OAM
+   */
+  void init();
+
+  /**
+   * @brief Shows a stage's arena, scaled to fit, and draws its walls
+   */
+  void attach(Terrain *terrain);
+
+  /**
+   * @brief Moves the marks to where the tanks, bullets and mines are. Call
+   *        once a frame, after the simulation.
+   */
+  void update(Stage *stage);
+
+  /**
+   * @brief Copies the sub OAM if any mark changed, in the VBlank
+   */
+  void flush();
+};
+
+#endif // MINIMAP_H
@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------------------
+
+ParticleSystem.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "ParticleSystem.h"
+#include "Angle.h"
+#include "Kinematics.h"
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+int ParticleSystem::random(int range) {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return (int)(((seed >> 16) * (u32)range) >> 16);
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void ParticleSystem::emit(const ParticleBurst &burst, int x, int y,
+                          int heading) {
+  int total = burst.count >> burst_shift;
+  for (int n = 0; n < total; n++) {
+    if (count == PARTICLE_CAPACITY) {
+      dropped += total - n;
+      return;
+    }
+
+    int angle = heading - burst.spread + random(2 * burst.spread + 1);
+    int speed = burst.speed + random(burst.speed_jitter + 1);
+    int life = burst.life + random(burst.life_jitter + 1);
+
+    int i = count++;
+    this->x[i] = x << SUBPIXEL_SHIFT;
+    this->y[i] = y << SUBPIXEL_SHIFT;
+    vx[i] = angleCos(angle) * speed >> TRIG_SHIFT;
+    vy[i] = angleSin(angle) * speed >> TRIG_SHIFT;
+    alpha[i] = burst.alpha << 8;
+    fade[i] = (burst.alpha << 8) / life;
+    color[i] = burst.color;
+    size[i] = burst.size;
+    drag_shift[i] = burst.drag_shift;
+  }
+}
+
+void ParticleSystem::update() {
+  int i = 0;
+  while (i < count) {
+    // Faded out, the last particle takes its place
+    if (alpha[i] < fade[i] + (1 << 8)) {
+      int last = --count;
+      x[i] = x[last];
+      y[i] = y[last];
+      vx[i] = vx[last];
+      vy[i] = vy[last];
+      alpha[i] = alpha[last];
+      fade[i] = fade[last];
+      color[i] = color[last];
+      size[i] = size[last];
+      drag_shift[i] = drag_shift[last];
+      continue;
+    }
+
+    alpha[i] -= fade[i];
+    x[i] += vx[i];
+    y[i] += vy[i];
+    if (drag_shift[i] != 0) {
+      vx[i] -= vx[i] >> drag_shift[i];
+      vy[i] -= vy[i] >> drag_shift[i];
+    }
+    i++;
+  }
+}
+
+void ParticleSystem::draw(DrawList &list) {
+  list.setLayer(D_LAYER_PARTICLES);
+  for (int i = 0; i < count; i++) {
+    // Eight alpha levels keep the poly format switches down, the draw list
+    // groups the particles by level. Alpha 0 would be wireframe.
+    int level = (alpha[i] >> 8) | 3;
+    list.setPolyFmt(POLY_ALPHA(level) | POLY_CULL_NONE |
+                    POLY_ID(PARTICLE_POLY_ID));
+    int px = (x[i] >> SUBPIXEL_SHIFT) - size[i] / 2;
+    int py = (y[i] >> SUBPIXEL_SHIFT) - size[i] / 2;
+    list.boxFilled(px, py, px + size[i] - 1, py + size[i] - 1, color[i]);
+  }
+}
+
+void ParticleSystem::clear() { count = 0; }
@@ -0,0 +1,118 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include "DrawList.h"
+#include <nds.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int PARTICLE_CAPACITY = 1024; // Live particles at once
+const int PARTICLE_POLY_ID = 5;     // Translucent, drawn over the mines
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief What an emitter throws out when its event happens. Speeds are in
+ *        1/256ths of a pixel per frame, angles are binary (see Angle.h).
+ */
+struct ParticleBurst {
+  int count;        // Particles per burst
+  int speed;        // Slowest launch speed
+  int speed_jitter; // Up to this much faster
+  int spread;       // Either side of the heading
+  int life;         // Frames until faded out
+  int life_jitter;  // Up to this many frames longer
+  int drag_shift;   // Loses 1/2^n of its speed a frame, 0 for none
+  int size;         // Pixels square
+  u16 color;
+  int alpha; // Starting alpha, 1-31
+};
+
+// Emitters, by the event they're attached to
+constexpr ParticleBurst PARTICLES_MUZZLE_FLASH = {
+    6, 256, 384, 1024, 5, 4, 2, 2, RGB15(31, 27, 10), 31};
+constexpr ParticleBurst PARTICLES_BULLET_TRAIL = {
+    1, 16, 32, 4096, 20, 10, 3, 2, RGB15(22, 22, 22), 14};
+constexpr ParticleBurst PARTICLES_RICOCHET = {
+    5, 192, 320, 3072, 8, 6, 2, 1, RGB15(31, 30, 18), 31};
+constexpr ParticleBurst PARTICLES_BULLET_POP = {
+    8, 64, 192, 16384, 12, 8, 2, 2, RGB15(26, 26, 26), 24};
+constexpr ParticleBurst PARTICLES_TANK_DEBRIS = {
+    24, 256, 512, 16384, 24, 16, 3, 2, RGB15(31, 16, 4), 31};
+constexpr ParticleBurst PARTICLES_TANK_SMOKE = {
+    16, 32, 128, 16384, 45, 30, 4, 3, RGB15(10, 10, 10), 20};
+constexpr ParticleBurst PARTICLES_MINE_BLAST = {
+    32, 384, 384, 16384, 18, 12, 3, 2, RGB15(31, 22, 6), 31};
+
+/**
+ * A fixed pool of cosmetic particles, stored as a structure of arrays so
+ * the update loop streams through each field. Live particles are packed
+ * at the front and a dying one is swapped with the last. Positions are
+ * 24.8 fixed point and velocities 8.8, alpha fades linearly to nothing.
+ *
+ * Nothing is allocated after construction, bursts that don't fit are cut
+ * short. Like treadmarks, particles aren't part of the rewind state.
+ */
+class ParticleSystem {
+private:
+  s32 x[PARTICLE_CAPACITY];
+  s32 y[PARTICLE_CAPACITY];
+  s16 vx[PARTICLE_CAPACITY];
+  s16 vy[PARTICLE_CAPACITY];
+  u16 alpha[PARTICLE_CAPACITY]; // 5.8 fixed point
+  u16 fade[PARTICLE_CAPACITY];  // Alpha lost a frame, 5.8 fixed point
+  u16 color[PARTICLE_CAPACITY];
+  u8 size[PARTICLE_CAPACITY];
+  u8 drag_shift[PARTICLE_CAPACITY];
+  int count = 0;
+  u32 seed = 0x2545F491; // Xorshift state, particles needn't be replayable
+
+  /**
+   * @brief A pseudo random number in [0, range)
+   */
+  int random(int range);
+
+public:
+  int dropped = 0;     // Particles that didn't fit in the pool, ever
+  int burst_shift = 0; // Bursts are cut to count >> this, see QualityGovernor
+
+  /**
+   * @brief Throws out a burst of particles
+   * @param burst The emitter to use
+   * @param x Where from, in pixels
+   * @param y Where from, in pixels
+   * @param heading The binary angle the burst is centered on (0 is +x)
+   */
+  void emit(const ParticleBurst &burst, int x, int y, int heading);
+
+  /**
+   * @brief Moves and fades every particle, removing the ones faded out
+   */
+  void update();
+
+  /**
+   * @brief Queues every particle as a translucent box on the particle layer
+   * @param list This frame's draw list
+   */
+  void draw(DrawList &list);
+
+  /**
+   * @brief Removes every particle (eg. on a stage change)
+   */
+  void clear();
+
+  /**
+   * @brief The number of live particles
+   */
+  int liveCount() const { return count; }
+};
+
+#endif // PARTICLE_SYSTEM_H
@@ -0,0 +1,23 @@
+#ifndef PER_THREAD_H
+#define PER_THREAD_H
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+/*
+ * Marks the state every stage shares (Stage's statics, the VBlank queue,
+ * the sprite count). The DS runs one stage at a time, so it stays plain
+ * static. Built for the host, it's one copy per thread, so the self-play
+ * runner (utils/selfplay) can play a match on every core without the
+ * matches seeing each other's timers, renderer or frame counter.
+ */
+#ifdef ARM9
+#define PER_THREAD
+#else
+#define PER_THREAD thread_local
+#endif
+
+#endif // PER_THREAD_H
@@ -0,0 +1,80 @@
+/*---------------------------------------------------------------------------------
+
+QualityGovernor.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "QualityGovernor.h"
+#include "Stage.h"
+#include <stdio.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// The cheapest first: treadmarks grow all stage long, particles come in
+// bursts, the cursor tail is only ever 7 sprites
+static const QualitySettings LEVELS[QUALITY_LEVEL_COUNT] = {
+    {"full", 1, 0, 1},
+    {"reduced", 2, 1, 1},
+    {"low", 4, 2, 2},
+    {"minimal", 8, 3, 3},
+};
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void QualityGovernor::change(QualityLevel to, u32 average) {
+  level = to;
+  settle = QUALITY_SETTLE_FRAMES;
+  under_for = 0;
+
+  // The average frame in microseconds goes along as the x
+  u32 micros = average * 1000 / PROFILE_TICKS_PER_MS;
+  Stage::telemetry.event(TELEMETRY_QUALITY, to,
+                         micros > 0x7FFF ? 0x7FFF : micros, 0);
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool QualityGovernor::update() {
+  u32 average = Stage::profiler.averageTicks(PROFILE_FRAME);
+  under_for = average < QUALITY_RESTORE_TICKS ? under_for + 1 : 0;
+  if (settle > 0) {
+    settle--;
+    return false;
+  }
+
+  if (average > QUALITY_SHED_TICKS && level < QUALITY_MINIMAL) {
+    change((QualityLevel)(level + 1), average);
+    return true;
+  }
+  if (under_for >= QUALITY_RESTORE_FRAMES && level > QUALITY_FULL) {
+    change((QualityLevel)(level - 1), average);
+    return true;
+  }
+  return false;
+}
+
+const QualitySettings &QualityGovernor::settings() const {
+  return LEVELS[level];
+}
+
+void QualityGovernor::print(int row) const {
+  printf("\x1b[%d;0Hquality    %-8s", row, LEVELS[level].name);
+}
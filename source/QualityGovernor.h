@@ -0,0 +1,85 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include "FrameProfiler.h"
+#include "calico/types.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief How much optional work is being done, from all of it down
+ */
+enum QualityLevel {
+  QUALITY_FULL,
+  QUALITY_REDUCED,
+  QUALITY_LOW,
+  QUALITY_MINIMAL,
+  QUALITY_LEVEL_COUNT
+};
+
+// Shed a level once the average frame passes 90% of the budget, restore one
+// once it has stayed under 70% for two seconds. The gap keeps it from
+// flapping between two levels.
+const u32 QUALITY_SHED_TICKS = PROFILE_FRAME_BUDGET * 9 / 10;
+const u32 QUALITY_RESTORE_TICKS = PROFILE_FRAME_BUDGET * 7 / 10;
+const int QUALITY_RESTORE_FRAMES = 120;
+// After a change the average needs a full window to show its effect
+const int QUALITY_SETTLE_FRAMES = PROFILE_WINDOW;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief The optional work done at a quality level. All of it is cosmetic.
+ */
+struct QualitySettings {
+  const char *name;
+  int tread_stride;   // Draws every nth treadmark, newest first
+  int particle_shift; // Particle bursts are cut to count >> this
+  int tail_step;      // Shows every nth cursor tail sprite
+};
+
+/**
+ * Watches the profiler's rolling frame cost and sheds optional, cosmetic
+ * work level by level as it nears the frame budget, giving it back with
+ * hysteresis once there is room again. Nothing the simulation depends on
+ * is ever shed: movement, AI, collision and timers run the same at every
+ * level, so rewind and replays are unaffected. Level changes are logged to
+ * the telemetry stream.
+ */
+class QualityGovernor {
+private:
+  QualityLevel level = QUALITY_FULL;
+  int settle = 0;     // Frames left before the next change is allowed
+  int under_for = 0;  // Frames the average has been under the restore mark
+
+  /**
+   * @brief Moves to a level and logs it
+   */
+  void change(QualityLevel to, u32 average);
+
+public:
+  /**
+   * @brief Checks the last frame's cost and changes level if needed. Call
+   *        once a frame after FrameProfiler::endFrame.
+   * @return True if the level changed
+   */
+  bool update();
+
+  QualityLevel getLevel() const { return level; }
+  const QualitySettings &settings() const;
+
+  /**
+   * @brief Prints the level on the console at a row, for the debug overlay
+   */
+  void print(int row) const;
+};
+
+#endif // QUALITY_GOVERNOR_H
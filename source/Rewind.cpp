@@ -0,0 +1,240 @@
+/*---------------------------------------------------------------------------------
+
+Rewind.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Rewind.h"
+#include <string.h>
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+Rewind::Record &Rewind::recordAt(int index) {
+  return records[(first + index) % max_records];
+}
+
+int Rewind::reserve(int size) {
+  // Records are never split, wrap to the start if this one doesn't fit. The
+  // records left past the head are from the last lap, so they go first.
+  if (head + size > capacity) {
+    while (count > 0 && recordAt(0).offset >= head) {
+      first = (first + 1) % max_records;
+      count--;
+    }
+    head = 0;
+  }
+
+  // Records sit in the ring oldest first, so evict from the front until
+  // the oldest remaining record no longer overlaps the space we need
+  while (count > 0) {
+    Record &oldest = recordAt(0);
+    int oldestEnd = oldest.offset + oldest.delta_size + oldest.key_size;
+    if (oldestEnd <= head || oldest.offset >= head + size) break;
+    first = (first + 1) % max_records;
+    count--;
+  }
+
+  int offset = head;
+  head += size;
+  return offset;
+}
+
+int Rewind::encode(const u8 *a, const u8 *b, u8 *out) {
+  int n = 0;
+  int i = 0;
+  while (i < state_size) {
+    // Control bytes 128-255 skip 1-128 unchanged bytes
+    int run = 0;
+    while (i + run < state_size && run < 128 &&
+           (a[i + run] ^ (b ? b[i + run] : 0)) == 0) {
+      run++;
+    }
+    if (run > 0) {
+      out[n++] = 127 + run;
+      i += run;
+      continue;
+    }
+
+    // Control bytes 0-127 are followed by 1-128 changed bytes
+    int literal = 0;
+    while (i + literal < state_size && literal < 128 &&
+           (a[i + literal] ^ (b ? b[i + literal] : 0)) != 0) {
+      literal++;
+    }
+    out[n++] = literal - 1;
+    for (int j = 0; j < literal; j++, i++) {
+      out[n++] = a[i] ^ (b ? b[i] : 0);
+    }
+  }
+  return n;
+}
+
+void Rewind::apply(const u8 *in, int size, u8 *state) {
+  int pos = 0;
+  int i = 0;
+  while (i < size) {
+    u8 control = in[i++];
+    if (control >= 128) {
+      pos += control - 127;
+    } else {
+      for (int j = 0; j <= control; j++) state[pos++] ^= in[i++];
+    }
+  }
+}
+
+void Rewind::restore(int index) {
+  int from = cursor < 0 ? count - 1 : cursor;
+  int distance = index > from ? index - from : from - index;
+
+  // Find the closest keyframe at or before the target
+  int key = index;
+  while (key >= 0 && recordAt(key).key_size == 0) key--;
+
+  if (key >= 0 && index - key < distance) {
+    // Cheaper to rebuild from the keyframe than to walk from here
+    Record &keyframe = recordAt(key);
+    memset(previous, 0, state_size);
+    apply(buffer + keyframe.offset + keyframe.delta_size, keyframe.key_size,
+          previous);
+    for (int i = key + 1; i <= index; i++) {
+      Record &record = recordAt(i);
+      apply(buffer + record.offset, record.delta_size, previous);
+    }
+  } else if (index < from) {
+    // Each delta undoes itself, walk backwards
+    for (int i = from; i > index; i--) {
+      Record &record = recordAt(i);
+      apply(buffer + record.offset, record.delta_size, previous);
+    }
+  } else {
+    for (int i = from + 1; i <= index; i++) {
+      Record &record = recordAt(i);
+      apply(buffer + record.offset, record.delta_size, previous);
+    }
+  }
+
+  stage->loadState(previous);
+  cursor = index;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+Rewind::Rewind(Stage *stage, int budget, int maxFrames, int keyframeInterval)
+    : stage(stage), keyframe_interval(keyframeInterval), capacity(budget),
+      max_records(maxFrames) {
+  state_size = stage->stateSize();
+
+  buffer = new u8[capacity];
+  records = new Record[max_records];
+  previous = new u8[state_size];
+  scratch = new u8[state_size];
+  // Worst case is one control byte per 128 literals, for delta + keyframe
+  encoded = new u8[2 * (state_size + state_size / 128 + 1)];
+}
+
+Rewind::~Rewind() {
+  delete[] buffer;
+  delete[] records;
+  delete[] previous;
+  delete[] scratch;
+  delete[] encoded;
+}
+
+void Rewind::record() {
+  if (cursor >= 0) return; // Scrubbing, nothing new is being simulated
+
+  stage->saveState(scratch);
+
+  // The very first frame has nothing to diff against
+  bool hasPrevious = count > 0;
+  bool isKeyframe =
+      !hasPrevious || Stage::frame_counter % keyframe_interval == 0;
+
+  int deltaSize = hasPrevious ? encode(scratch, previous, encoded) : 0;
+  int keySize = isKeyframe ? encode(scratch, nullptr, encoded + deltaSize) : 0;
+  int size = deltaSize + keySize;
+
+  if (size > capacity) return; // Budget can't hold even a single frame
+
+  if (count == max_records) {
+    first = (first + 1) % max_records;
+    count--;
+  }
+
+  int offset = reserve(size);
+  memcpy(buffer + offset, encoded, size);
+  records[(first + count) % max_records] = {Stage::frame_counter, offset,
+                                            deltaSize, keySize};
+  count++;
+
+  // The frame just recorded becomes the base for the next delta
+  u8 *swap = previous;
+  previous = scratch;
+  scratch = swap;
+}
+
+bool Rewind::stepBack() {
+  int from = cursor < 0 ? count - 1 : cursor;
+  if (from <= 0) return false;
+  restore(from - 1);
+  return true;
+}
+
+bool Rewind::stepForward() {
+  if (cursor < 0 || cursor >= count - 1) return false;
+  restore(cursor + 1);
+  return true;
+}
+
+bool Rewind::seek(int frame) {
+  if (count == 0) return false;
+  int index = frame - recordAt(0).frame;
+  if (index < 0 || index >= count) return false;
+  restore(index);
+  return true;
+}
+
+void Rewind::resume() {
+  if (cursor < 0) return;
+
+  // Forget the future, the next recorded frame continues from here
+  count = cursor + 1;
+  Record &last = recordAt(cursor);
+  head = last.offset + last.delta_size + last.key_size;
+  cursor = -1;
+}
+
+bool Rewind::isScrubbing() { return cursor >= 0; }
+
+int Rewind::oldestFrame() { return count > 0 ? recordAt(0).frame : -1; }
+
+int Rewind::newestFrame() {
+  return count > 0 ? recordAt(count - 1).frame : -1;
+}
+
+int Rewind::currentFrame() {
+  if (count == 0) return -1;
+  return recordAt(cursor < 0 ? count - 1 : cursor).frame;
+}
+
+int Rewind::bytesUsed() {
+  int used = 0;
+  for (int i = 0; i < count; i++) {
+    used += recordAt(i).delta_size + recordAt(i).key_size;
+  }
+  return used;
+}
@@ -0,0 +1,147 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "Stage.h"
+#include "calico/types.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int REWIND_BUDGET_BYTES = 256 * 1024; // Byte ring for encoded frames
+const int REWIND_MAX_FRAMES = 600;          // 10 seconds at 60fps
+const int REWIND_KEYFRAME_INTERVAL = 60;    // One full snapshot per second
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Records the stage state every frame into a fixed size ring buffer so it
+ * can be scrubbed backwards and forwards while debugging.
+ *
+ * Every frame is stored as the XOR of its state with the previous frame's
+ * state, run length encoded (most bytes don't change, so most of the stream
+ * is zero runs). Applying the same delta twice undoes it, so one delta steps
+ * both backwards and forwards. A full keyframe is stored every
+ * REWIND_KEYFRAME_INTERVAL frames so seeks don't have to walk every delta.
+ */
+class Rewind {
+private:
+  struct Record {
+    int frame;      // Stage::frame_counter the record restores to
+    int offset;     // Where the record starts in the byte ring
+    int delta_size; // Encoded bytes of the delta from the previous frame
+    int key_size;   // Encoded bytes of the keyframe (0 if not a keyframe)
+  };
+
+  Stage *stage;
+  int state_size;
+  int keyframe_interval;
+
+  // Byte ring holding the encoded records back to back
+  u8 *buffer;
+  int capacity;
+  int head = 0;
+
+  // Ring of record descriptors, oldest at first
+  Record *records;
+  int max_records;
+  int first = 0;
+  int count = 0;
+
+  u8 *previous; // The state of the last recorded (or restored) frame
+  u8 *scratch;  // The state being recorded this frame
+  u8 *encoded;  // Worst case sized scratch space for encoding
+
+  int cursor = -1; // Index of the record currently restored, -1 when live
+
+  /**
+   * @brief Returns the record at an index counted from the oldest record
+   */
+  Record &recordAt(int index);
+
+  /**
+   * @brief Reserves space in the byte ring, evicting the oldest records
+   * @param size The number of bytes needed
+   * @return The offset of the reserved space
+   */
+  int reserve(int size);
+
+  /**
+   * @brief Run length encodes a ^ b (b may be nullptr to encode a raw)
+   * @return The number of encoded bytes written to out
+   */
+  int encode(const u8 *a, const u8 *b, u8 *out);
+
+  /**
+   * @brief XORs an encoded stream into a state buffer
+   */
+  void apply(const u8 *in, int size, u8 *state);
+
+  /**
+   * @brief Restores the stage to the state of the record at an index
+   */
+  void restore(int index);
+
+public:
+  /**
+   * @brief Allocates the rewind buffers for a stage. The stage must not add
+   *        or remove tanks while it is being recorded.
+   * @param stage The stage to record
+   * @param budget The size of the byte ring in bytes
+   * @param maxFrames The maximum number of frames to keep
+   * @param keyframeInterval The number of frames between keyframes
+   */
+  Rewind(Stage *stage, int budget = REWIND_BUDGET_BYTES,
+         int maxFrames = REWIND_MAX_FRAMES,
+         int keyframeInterval = REWIND_KEYFRAME_INTERVAL);
+
+  ~Rewind();
+
+  /**
+   * @brief Records the current stage state. Call once per simulated frame.
+   */
+  void record();
+
+  /**
+   * @brief Restores the frame before the one currently shown
+   * @return False if the oldest recorded frame is already shown
+   */
+  bool stepBack();
+
+  /**
+   * @brief Restores the frame after the one currently shown
+   * @return False if the newest recorded frame is already shown
+   */
+  bool stepForward();
+
+  /**
+   * @brief Restores any recorded frame, starting from the closest keyframe
+   * @param frame The Stage::frame_counter value to restore
+   * @return False if the frame is no longer (or not yet) recorded
+   */
+  bool seek(int frame);
+
+  /**
+   * @brief Drops every frame after the one currently shown so the
+   *        simulation can continue recording from there.
+   */
+  void resume();
+
+  /**
+   * @brief Whether a recorded frame is being shown instead of the live one
+   */
+  bool isScrubbing();
+
+  int oldestFrame();
+  int newestFrame();
+  int currentFrame();
+  int bytesUsed();
+};
+
+#endif // REWIND_H
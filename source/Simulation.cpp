@@ -0,0 +1,63 @@
+/*---------------------------------------------------------------------------------
+
+Simulation.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Simulation.h"
+#include "Bullet.h"
+#include "Tank.h"
+#include "TankAI.h"
+
+//---------------------------------------------------------------------------------
+//
+// FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void stepSimulation(Stage *stage) {
+  // Let the computer tanks react
+  Stage::profiler.begin(PROFILE_AI);
+  updateComputerTanks(stage);
+  Stage::profiler.end(PROFILE_AI);
+
+  // Update the sprite positions of the tanks still alive. This is also
+  // where a tank's body turns, which it has to finish before it moves.
+  Stage::profiler.begin(PROFILE_SPRITES);
+  for (Tank *tank : stage->active_tanks) {
+    tank->updateOAM();
+  }
+  Stage::profiler.end(PROFILE_SPRITES);
+
+  // Move the bullets in flight (a bullet may leave the list as it explodes)
+  Stage::profiler.begin(PROFILE_BULLETS);
+  for (Bullet *bullet : stage->live_bullets) {
+    bullet->updatePosition();
+    bullet->updateOAM();
+  }
+  Stage::profiler.end(PROFILE_BULLETS);
+
+  // Move and fade the sparks, smoke and debris
+  Stage::profiler.begin(PROFILE_SPRITES);
+  Stage::particles.update();
+  Stage::profiler.end(PROFILE_SPRITES);
+
+  Stage::profiler.begin(PROFILE_COLLISION);
+  // Checks to see if any bullets have collided
+  stage->checkForBulletCollision();
+  // Sets off any mines a tank has driven up to
+  stage->checkForMineTriggers();
+  Stage::profiler.end(PROFILE_COLLISION);
+
+  // Fire any cooldowns, animation frames and reloads that are due
+  Stage::timers.tick();
+
+  // Increment the frame counter
+  Stage::frame_counter++;
+}
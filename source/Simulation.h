@@ -0,0 +1,16 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Stage.h"
+
+/**
+ * @brief Steps the stage one frame: the computer tanks react, the tanks,
+ *        bullets and effects move, the hits are resolved and the timers that
+ *        are due go off. Everything but input and drawing, so the game and
+ *        the host's headless runner (utils/selfplay) step the same way. The
+ *        sprites are queued with Stage::renderer as they're moved.
+ * @param stage The stage to step
+ */
+void stepSimulation(Stage *stage);
+
+#endif // SIMULATION_H
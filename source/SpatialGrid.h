@@ -0,0 +1,108 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "IntrusiveList.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int GRID_CELL_SIZE = 16; // Matches the stage cell size
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Embedded in an object so it can be bucketed in a SpatialGrid
+ */
+template <typename T> struct GridHook {
+  ListHook<T> link;
+  int cell = -1; // The cell the object is bucketed in, -1 if none
+
+  explicit GridHook(T *owner) : link(owner) {}
+};
+
+/**
+ * Uniform grid bucketing objects by the cell their center point is in. Objects
+ * are only re-linked when they cross into a new cell, and queries only visit
+ * the cells overlapping the queried box. Sized to the arena by init().
+ */
+template <typename T> class SpatialGrid {
+private:
+  IntrusiveList<T> *cells = nullptr;
+  int cols = 0;
+  int rows = 0;
+
+  int clampCol(int x) {
+    int col = x / GRID_CELL_SIZE;
+    return col < 0 ? 0 : col >= cols ? cols - 1 : col;
+  }
+
+  int clampRow(int y) {
+    int row = y / GRID_CELL_SIZE;
+    return row < 0 ? 0 : row >= rows ? rows - 1 : row;
+  }
+
+public:
+  SpatialGrid() = default;
+  SpatialGrid(const SpatialGrid &) = delete;
+  SpatialGrid &operator=(const SpatialGrid &) = delete;
+  ~SpatialGrid() { delete[] cells; }
+
+  /**
+   * @brief Makes the grid cover an arena, empty. Call before anything is
+   *        bucketed.
+   * @param width The arena's width in pixels
+   * @param height The arena's height in pixels
+   */
+  void init(int width, int height) {
+    delete[] cells;
+    cols = (width + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+    rows = (height + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+    cells = new IntrusiveList<T>[cols * rows];
+  }
+
+  /**
+   * @brief Buckets (or re-buckets) an object by its center point
+   */
+  void move(GridHook<T> *hook, int x, int y) {
+    int cell = clampRow(y) * cols + clampCol(x);
+    if (cell == hook->cell) return;
+    if (hook->cell >= 0) cells[hook->cell].remove(&hook->link);
+    cells[cell].pushBack(&hook->link);
+    hook->cell = cell;
+  }
+
+  /**
+   * @brief Takes an object out of the grid
+   */
+  void remove(GridHook<T> *hook) {
+    if (hook->cell < 0) return;
+    cells[hook->cell].remove(&hook->link);
+    hook->cell = -1;
+  }
+
+  /**
+   * @brief Calls visit(T *) for every object bucketed in a cell overlapping
+   *        the box. Callers pad the box by the size of the objects since only
+   *        centers are bucketed. visit may take the visited object out of the
+   *        grid but not any other.
+   */
+  template <typename Visit>
+  void query(int x1, int y1, int x2, int y2, Visit visit) {
+    int col1 = clampCol(x1), col2 = clampCol(x2);
+    int row1 = clampRow(y1), row2 = clampRow(y2);
+    for (int row = row1; row <= row2; row++) {
+      for (int col = col1; col <= col2; col++) {
+        for (T *object : cells[row * cols + col]) visit(object);
+      }
+    }
+  }
+};
+
+#endif // SPATIAL_GRID_H
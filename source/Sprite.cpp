@@ -12,7 +12,6 @@ Camdyn Rasque
 
 #include "Sprite.h"
 #include "Stage.h"
-#include "sprite-sheet.h"
 
 #include <gl2d.h>
 
@@ -22,35 +21,51 @@ Camdyn Rasque
 //
 //-------------------------------------------------------------------------------
 
-int Sprite::num_sprites = 0; // Initialize the total number of sprites
+PER_THREAD int Sprite::num_sprites = 0; // Initialize the total number of sprites
+
+Sprite::Sprite() { num_sprites++; }
 
 Sprite::~Sprite() {
-  // Free the sprite's graphics memory from VRAM if it exists
-  if (gfx_mem != nullptr) {
-    oamFreeGfx(&oamMain, gfx_mem);
-    gfx_mem = nullptr;
-  }
+  // Make sure the timer wheel doesn't call back into a deleted sprite
+  stopAnimation();
+  releaseGfx();
 
   // Decrement the total sprite count
   num_sprites--;
 }
 
 void Sprite::initGfx() {
-  // Allocate 32x32 sprite graphics memory
-  gfx_mem = oamAllocateGfx(&oamMain, sprite_size, color_format);
+  // Every sprite showing the same frame shares its VRAM, so animating is
+  // just pointing the OAM entry somewhere else
+  const SpriteAtlasAnim &atlas_anim = sprite_atlasAnims[anim];
+  num_anim_frames = atlas_anim.num_frames;
+  if (num_anim_frames > SPRITE_MAX_ANIM_FRAMES) {
+    num_anim_frames = SPRITE_MAX_ANIM_FRAMES;
+  }
+  for (int i = 0; i < num_anim_frames; i++) {
+    frame_gfx[i] = Stage::sprite_gfx.acquire(
+        sprite_atlasFrames[atlas_anim.first_frame + i]);
+  }
 
-  // Set the frame_gfx pointer to the right position in the sprite sheet
-  int sprite_index =
-      sprite_sheet_pos.y * Sprite::SPRITE_SHEET_COLS + sprite_sheet_pos.x;
-  gfx_frame = (u8 *)sprite_sheetTiles + (sprite_index * tile_size * tile_size);
+  updateGfxFrame();
 }
 
-void Sprite::copyGfxFrameToVRAM() {
-  dmaCopy(gfx_frame, gfx_mem, tile_size * tile_size);
+void Sprite::releaseGfx() {
+  for (int i = 0; i < SPRITE_MAX_ANIM_FRAMES; i++) {
+    Stage::sprite_gfx.release(frame_gfx[i]);
+    frame_gfx[i] = nullptr;
+  }
+  gfx_mem = nullptr;
+}
+
+void Sprite::updateGfxFrame() {
+  frame = &sprite_atlasFrames[sprite_atlasAnims[anim].first_frame + anim_frame];
+  sheet_cell = frame->cell;
+  gfx_mem = frame_gfx[anim_frame];
 }
 
 void Sprite::incrementAnimationFrame(bool backwards, bool loop) {
-  if (hide || Stage::frame_counter % anim_speed != 0) return;
+  if (hide) return;
 
   if (backwards) {
     anim_frame = (anim_frame - 1 + num_anim_frames) % num_anim_frames;
@@ -66,19 +81,31 @@ void Sprite::incrementAnimationFrame(bool backwards, bool loop) {
     }
   }
 
-  // Match initGfx formula
-  int sprite_index = ((sprite_sheet_pos.y) * Sprite::SPRITE_SHEET_COLS +
-                      (sprite_sheet_pos.x + anim_frame));
-  gfx_frame = (u8 *)sprite_sheetTiles + (sprite_index * tile_size * tile_size);
+  updateGfxFrame();
 }
 
-void Sprite::updateOAM() {
-  // Apply rotation
-  oamRotateScale(&oamMain, affine_index, degreesToAngle(rotation_angle), 256,
-                 256);
+void Sprite::onAnimationTimer(void *context) {
+  Sprite *sprite = (Sprite *)context;
+  sprite->incrementAnimationFrame(sprite->anim_backwards, sprite->anim_loop);
+
+  if (!sprite->hide) {
+    Stage::timers.schedule(&sprite->anim_timer, sprite->anim_speed);
+  }
+}
+
+void Sprite::playAnimation(bool loop, bool backwards) {
+  anim_loop = loop;
+  anim_backwards = backwards;
+  hide = false;
+  setAnimationFrame(0);
+  Stage::timers.schedule(&anim_timer, anim_speed);
+}
+
+void Sprite::stopAnimation() { Stage::timers.cancel(&anim_timer); }
+
+void Sprite::setAnimationFrame(int frame) {
+  anim_frame = frame;
+  updateGfxFrame();
+}
 
-  // Update the sprite's position
-  oamSet(&oamMain, id, pos.x - tile_offset.x, pos.y - tile_offset.y, priority,
-         palette_alpha, sprite_size, color_format, gfx_mem, affine_index,
-         size_double, hide, hflip, vflip, mosaic);
-}
\ No newline at end of file
+void Sprite::updateOAM() { Stage::renderer.submit(this); }
\ No newline at end of file
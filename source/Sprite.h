@@ -1,67 +1,123 @@
 #ifndef SPRITE_H
 #define SPRITE_H
 
+#include "PerThread.h"
 #include "Position.h"
+#include "TimerWheel.h"
+#include "sprite-atlas.h"
 #include <nds.h>
 
+/**
+ * @brief Which sprites keep their OAM entries when there aren't enough to go
+ *        round. Lower ranks are placed first, the rest spill to gl2d.
+ */
+enum SpriteRank {
+  S_RANK_TANK = 0,   // Tank bodies and turrets
+  S_RANK_CURSOR = 1, // The stylus cursor and its tail
+  S_RANK_BULLET = 2, // Bullets in flight
+  S_RANK_EFFECT = 3, // Explosions and ricochet puffs
+  S_RANK_COUNT
+};
+
 class Sprite {
 private:
-  static const int SPRITE_SHEET_COLS = 4;
+  /**
+   * @brief Advances a playing animation, scheduled every anim_speed frames
+   */
+  static void onAnimationTimer(void *context);
+
+  /**
+   * @brief Points gfx_mem at the resident frame for the current anim_frame
+   */
+  void updateGfxFrame();
 
 public:
-  static int num_sprites; // The number of sprites on screen
+  static const int SPRITE_MAX_ANIM_FRAMES = 8;
+
+  static PER_THREAD int num_sprites; // The number of sprites created
 
   // Graphics related things
-  u16 *gfx_mem;  // Where in VRAM sprite is stored
-  u8 *gfx_frame; // The current frame in the sprite sheet
+  u16 *gfx_mem = nullptr; // The current frame in VRAM, shared with others
+  u16 *frame_gfx[SPRITE_MAX_ANIM_FRAMES] = {}; // Every frame, from the cache
+  const SpriteAtlasFrame *frame = nullptr; // The current frame's size, anchor
 
   Position pos = {0, 0};
   int tile_size = 32;
 
-  Position sprite_sheet_pos = {0, 0}; // x,y coord on sprite sheet
-  int num_anim_frames = 3;            // Number of frames in animation cycle
-  int anim_frame = 0;                 // The animation frame of the sprite
+  SpriteAnim anim = SPRITE_ANIM_CURSOR; // Animation in the sprite atlas
+  int num_anim_frames = 1; // Number of frames in animation cycle, from anim
+  int anim_frame = 0;      // The animation frame of the sprite
   int anim_speed = 2; // Speed of the animation (higher == slower)
+  bool anim_backwards = false; // Direction of the playing animation
+  bool anim_loop = true;       // Whether the playing animation repeats
+  Timer anim_timer = Timer(&Sprite::onAnimationTimer, this);
 
-  float rotation_angle = 0; // The rotation angle of the sprite
+  int rotation_angle = 0; // Binary angle of the sprite (see Angle.h)
+  bool rotates = false;   // Needs an affine matrix (or a rotated quad)
 
   Position tile_offset = {0, 0};
 
+  // Render Properties
+  SpriteRank rank = S_RANK_EFFECT; // Who keeps their OAM entry first
+  int sheet_cell = 0;    // The sprite sheet cell, for drawing with gl2d
+  int queued_frame = -1; // SpriteRenderer frame the sprite was queued in
+  int queued_index = 0;  // Where in its rank's queue
+
   // Object-Attribute Memory Properties
-  int id = 0;       // The ID of the sprite in the OAM
+  int id = -1;      // OAM entry assigned this frame, -1 if drawn with gl2d
   int priority = 0; // The priority of the sprite
   int palette_alpha = 0;
-  SpriteSize sprite_size = SpriteSize_32x32;
   SpriteColorFormat color_format = SpriteColorFormat_256Color;
-  int affine_index = 0;
+  int affine_index = -1; // Matrix assigned this frame, -1 if none
   bool size_double = false;
   bool hide = false;
   bool hflip = false;
   bool vflip = false;
   bool mosaic = false;
 
+  Sprite();
   virtual ~Sprite();
 
   /**
-   * @brief Allocated memory for the graphics in VRAM and points to the current
-   * frame
+   * @brief Looks anim up in the sprite atlas, takes a reference to each of
+   *        its frames in Stage::sprite_gfx and shows the current one
    */
   void initGfx();
 
   /**
-   * @brief Updates the gfx_frame reference with the new animation frame
-   *        of the sprite based on its state.
+   * @brief Lets go of the sprite's frames in Stage::sprite_gfx, the last
+   *        sprite to use a frame frees its VRAM
+   */
+  void releaseGfx();
+
+  /**
+   * @brief Moves on to the next animation frame
    */
   void incrementAnimationFrame(bool backwards = false, bool loop = true);
 
   /**
-   * @brief Needs to be called once per frame, updates VRAM with
-   *        the latest sprite gfx frame
+   * @brief Shows the sprite and plays its animation from the first frame,
+   *        advancing every anim_speed frames off the stage timer wheel.
+   * @param loop Whether to repeat, otherwise the sprite hides at the end
+   * @param backwards Whether to play the frames in reverse
+   */
+  void playAnimation(bool loop = true, bool backwards = false);
+
+  /**
+   * @brief Stops a playing animation on its current frame
+   */
+  void stopAnimation();
+
+  /**
+   * @brief Jumps straight to an animation frame (used when restoring state)
+   * @param frame The animation frame to show
    */
-  void copyGfxFrameToVRAM();
+  void setAnimationFrame(int frame);
 
   /**
-   * @brief Updates the object attribute memory
+   * @brief Queues the sprite to be drawn this frame. Stage::renderer decides
+   *        whether it gets an OAM entry or spills to gl2d. Hidden sprites
+   *        return straight away.
    */
   virtual void updateOAM();
 };
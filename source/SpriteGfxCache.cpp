@@ -0,0 +1,72 @@
+/*---------------------------------------------------------------------------------
+
+SpriteGfxCache.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "SpriteGfxCache.h"
+#include "Stage.h"
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void SpriteGfxCache::loadAtlas() {
+  if (atlas != nullptr) return;
+
+  MemoryScope scope(Stage::memory, MEM_RENDER);
+  atlas = new u8[sprite_atlasTilesLen];
+  decompress(sprite_atlasTiles, atlas, LZ77);
+  // Frames are DMAed out of here, so it has to be out of the cache
+  DC_FlushRange(atlas, sprite_atlasTilesLen);
+}
+
+u16 *SpriteGfxCache::acquire(const SpriteAtlasFrame &frame) {
+  for (int i = 0; i < count; i++) {
+    if (entries[i].tile_offset == frame.tile_offset) {
+      entries[i].refs++;
+      return entries[i].gfx;
+    }
+  }
+
+  if (count == GFX_CACHE_ENTRIES) return nullptr;
+  u16 *gfx = oamAllocateGfx(&oamMain, frame.size, SpriteColorFormat_256Color);
+  if (gfx == nullptr) return nullptr;
+
+  int bytes = frame.width * frame.height;
+  dmaCopy(atlas + frame.tile_offset, gfx, bytes);
+  entries[count++] = {gfx, frame.tile_offset, (u16)bytes, 1};
+  Stage::memory.add(MEM_SPRITE_VRAM, bytes);
+  return gfx;
+}
+
+void SpriteGfxCache::release(u16 *gfx) {
+  if (gfx == nullptr) return;
+
+  for (int i = 0; i < count; i++) {
+    if (entries[i].gfx != gfx) continue;
+    if (--entries[i].refs > 0) return;
+
+    // Last user gone, free the VRAM and keep the entries packed
+    oamFreeGfx(&oamMain, gfx);
+    Stage::memory.add(MEM_SPRITE_VRAM, -entries[i].bytes);
+    entries[i] = entries[--count];
+    return;
+  }
+}
+
+int SpriteGfxCache::bytesUsed() const {
+  int bytes = 0;
+  for (int i = 0; i < count; i++) {
+    bytes += entries[i].bytes;
+  }
+  return bytes;
+}
@@ -0,0 +1,77 @@
+#ifndef SPRITE_GFX_CACHE_H
+#define SPRITE_GFX_CACHE_H
+
+#include "sprite-atlas.h"
+#include <nds.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int GFX_CACHE_ENTRIES = 128; // Unique frames resident at once
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Sprite graphics in VRAM, shared between every sprite showing the same
+ * frame. The sprite atlas (see utils/assetc) is unpacked into main RAM
+ * once, then each unique frame is uploaded when first acquired and freed
+ * when its last user releases it, so animating is just pointing the OAM
+ * entry at another resident frame. Frames the atlas found identical share
+ * their tiles, and so share their VRAM too.
+ */
+class SpriteGfxCache {
+private:
+  struct Entry {
+    u16 *gfx;        // Where in VRAM the frame lives
+    u32 tile_offset; // Where in the atlas the frame's tiles are
+    u16 bytes;       // The size of the frame's tiles
+    u16 refs;        // Sprites using the frame
+  };
+
+  Entry entries[GFX_CACHE_ENTRIES];
+  int count = 0;
+  u8 *atlas = nullptr; // The unpacked atlas tiles
+
+public:
+  /**
+   * @brief Unpacks the atlas tiles into main RAM. Call once before any
+   *        sprite is created.
+   */
+  void loadAtlas();
+
+  /**
+   * @brief The unpacked atlas tiles, 8x8 tiles of 8 bit pixels
+   */
+  const u8 *atlasTiles() const { return atlas; }
+
+  /**
+   * @brief Finds (or uploads) a frame and takes a reference to it
+   * @param frame The frame, from sprite_atlasFrames
+   * @return The frame's VRAM, nullptr if the cache or VRAM is full
+   */
+  u16 *acquire(const SpriteAtlasFrame &frame);
+
+  /**
+   * @brief Drops a reference, freeing the frame once nothing uses it
+   */
+  void release(u16 *gfx);
+
+  /**
+   * @brief The number of unique frames resident in VRAM
+   */
+  int uniqueFrames() const { return count; }
+
+  /**
+   * @brief The sprite VRAM the resident frames take up
+   */
+  int bytesUsed() const;
+};
+
+#endif // SPRITE_GFX_CACHE_H
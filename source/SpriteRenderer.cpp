@@ -0,0 +1,189 @@
+/*---------------------------------------------------------------------------------
+
+SpriteRenderer.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "SpriteRenderer.h"
+#include "Angle.h"
+#include "Stage.h"
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool SpriteRenderer::placeInOam(const Queued &entry) {
+  Sprite *sprite = entry.sprite;
+  if (oam_used == SPRITE_COUNT) return false;
+  // No VRAM for its graphics, the entry would show whatever is at 0
+  if (sprite->gfx_mem == nullptr) return false;
+
+  int matrix = -1;
+  if (sprite->rotates) {
+    if (affine_used == MATRIX_COUNT) return false;
+    matrix = affine_used++;
+    oamRotateScale(&oamMain, matrix, sprite->rotation_angle, 256, 256);
+  }
+
+  sprite->id = oam_used++;
+  sprite->affine_index = matrix;
+  // Trimmed frames sit where their art is in the full cell, and frames
+  // stored as a mirror image of another are flipped back
+  const SpriteAtlasFrame *frame = sprite->frame;
+  int x = entry.x - Stage::camera.x, y = entry.y - Stage::camera.y;
+  oamSet(&oamMain, sprite->id, x + frame->anchor_x, y + frame->anchor_y,
+         sprite->priority, sprite->palette_alpha, frame->size,
+         sprite->color_format, sprite->gfx_mem, matrix, sprite->size_double,
+         false, sprite->hflip != (bool)frame->hflip,
+         sprite->vflip != (bool)frame->vflip, sprite->mosaic);
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+SpriteRenderer::SpriteRenderer() {
+  MemoryScope scope(Stage::memory, MEM_RENDER);
+  for (int rank = 0; rank < S_RANK_COUNT; rank++) {
+    queued[rank].reserve(SPRITE_COUNT);
+  }
+  spilled.reserve(SPRITE_COUNT);
+}
+
+void SpriteRenderer::loadTextures() {
+  // The atlas stores each frame trimmed and tiled for the OAM, put them
+  // back in their sheet cells as a plain bitmap for the texture
+  const int cellsPerRow = SHEET_TEXTURE_WIDTH / sprite_atlasCellSize;
+  const u8 *tiles = Stage::sprite_gfx.atlasTiles();
+  MemoryScope scope(Stage::memory, MEM_RENDER);
+  u8 *bitmap = new u8[SHEET_TEXTURE_WIDTH * SHEET_TEXTURE_HEIGHT]();
+
+  for (int f = 0; f < sprite_atlasFrameCount; f++) {
+    const SpriteAtlasFrame &frame = sprite_atlasFrames[f];
+    int left = (frame.cell % cellsPerRow) * sprite_atlasCellSize +
+               frame.anchor_x;
+    int top = (frame.cell / cellsPerRow) * sprite_atlasCellSize +
+              frame.anchor_y;
+    for (int y = 0; y < frame.height; y++) {
+      for (int x = 0; x < frame.width; x++) {
+        int sx = frame.hflip ? frame.width - 1 - x : x;
+        int sy = frame.vflip ? frame.height - 1 - y : y;
+        int i = ((sy / 8) * (frame.width / 8) + sx / 8) * 64 + (sy % 8) * 8 +
+                sx % 8;
+        bitmap[(top + y) * SHEET_TEXTURE_WIDTH + left + x] =
+            tiles[frame.tile_offset + i];
+      }
+    }
+  }
+
+  glLoadTileSet(sheet, 32, 32, SHEET_TEXTURE_WIDTH, SHEET_TEXTURE_HEIGHT,
+                GL_RGB256, TEXTURE_SIZE_128, TEXTURE_SIZE_512,
+                GL_TEXTURE_WRAP_S | GL_TEXTURE_WRAP_T | TEXGEN_OFF |
+                    GL_TEXTURE_COLOR0_TRANSPARENT,
+                256, sprite_atlasPal, bitmap);
+  Stage::memory.add(MEM_TEXTURE_VRAM,
+                    SHEET_TEXTURE_WIDTH * SHEET_TEXTURE_HEIGHT + 256 * 2);
+
+  delete[] bitmap;
+  textures_loaded = true;
+}
+
+void SpriteRenderer::submit(Sprite *sprite) {
+  if (sprite->hide) return;
+
+  Queued entry = {sprite, sprite->pos.x - sprite->tile_offset.x,
+                  sprite->pos.y - sprite->tile_offset.y};
+  std::vector<Queued> &rank = queued[sprite->rank];
+  if (sprite->queued_frame == frame) {
+    rank[sprite->queued_index] = entry;
+    return;
+  }
+
+  sprite->queued_frame = frame;
+  sprite->queued_index = rank.size();
+  rank.push_back(entry);
+}
+
+void SpriteRenderer::assignOam() {
+  oam_used = 0;
+  affine_used = 0;
+  culled = 0;
+  spilled.clear();
+
+  for (int rank = 0; rank < S_RANK_COUNT; rank++) {
+    for (const Queued &entry : queued[rank]) {
+      // It may have been hidden since it was queued (eg. an effect ending)
+      if (entry.sprite->hide) continue;
+      // Doubled affine sprites reach half a tile past their cell each way
+      int size = entry.sprite->tile_size;
+      if (!Stage::camera.isVisible(entry.x - size / 2, entry.y - size / 2,
+                                   size * 2, size * 2)) {
+        entry.sprite->id = -1;
+        entry.sprite->affine_index = -1;
+        culled++;
+        continue;
+      }
+      if (placeInOam(entry)) continue;
+      entry.sprite->id = -1;
+      entry.sprite->affine_index = -1;
+      spilled.push_back(entry);
+    }
+    queued[rank].clear();
+  }
+
+  // Only the entries used last frame can still be showing something
+  for (int i = oam_used; i < oam_entries_written; i++) {
+    oamClearSprite(&oamMain, i);
+  }
+  oam_entries_written = oam_used;
+  frame++;
+  Stage::memory.set(MEM_OAM, oam_used);
+  Stage::memory.set(MEM_AFFINE, affine_used);
+}
+
+void SpriteRenderer::discard() {
+  for (int rank = 0; rank < S_RANK_COUNT; rank++) queued[rank].clear();
+  frame++;
+}
+
+void SpriteRenderer::drawSpilled(DrawList &list) {
+  spill_drawn = 0;
+  spill_dropped = 0;
+  if (!textures_loaded) spilled.clear();
+
+  // Spilled by rank, so what doesn't fit is bullets and effects before
+  // tanks. Trimming here keeps DrawList from cutting into the layers below.
+  int fits = list.spritesLeft();
+  if ((int)spilled.size() > fits) {
+    spill_dropped = spilled.size() - fits;
+    spilled.resize(fits);
+  }
+
+  list.setLayer(D_LAYER_SPRITES);
+  list.setPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE | POLY_ID(4));
+  for (const Queued &entry : spilled) {
+    Sprite *sprite = entry.sprite;
+    const glImage *image = &sheet[sprite->sheet_cell];
+    if (sprite->rotates) {
+      // gl2d turns the other way to the OAM, about the sprite's center
+      list.spriteRotated(entry.x + sprite->tile_size / 2,
+                         entry.y + sprite->tile_size / 2,
+                         wrapAngle(-sprite->rotation_angle), image);
+    } else {
+      list.sprite(entry.x, entry.y, image);
+    }
+    spill_drawn++;
+  }
+  spilled.clear();
+}
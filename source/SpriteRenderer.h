@@ -0,0 +1,106 @@
+#ifndef SPRITE_RENDERER_H
+#define SPRITE_RENDERER_H
+
+#include "DrawList.h"
+#include "Sprite.h"
+#include <gl2d.h>
+#include <nds.h>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// The sprite sheet as a texture, 32x32 cells in a 128x512 bitmap
+const int SHEET_TEXTURE_WIDTH = 128;
+const int SHEET_TEXTURE_HEIGHT = 512;
+const int SHEET_CELLS = (SHEET_TEXTURE_WIDTH / 32) * (SHEET_TEXTURE_HEIGHT / 32);
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Decides every frame which sprites get one of the 128 OAM entries (and 32
+ * affine matrices), and draws the rest as textured gl2d quads in the 3D
+ * layer. Sprites are queued with Sprite::updateOAM() and placed by rank, so
+ * tanks keep their entries and bullets and effects are the first to spill.
+ * A sprite whose graphics didn't get VRAM (SpriteGfxCache ran out) spills
+ * too, the texture has every frame. Spilled quads go on the top layer of
+ * the frame's DrawList, as many as the geometry left after the rest of the
+ * 3D layer holds, and the lowest ranked that don't fit are dropped. Sprites
+ * out of the camera's view get neither, they're only drawn once they're
+ * back.
+ */
+class SpriteRenderer {
+private:
+  struct Queued {
+    Sprite *sprite;
+    int x; // Arena position of the sprite's top left when it was queued
+    int y;
+  };
+
+  std::vector<Queued> queued[S_RANK_COUNT]; // This frame's sprites by rank
+  std::vector<Queued> spilled; // Didn't get an OAM entry this frame
+  glImage sheet[SHEET_CELLS];  // The sprite sheet cells as gl2d images
+  bool textures_loaded = false;
+  int frame = 0;               // Stamps sprites so they queue once a frame
+  int oam_entries_written = 0; // Entries written last frame, to hide
+
+  /**
+   * @brief Hands the sprite an OAM entry (and matrix if it rotates)
+   * @return False if it needs one that has run out
+   */
+  bool placeInOam(const Queued &entry);
+
+public:
+  // What happened last frame, for the debug overlay
+  int oam_used = 0;    // OAM entries written
+  int affine_used = 0; // Affine matrices written
+  int spill_drawn = 0;   // Sprites drawn as gl2d quads
+  int spill_dropped = 0; // Spilled but past the geometry left, not drawn
+  int culled = 0;      // Sprites out of view, not drawn
+
+  SpriteRenderer();
+
+  /**
+   * @brief Uploads the sprite sheet as a texture so sprites can spill to
+   *        gl2d. Call once after glScreen2D() with VRAM_D mapped to
+   *        textures and VRAM_E to texture palettes.
+   */
+  void loadTextures();
+
+  /**
+   * @brief Queues a sprite for this frame at its current position. Hidden
+   *        sprites are skipped, queuing a sprite again moves it.
+   */
+  void submit(Sprite *sprite);
+
+  /**
+   * @brief Writes the queued sprites in view to the OAM shadow by rank, and
+   *        hides the entries that were in use last frame but not this one.
+   *        Sprites left over are kept for drawSpilled(). Call after the
+   *        camera has moved for the frame.
+   */
+  void assignOam();
+
+  /**
+   * @brief Drops the queued sprites without placing them, for a frame
+   *        that isn't shown (the host's headless runner)
+   */
+  void discard();
+
+  /**
+   * @brief Queues the sprites that didn't get OAM entries on the sprite
+   *        layer of the draw list, the highest ranked first as far as its
+   *        geometry goes. Call after the rest of the 3D layer is queued.
+   * @param list This frame's draw list
+   */
+  void drawSpilled(DrawList &list);
+};
+
+#endif // SPRITE_RENDERER_H
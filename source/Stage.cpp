@@ -11,11 +11,76 @@ Camdyn Rasque
 //---------------------------------------------------------------------------------
 
 #include "Stage.h"
+#include "Mine.h"
 #include "Tank.h"
+#include "Tcm.h"
 #include "stages/stage-1.h"
-#include "stages/stage-1_bg.h"
 #include "stages/stage-4.h"
-#include "stages/stage-4_bg.h"
+// Converted by utils/assetc, linked in with bin2o. Only the DS build has
+// them, the host (utils/selfplay) loads its stages from a StageLayout.
+#ifdef ARM9
+#include "bg_pal_bin.h"
+#include "bg_tiles_bin.h"
+#include "stage-1_barriers_bin.h"
+#include "stage-1_bg_map_bin.h"
+#include "stage-1_bg_tiles_bin.h"
+#include "stage-1_walls_bin.h"
+#include "stage-4_barriers_bin.h"
+#include "stage-4_bg_map_bin.h"
+#include "stage-4_bg_tiles_bin.h"
+#include "stage-4_walls_bin.h"
+#endif
+#include <algorithm>
+#include <string.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// A StageLayout's tanks are only known at run time, so its pool holds as
+// many bullets as any stage could need
+const int LAYOUT_MAX_BULLETS = MAX_STAGE_TANKS * MAX_TANK_BULLETS;
+static PER_THREAD Bullet layout_bullets[LAYOUT_MAX_BULLETS];
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief The live bullets' swept boxes by live_index, side by side so the
+ *        pair tests read them without going through each Bullet. No stage
+ *        has more bullets than a layout's pool.
+ */
+struct BulletSweeps {
+  short x[LAYOUT_MAX_BULLETS]; // Where the box starts the frame
+  short y[LAYOUT_MAX_BULLETS];
+  short dx[LAYOUT_MAX_BULLETS]; // How far it moves this frame
+  short dy[LAYOUT_MAX_BULLETS];
+};
+
+// Filled by checkForBulletCollision each frame, in DTCM with
+// TCM=BULLET_SWEEPS
+static PER_THREAD BulletSweeps bullet_sweeps BULLET_SWEEPS_DATA;
+
+//-------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//-------------------------------------------------------------------------------
+
+#ifdef ARM9
+/**
+ * @brief dmaCopy, except nothing is copied for 0 bytes (a DMA count of 0
+ *        would copy the most it can). A stage may have no tiles of its own.
+ */
+static void copyToVRAM(const void *source, void *dest, u32 size) {
+  if (size > 0) dmaCopy(source, dest, size);
+}
+#endif
 
 //-------------------------------------------------------------------------------
 //
@@ -23,91 +88,428 @@ Camdyn Rasque
 //
 //-------------------------------------------------------------------------------
 
-int Stage::frame_counter = 0;
+PER_THREAD int Stage::frame_counter = 0;
+PER_THREAD TimerWheel Stage::timers;
+PER_THREAD SpriteRenderer Stage::renderer;
+PER_THREAD DrawList Stage::draw_list;
+PER_THREAD ParticleSystem Stage::particles;
+PER_THREAD SpriteGfxCache Stage::sprite_gfx;
+PER_THREAD FrameProfiler Stage::profiler;
+// Constant initialized, so it's ready for allocations made by other statics
+PER_THREAD MemoryTracker Stage::memory;
+PER_THREAD Telemetry Stage::telemetry;
+PER_THREAD QualityGovernor Stage::governor;
+PER_THREAD int Stage::background = -1;
+PER_THREAD Camera Stage::camera;
+PER_THREAD Minimap Stage::minimap;
+
+void Stage::initGrids() {
+  tank_grid.init(terrain.getWidth(), terrain.getHeight());
+  bullet_grid.init(terrain.getWidth(), terrain.getHeight());
+  mine_grid.init(terrain.getWidth(), terrain.getHeight());
+}
+
+void Stage::initTanks() {
+  // Set tanks size
+  if (tanks != nullptr) num_tanks = tanks->size();
+  else num_tanks = 0;
+
+  // Every tank starts alive
+  for (int i = 0; i < num_tanks; i++) activateTank(tanks->at(i));
+
+  collision_scratch.reserve(bullet_capacity);
+  contacts.reserve(bullet_capacity * 2); // Only grows on crowded frames
+  mine_queue.reserve(mine_capacity);
+  tripped_mines.reserve(mine_capacity);
+}
 
 Stage::Stage(int stageNum) {
+  MemoryScope scope(memory, MEM_STAGE);
   stage_num = stageNum;
 
+  // Tanks check the barriers as they spawn, so load them first
+#ifdef ARM9
   if (stage_num == 1) {
-    tanks = CREATE_STAGE_1_TANKS(this);
-    barriers = STAGE_1_BARRIERS;
+    sassert(stage_1_barriers_bin_size == STAGE_1_WIDTH / 4 * STAGE_1_HEIGHT &&
+                stage_1_bg_map_bin_size ==
+                    STAGE_1_WIDTH / 8 * STAGE_1_HEIGHT / 8 * 2,
+            "Stage 1 assets don't match its size");
+    terrain.load(STAGE_1_WIDTH, STAGE_1_HEIGHT, stage_1_barriers_bin,
+                 (const u16 *)stage_1_bg_map_bin);
+    walls.load(&terrain, (const short *)stage_1_walls_bin);
   } else if (stage_num == 4) {
-    tanks = CREATE_STAGE_4_TANKS(this);
-    barriers = STAGE_4_BARRIERS;
+    sassert(stage_4_barriers_bin_size == STAGE_4_WIDTH / 4 * STAGE_4_HEIGHT &&
+                stage_4_bg_map_bin_size ==
+                    STAGE_4_WIDTH / 8 * STAGE_4_HEIGHT / 8 * 2,
+            "Stage 4 assets don't match its size");
+    terrain.load(STAGE_4_WIDTH, STAGE_4_HEIGHT, stage_4_barriers_bin,
+                 (const u16 *)stage_4_bg_map_bin);
+    walls.load(&terrain, (const short *)stage_4_walls_bin);
+  } else
+#endif
+  {
+    terrain.load(SCREEN_WIDTH, SCREEN_HEIGHT, nullptr, nullptr);
+    walls.load(&terrain, nullptr);
   }
+  initGrids();
 
-  // Set tanks size
-  if (tanks != nullptr) num_tanks = tanks->size();
-  else num_tanks = 0;
+  {
+    MemoryScope tankScope(memory, MEM_TANKS);
+    if (stage_num == 1) tanks = CREATE_STAGE_1_TANKS(this);
+    else if (stage_num == 4) tanks = CREATE_STAGE_4_TANKS(this);
+  }
+  initTanks();
+}
+
+Stage::Stage(const StageLayout &layout) {
+  MemoryScope scope(memory, MEM_STAGE);
+  stage_num = 0;
+  sassert(layout.num_spawns <= MAX_STAGE_TANKS, "Too many tanks for a stage");
+  bullet_pool = layout_bullets;
+  bullet_capacity = LAYOUT_MAX_BULLETS;
+
+  terrain.load(layout.width, layout.height, layout.barriers, layout.map);
+  walls.load(&terrain, layout.walls);
+  initGrids();
+
+  {
+    MemoryScope tankScope(memory, MEM_TANKS);
+    tanks = new std::vector<Tank *>();
+    for (int i = 0; i < layout.num_spawns; i++) {
+      const TankSpawn &spawn = layout.spawns[i];
+      const TankArchetype &archetype = layout.archetypes != nullptr
+                                           ? layout.archetypes[i]
+                                           : getTankArchetype(spawn.color);
+      sassert(archetype.max_bullets <= MAX_TANK_BULLETS,
+              "More bullets than MAX_TANK_BULLETS");
+      mine_capacity += archetype.max_mines;
+      tanks->push_back(new Tank(this, spawn.x, spawn.y, spawn.color,
+                                spawn.direction, archetype));
+    }
+  }
+  initTanks();
+}
+
+Stage::~Stage() {
+  if (tanks == nullptr) return;
+  for (int i = num_tanks - 1; i >= 0; i--) delete tanks->at(i);
+  delete tanks;
+  tanks = nullptr;
+}
+
+Bullet *Stage::claimBullets(int count) {
+  sassert(bullets_claimed + count <= bullet_capacity,
+          "Stage's bullet pool is too small");
+  Bullet *first = bullet_pool + bullets_claimed;
+  bullets_claimed += count;
+  return first;
+}
+
+void Stage::activateTank(Tank *tank) {
+  active_tanks.pushBack(&tank->active_hook);
+  behavior_groups[tank->archetype.behavior].pushBack(&tank->behavior_hook);
+  tank_grid.move(&tank->grid_hook, tank->getPosition('x') + TANK_SIZE / 2,
+                 tank->getPosition('y') + TANK_SIZE / 2);
+}
+
+void Stage::deactivateTank(Tank *tank) {
+  active_tanks.remove(&tank->active_hook);
+  behavior_groups[tank->archetype.behavior].remove(&tank->behavior_hook);
+  tank_grid.remove(&tank->grid_hook);
+}
+
+void Stage::rebuildActiveLists() {
+  for (int i = 0; i < num_tanks; i++) {
+    Tank *tank = tanks->at(i);
+    if (tank->alive) activateTank(tank);
+    else deactivateTank(tank);
+
+    for (int j = 0; j < tank->archetype.max_bullets; j++) {
+      Bullet *bullet = &tank->bullets[j];
+      if (bullet->in_flight && !bullet->has_exploded) {
+        live_bullets.pushBack(&bullet->live_hook);
+        Position center = bullet->getCenter();
+        bullet_grid.move(&bullet->grid_hook, center.x, center.y);
+      } else {
+        live_bullets.remove(&bullet->live_hook);
+        bullet_grid.remove(&bullet->grid_hook);
+      }
+    }
+
+    for (int j = 0; j < tank->archetype.max_mines; j++) {
+      Mine *mine = tank->mines[j];
+      if (mine->live) {
+        live_mines.pushBack(&mine->live_hook);
+        mine_grid.move(&mine->grid_hook, mine->pos.x, mine->pos.y);
+      } else {
+        live_mines.remove(&mine->live_hook);
+        mine_grid.remove(&mine->grid_hook);
+      }
+    }
+  }
 }
 
 void Stage::initBackground() {
-  // Set VRAM bank A for the background
-  vramSetBankA(VRAM_A_MAIN_BG);
-  // Initialize the tile background to last layer
-  int bg = bgInit(3, BgType_Text8bpp, BgSize_T_256x256, 31, 0);
-  bgSetPriority(bg, 3);
+  if (background < 0) {
+    // Set VRAM bank A for the background
+    vramSetBankA(VRAM_A_MAIN_BG);
+    // Initialize the tile background to last layer. The map (4 KB at the
+    // start of the bank) only holds the view, the tiles go after it.
+    background = bgInit(3, BgType_Text8bpp, BgSize_T_512x256, 0, 1);
+    bgSetPriority(background, 3);
+#ifdef ARM9
+    // Every stage draws with these, they stay put across stage switches
+    copyToVRAM(bg_tiles_bin, bgGetGfxPtr(background), bg_tiles_bin_size);
+    copyToVRAM(bg_pal_bin, BG_PALETTE, bg_pal_bin_size);
+#endif
+  }
 
+#ifdef ARM9
+  // The stage's own tiles go straight after the shared ones
+  u8 *ownTiles = (u8 *)bgGetGfxPtr(background) + bg_tiles_bin_size;
   if (stage_num == 1) {
-    // Copy stage 1 tiles to the background layer
-    dmaCopy(stage_1_bgTiles, bgGetGfxPtr(bg), stage_1_bgTilesLen);
-    dmaCopy(stage_1_bgMap, bgGetMapPtr(bg), stage_1_bgMapLen);
-    dmaCopy(stage_1_bgPal, BG_PALETTE, stage_1_bgPalLen);
+    copyToVRAM(stage_1_bg_tiles_bin, ownTiles, stage_1_bg_tiles_bin_size);
   } else if (stage_num == 4) {
-    // Copy stage 4 tiles to the background layer
-    dmaCopy(stage_4_bgTiles, bgGetGfxPtr(bg), stage_4_bgTilesLen);
-    dmaCopy(stage_4_bgMap, bgGetMapPtr(bg), stage_4_bgMapLen);
-    dmaCopy(stage_4_bgPal, BG_PALETTE, stage_4_bgPalLen);
+    copyToVRAM(stage_4_bg_tiles_bin, ownTiles, stage_4_bg_tiles_bin_size);
   }
+#endif
+
+  // The camera writes the map entries in view, and keeps them up to date
+  camera.attach(background, &terrain);
+  minimap.attach(&terrain);
 }
 
-int count = 0;
-void Stage::checkForBulletCollision() {
-  for (int i = 0; i < num_tanks; i++) {
-    for (int j = 0; j < tanks->at(i)->max_bullets; j++) {
-      if (!tanks->at(i)->bullets[j]->in_flight) continue;
-      Bullet *bullet1 = tanks->at(i)->bullets[j];
-      
-      // Check against all other bullets
-      for (int k = 0; k < num_tanks; k++) {
-        for (int l = 0; l < tanks->at(k)->max_bullets; l++) {
-          if (!tanks->at(k)->bullets[l]->in_flight) continue;
-          if (bullet1 == tanks->at(k)->bullets[l]) continue; // Skip self
-          
-          Bullet *bullet2 = tanks->at(k)->bullets[l];
-          
-          // Check for AABB collision
-          bool collision = 
-            bullet1->pos.x < bullet2->pos.x + bullet2->width &&
-            bullet1->pos.x + bullet1->width > bullet2->pos.x &&
-            bullet1->pos.y < bullet2->pos.y + bullet2->height &&
-            bullet1->pos.y + bullet1->height > bullet2->pos.y;
-            
-          if (collision) {
-            bullet1->explode();
-            bullet2->explode();
+BULLET_COLLISION_CODE void Stage::checkForBulletCollision() {
+  // Pairs are taken in the list's order, not by address, so the same frame
+  // resolves the same way wherever the bullets were allocated
+  sassert(live_bullets.size() <= LAYOUT_MAX_BULLETS,
+          "More live bullets than the sweeps hold");
+  BulletSweeps &sweeps = bullet_sweeps;
+  int index = 0;
+  for (Bullet *bullet : live_bullets) {
+    sweeps.x[index] = bullet->swept_from.x;
+    sweeps.y[index] = bullet->swept_from.y;
+    sweeps.dx[index] = bullet->pos.x - bullet->swept_from.x;
+    sweeps.dy[index] = bullet->pos.y - bullet->swept_from.y;
+    bullet->live_index = index++;
+  }
+
+  // Broadphase: only pairs bucketed in neighbouring cells get swept
+  contacts.clear();
+  for (Bullet *bullet : live_bullets) {
+    int i = bullet->live_index;
+    int dx = sweeps.dx[i];
+    int dy = sweeps.dy[i];
+    CollisionBox box = {sweeps.x[i], sweeps.y[i], bullet->width,
+                        bullet->height};
+    Position center = bullet->getCenter();
+
+    // Against the other bullets, each pair once. Every bullet is the same
+    // size.
+    int reach = bullet->width + 2 * BULLET_MAX_SWEEP;
+    bullet_grid.query(
+        center.x - reach, center.y - reach, center.x + reach,
+        center.y + reach, [&](Bullet *other) {
+          int j = other->live_index;
+          if (j <= i) return;
+          CollisionBox otherBox = {sweeps.x[j], sweeps.y[j], box.w, box.h};
+          int toi;
+          if (sweepBoxes(box, dx, dy, otherBox, sweeps.dx[j], sweeps.dy[j],
+                         toi)) {
+            contacts.push_back({toi, bullet, other, nullptr});
           }
-        }
-      }
+        });
+
+    // Against the tanks still alive, which barely move in a frame
+    reach = TANK_SIZE + BULLET_MAX_SWEEP;
+    tank_grid.query(center.x - reach, center.y - reach, center.x + reach,
+                    center.y + reach, [&](Tank *tank) {
+                      // Skip the owner until the bullet has bounced
+                      if (bullet->getOwner() == tank &&
+                          bullet->num_ricochets == 0) {
+                        return;
+                      }
+                      Position tankPos = tank->getOffsetPosition();
+                      CollisionBox tankBox = {tankPos.x, tankPos.y,
+                                              tank->width, tank->height};
+                      int toi;
+                      if (sweepBoxes(box, dx, dy, tankBox, 0, 0, toi)) {
+                        contacts.push_back({toi, bullet, nullptr, tank});
+                      }
+                    });
+  }
+
+  // Resolve in the order they happened, a bullet only pops the first thing
+  // it reaches. Ties keep the order they were found in.
+  std::stable_sort(
+      contacts.begin(), contacts.end(),
+      [](const Contact &a, const Contact &b) { return a.toi < b.toi; });
+  for (const Contact &contact : contacts) {
+    if (contact.bullet->has_exploded) continue;
+    if (contact.other != nullptr) {
+      if (contact.other->has_exploded) continue;
+      contact.bullet->explode();
+      contact.other->explode();
+    } else {
+      if (!contact.tank->alive) continue;
+      contact.bullet->explode();
+      contact.tank->explode();
+    }
+  }
+
+  // Snapshot the live bullets, exploding removes them from the list
+  collision_scratch.clear();
+  for (Bullet *bullet : live_bullets) collision_scratch.push_back(bullet);
+
+  for (Bullet *bullet : collision_scratch) {
+    if (bullet->has_exploded) continue;
+
+    // Check against the mines near the bullet
+    Mine *hitMine = nullptr;
+    Position center = bullet->getCenter();
+    int reach = MINE_SIZE / 2 + bullet->width / 2;
+    mine_grid.query(center.x - reach, center.y - reach, center.x + reach,
+                    center.y + reach, [&](Mine *mine) {
+                      int dx = mine->pos.x - center.x;
+                      int dy = mine->pos.y - center.y;
+                      if (dx < reach && dx > -reach && dy < reach &&
+                          dy > -reach) {
+                        hitMine = mine;
+                      }
+                    });
+
+    if (hitMine != nullptr) {
+      bullet->explode();
+      detonateMine(hitMine);
+    }
+  }
+}
+
+void Stage::checkForMineTriggers() {
+  // Collect first, a blast takes other mines out of the list
+  tripped_mines.clear();
+  for (Mine *mine : live_mines) {
+    bool tripped = false;
+    int reach = MINE_TRIGGER_RADIUS;
+    tank_grid.query(mine->pos.x - reach, mine->pos.y - reach,
+                    mine->pos.x + reach, mine->pos.y + reach,
+                    [&](Tank *tank) {
+                      if (mine->isTrippedBy(tank)) tripped = true;
+                    });
+    if (tripped) tripped_mines.push_back(mine);
+  }
+
+  for (Mine *mine : tripped_mines) detonateMine(mine);
+}
+
+void Stage::detonateMine(Mine *mine) {
+  if (!mine->live) return;
+
+  // Breadth first, so any length of chain goes off this frame without
+  // recursing. Detonating takes a mine off the grid, it's only queued once.
+  mine_queue.clear();
+  mine->detonate();
+  mine_queue.push_back(mine);
 
-      // Check against all other tanks
-      for (int k = 0; k < num_tanks; k++) {
-        if (tanks->at(i) == tanks->at(k) && bullet1->num_ricochets == 0) continue; // Skip self
-        if (!tanks->at(k)->alive) continue; // Skip destroyed tanks
-
-        // Check for AABB collision
-        Position tankPos = tanks->at(k)->getOffsetPosition();
-        bool collision = 
-          bullet1->pos.x < tankPos.x + tanks->at(k)->width &&
-          bullet1->pos.x + bullet1->width > tankPos.x &&
-          bullet1->pos.y < tankPos.y + tanks->at(k)->height &&
-          bullet1->pos.y + bullet1->height > tankPos.y;
-
-        if (collision) {
-          bullet1->explode();
-          tanks->at(k)->explode();
-        }
+  for (int i = 0; i < (int)mine_queue.size(); i++) {
+    Position center = mine_queue[i]->pos;
+    int r = MINE_BLAST_RADIUS;
+    int x1 = center.x - r, y1 = center.y - r;
+    int x2 = center.x + r, y2 = center.y + r;
+    auto caught = [&](int x, int y) {
+      int dx = x - center.x;
+      int dy = y - center.y;
+      return dx * dx + dy * dy <= r * r;
+    };
+
+    tank_grid.query(x1, y1, x2, y2, [&](Tank *tank) {
+      if (caught(tank->getPosition('x') + TANK_SIZE / 2,
+                 tank->getPosition('y') + TANK_SIZE / 2)) {
+        tank->explode();
       }
+    });
+
+    bullet_grid.query(x1, y1, x2, y2, [&](Bullet *bullet) {
+      Position bulletCenter = bullet->getCenter();
+      if (caught(bulletCenter.x, bulletCenter.y)) bullet->explode();
+    });
+
+    mine_grid.query(x1, y1, x2, y2, [&](Mine *other) {
+      if (!caught(other->pos.x, other->pos.y)) return;
+      other->detonate();
+      mine_queue.push_back(other);
+    });
+
+    terrain.destroyInRadius(center, r);
+  }
+}
+
+int Stage::stateSize() {
+  int size = sizeof(frame_counter) + terrain.stateSize();
+  for (int i = 0; i < num_tanks; i++) {
+    size += sizeof(TankState);
+    size += tanks->at(i)->archetype.max_bullets * sizeof(BulletState);
+    size += tanks->at(i)->archetype.max_mines * sizeof(MineState);
+  }
+  return size;
+}
+
+void Stage::saveState(u8 *out) {
+  memcpy(out, &frame_counter, sizeof(frame_counter));
+  out += sizeof(frame_counter);
+  terrain.saveState(out);
+  out += terrain.stateSize();
+
+  for (int i = 0; i < num_tanks; i++) {
+    Tank *tank = tanks->at(i);
+    TankState tankState;
+    tank->captureState(tankState);
+    memcpy(out, &tankState, sizeof(tankState));
+    out += sizeof(tankState);
+
+    for (int j = 0; j < tank->archetype.max_bullets; j++) {
+      BulletState bulletState;
+      tank->bullets[j].captureState(bulletState);
+      memcpy(out, &bulletState, sizeof(bulletState));
+      out += sizeof(bulletState);
+    }
+
+    for (int j = 0; j < tank->archetype.max_mines; j++) {
+      MineState mineState;
+      tank->mines[j]->captureState(mineState);
+      memcpy(out, &mineState, sizeof(mineState));
+      out += sizeof(mineState);
     }
   }
-}
\ No newline at end of file
+}
+
+void Stage::loadState(const u8 *in) {
+  memcpy(&frame_counter, in, sizeof(frame_counter));
+  in += sizeof(frame_counter);
+  terrain.loadState(in);
+  in += terrain.stateSize();
+
+  for (int i = 0; i < num_tanks; i++) {
+    Tank *tank = tanks->at(i);
+    TankState tankState;
+    memcpy(&tankState, in, sizeof(tankState));
+    tank->restoreState(tankState);
+    in += sizeof(tankState);
+
+    for (int j = 0; j < tank->archetype.max_bullets; j++) {
+      BulletState bulletState;
+      memcpy(&bulletState, in, sizeof(bulletState));
+      tank->bullets[j].restoreState(bulletState);
+      in += sizeof(bulletState);
+    }
+
+    for (int j = 0; j < tank->archetype.max_mines; j++) {
+      MineState mineState;
+      memcpy(&mineState, in, sizeof(mineState));
+      tank->mines[j]->restoreState(mineState);
+      in += sizeof(mineState);
+    }
+  }
+
+  rebuildActiveLists();
+}
@@ -1,28 +1,199 @@
 #ifndef STAGE_H
 #define STAGE_H
 
+#include "Camera.h"
+#include "Collision.h"
+#include "DrawList.h"
+#include "FrameProfiler.h"
+#include "IntrusiveList.h"
+#include "MemoryTracker.h"
+#include "Minimap.h"
+#include "ParticleSystem.h"
+#include "PerThread.h"
+#include "QualityGovernor.h"
+#include "Position.h"
+#include "SpatialGrid.h"
+#include "SpriteGfxCache.h"
+#include "SpriteRenderer.h"
+#include "TankArchetype.h"
+#include "Telemetry.h"
+#include "Terrain.h"
+#include "TimerWheel.h"
+#include "WallGeometry.h"
+#include "calico/types.h"
 #include "nds/arm9/video.h"
 #include <vector>
 
+class Bullet;
+class Mine;
+class Sprite;
 class Tank;
+struct TankSpawn;
+
+/**
+ * @brief: A stage that isn't one of the built in ones, eg. one generated by
+ *         utils/stagegen. Nothing is copied, everything it points at is read
+ *         for as long as the stage is around (like the linked in assets).
+ */
+struct StageLayout {
+  int width; // Whole chunks, see Terrain::load
+  int height;
+  const u8 *barriers; // Packed by utils/assetc (or stagegen) 4 pixels a byte
+  const u16 *map;     // The BG map, nullptr for none
+  const short *walls; // Wall faces, the table utils/assetc writes
+  const TankSpawn *spawns; // The player first
+  int num_spawns;
+  // One a spawn, to play the tanks with instead of their colors' own (eg.
+  // to tune them), nullptr for none
+  const TankArchetype *archetypes;
+};
+
 class Stage {
+private:
+  /**
+   * @brief: A hit found by the swept tests, resolved in toi order. Either
+   *         other or tank is set.
+   */
+  struct Contact {
+    int toi; // When in the frame, 0 to TOI_ONE
+    Bullet *bullet;
+    Bullet *other;
+    Tank *tank;
+  };
+
+  std::vector<Contact> contacts;           // Reused by checkForBulletCollision
+  std::vector<Bullet *> collision_scratch; // Reused by checkForBulletCollision
+  std::vector<Mine *> mine_queue;          // Mines going off this frame
+  std::vector<Mine *> tripped_mines;       // Reused by checkForMineTriggers
+
+  /**
+   * @brief: Sizes the grids to the terrain just loaded
+   */
+  void initGrids();
+
+  /**
+   * @brief: Starts every tank alive, and sizes the collision scratch space
+   *         for the bullets and mines they have
+   */
+  void initTanks();
+
 public:
-  static int frame_counter; // Keep track of frames
+  // One of each per thread on the host, see PerThread.h
+  static PER_THREAD int frame_counter; // Keep track of frames
+  // Cooldowns, animations and other timed events
+  static PER_THREAD TimerWheel timers;
+  static PER_THREAD SpriteRenderer renderer; // Splits sprites, OAM or gl2d
+  static PER_THREAD DrawList draw_list;       // This frame's gl2d draws
+  static PER_THREAD ParticleSystem particles; // Sparks, smoke and debris
+  static PER_THREAD SpriteGfxCache sprite_gfx; // Sprite frames in VRAM, shared
+  static PER_THREAD FrameProfiler profiler;    // Times each part of the frame
+  static PER_THREAD MemoryTracker memory;   // Heap, VRAM and OAM use, budgets
+  static PER_THREAD Telemetry telemetry;    // Binary log of frames and events
+  static PER_THREAD QualityGovernor governor; // Sheds cosmetic work when slow
+  static PER_THREAD int background; // BG layer every stage draws on, or -1
+  static PER_THREAD Camera camera;   // The screen's view of the arena
+  static PER_THREAD Minimap minimap; // The whole arena on the bottom screen
 
   int stage_num; // The number stage to load
   int num_tanks; // The number of tanks in the stage
+  // Every tank's bullets, an array sized at compile time for the stage
+  Bullet *bullet_pool = nullptr;
+  int bullet_capacity = 0; // Bullets all tanks can have in flight at once
+  int bullets_claimed = 0; // Handed out to tanks so far
+  int mine_capacity = 0;   // Mines all tanks can have laid at once
 
-  const int (*barriers)[SCREEN_WIDTH];
+  Terrain terrain;    // Barriers and the BG map drawn over them, arena sized
+  WallGeometry walls; // Faces of the walls, for ricochets and sight lines
   std::vector<Tank *> *tanks = nullptr; // Array of tank structs in the stage
+  // Per-frame work only walks these, they change on fire/explode/reset
+  IntrusiveList<Tank> active_tanks;   // Tanks still alive
+  IntrusiveList<Bullet> live_bullets; // Bullets moving across the stage
+  // Alive tanks bucketed by behavior so each bucket runs one AI path
+  IntrusiveList<Tank> behavior_groups[T_BEHAVIOR_COUNT];
+  IntrusiveList<Mine> live_mines; // Mines laid and waiting to go off
+  // Bucketed by cell so proximity checks only look at their neighbours
+  SpatialGrid<Tank> tank_grid;
+  SpatialGrid<Bullet> bullet_grid;
+  SpatialGrid<Mine> mine_grid;
 
   Stage(int stageNum); // Constructor
 
+  /**
+   * @brief Loads a stage that isn't built in, numbered 0
+   */
+  Stage(const StageLayout &layout);
+
+  /**
+   * @brief Deletes the stage's tanks, and their bullets and mines
+   */
+  ~Stage();
+
+  /**
+   * @brief Shows the stage's background. The first stage sets up the layer
+   *        with the tiles and palette all stages share, after that only the
+   *        stage's own tiles are uploaded. The camera streams the map, and
+   *        the minimap draws the walls.
+   */
   void initBackground();
 
   /**
-   * @brief: Checks to see if two bullets have collided
+   * @brief: Hands a tank its bullets from the stage's pool
+   * @param count The tank's max_bullets
+   * @return The first of count bullets, attached to nothing yet
+   */
+  Bullet *claimBullets(int count);
+
+  /**
+   * @brief: Adds a tank to the active lists (on spawn / reset)
+   */
+  void activateTank(Tank *tank);
+
+  /**
+   * @brief: Removes a tank from the active lists (on explode)
+   */
+  void deactivateTank(Tank *tank);
+
+  /**
+   * @brief: Rebuilds every active list from the entities' flags, used after
+   *         a state has been loaded
+   */
+  void rebuildActiveLists();
+
+  /**
+   * @brief: Checks to see if bullets have hit each other, a tank or a mine.
+   *         Bullets and tanks are swept over the frame so fast bullets
+   *         can't pass through each other between frames.
    */
   void checkForBulletCollision();
+
+  /**
+   * @brief: Sets off any mine with a tank close enough to trip it
+   */
+  void checkForMineTriggers();
+
+  /**
+   * @brief: Sets a mine off along with every mine caught in its blast, all
+   *         within this frame. The blasts take out tanks, bullets and
+   *         destructible walls.
+   */
+  void detonateMine(Mine *mine);
+
+  /**
+   * @brief: The number of bytes saveState writes for this stage
+   */
+  int stateSize();
+
+  /**
+   * @brief: Serializes the simulation state of every tank, bullet and mine
+   * @param out Buffer of at least stateSize() bytes
+   */
+  void saveState(u8 *out);
+
+  /**
+   * @brief: Restores a state previously written by saveState
+   * @param in Buffer of stateSize() bytes
+   */
+  void loadState(const u8 *in);
 };
 
 #endif // STAGE_H
\ No newline at end of file
@@ -14,22 +14,35 @@ Camdyn Rasque
 #include "Bullet.h"
 #include "Sprite.h"
 #include "Stage.h"
-#include <math.h>
-#include <gl2d.h>
+#include "Tcm.h"
 
 #include <stdio.h>
 
+// Tank sprites are picked by color from consecutive atlas animations
+static_assert(SPRITE_ANIM_TANK_BODY_BLACK - SPRITE_ANIM_TANK_BODY_BLUE ==
+                  T_COLOR_BLACK - T_COLOR_BLUE,
+              "Tank body animations need to be in TankColor order");
+static_assert(SPRITE_ANIM_TANK_TURRET_BLACK - SPRITE_ANIM_TANK_TURRET_BLUE ==
+                  T_COLOR_BLACK - T_COLOR_BLUE,
+              "Tank turret animations need to be in TankColor order");
+
 //---------------------------------------------------------------------------------
 //
 // HELPER FUNCTIONS
 //
 //---------------------------------------------------------------------------------
 
-float calculateAngle(int x1, int y1, int x2, int y2) {
-  float deltaX = x2 - x1;
-  float deltaY = y2 - y1;
-  float angle = atan2(deltaY, deltaX) * (180.0 / M_PI);
-  return angle < 0 ? angle + 360 : angle;
+int calculateAngle(int x1, int y1, int x2, int y2) {
+  return angleAtan2(y2 - y1, x2 - x1);
+}
+
+/**
+ * @brief The turret angle that points from one point towards another. Turret
+ *        angles start at +y and turn clockwise on screen.
+ */
+static int turretAngleTowards(Position from, Position to) {
+  return wrapAngle(angleFromDegrees(270) -
+                   calculateAngle(from.x, from.y, to.x, to.y));
 }
 
 //---------------------------------------------------------------------------------
@@ -41,32 +54,12 @@ float calculateAngle(int x1, int y1, int x2, int y2) {
 bool Tank::isWithinBounds(Position &pos) {
   bool tooFarUp = pos.y < 0;
   bool tooFarLeft = pos.x < 0;
-  bool tooFarDown = pos.y + this->height - 1 >= SCREEN_HEIGHT;
-  bool tooFarRight = pos.x + this->width - 1 >= SCREEN_WIDTH;
+  bool tooFarDown = pos.y + this->height - 1 >= stage->terrain.getHeight();
+  bool tooFarRight = pos.x + this->width - 1 >= stage->terrain.getWidth();
   return !tooFarUp && !tooFarLeft && !tooFarDown && !tooFarRight;
 }
 
-bool Tank::noTanksCollided(Position &pos) {
-  for (int i = 0; i < stage->num_tanks; i++) {
-    if (this == stage->tanks->at(i)) continue; // Skip checking against itself
-
-    // Grab the tank position
-    Position tankPos = stage->tanks->at(i)->getPosition();
-
-    // Check for overlap on the x and y axes
-    bool xOverlap = !(pos.x + width <= tankPos.x ||
-                      tankPos.x + stage->tanks->at(i)->width <= pos.x);
-    bool yOverlap = !(pos.y + height <= tankPos.y ||
-                      tankPos.y + stage->tanks->at(i)->height <= pos.y);
-
-    if (xOverlap && yOverlap) {
-      return false; // Collision detected
-    }
-  }
-  return true; // No collisions found
-}
-
-bool Tank::noBarrierCollisions(Position &pos) {
+TANK_BARRIERS_CODE bool Tank::noBarrierCollisions(Position &pos) {
   // Check each corner of the tank for collisions with barriers
   int x1 = pos.x;
   int y1 = pos.y;
@@ -74,28 +67,97 @@ bool Tank::noBarrierCollisions(Position &pos) {
   int y2 = pos.y + height - 1;
 
   // Ensure the tank is within the bounds of the stage
-  if (x1 < 0 || y1 < 0 || x2 >= SCREEN_WIDTH || y2 >= SCREEN_HEIGHT) {
+  if (!stage->terrain.inBounds(x1, y1) || !stage->terrain.inBounds(x2, y2)) {
     return false; // Out of bounds, treat as a collision
   }
 
-  // Check the four corners of the tank for standard barrier collisions
-  if (stage->barriers[y1][x1] == 1 || stage->barriers[y1][x2] == 1 ||
-      stage->barriers[y2][x1] == 1 || stage->barriers[y2][x2] == 1) {
+  // Check the four corners of the tank for wall, hole and destructible
+  // barrier collisions
+  if (stage->terrain.blocksTanks(x1, y1) || stage->terrain.blocksTanks(x2, y1) ||
+      stage->terrain.blocksTanks(x1, y2) || stage->terrain.blocksTanks(x2, y2)) {
     return false; // Collision detected
   }
 
-  // Check the four corners of the tank for hole barrier collisions
-  if (stage->barriers[y1][x1] == 2 || stage->barriers[y1][x2] == 2 ||
-      stage->barriers[y2][x1] == 2 || stage->barriers[y2][x2] == 2) {
-    return false; // Collision detected
+  return true; // No collisions with barriers
+}
+
+int Tank::gatherBlockingTanks(int dx, int dy, Tank **blockers) {
+  // Bounding box of the whole sweep
+  Position pos = getPosition();
+  int minX = dx < 0 ? pos.x + dx : pos.x;
+  int minY = dy < 0 ? pos.y + dy : pos.y;
+  int maxX = (dx > 0 ? pos.x + dx : pos.x) + width;
+  int maxY = (dy > 0 ? pos.y + dy : pos.y) + height;
+
+  int numBlockers = 0;
+  for (Tank *other : stage->active_tanks) {
+    if (numBlockers == MAX_STAGE_TANKS) break;
+    if (other == this) continue;
+
+    Position otherPos = other->getPosition();
+    if (otherPos.x >= maxX || otherPos.x + other->width <= minX) continue;
+    if (otherPos.y >= maxY || otherPos.y + other->height <= minY) continue;
+    blockers[numBlockers++] = other;
   }
+  return numBlockers;
+}
 
-  return true; // No collisions with barriers
+bool Tank::canOccupy(Position &pos, Tank **blockers, int numBlockers) {
+  if (!isWithinBounds(pos) || !noBarrierCollisions(pos)) return false;
+
+  for (int i = 0; i < numBlockers; i++) {
+    Position otherPos = blockers[i]->getPosition();
+    bool xOverlap = !(pos.x + width <= otherPos.x ||
+                      otherPos.x + blockers[i]->width <= pos.x);
+    bool yOverlap = !(pos.y + height <= otherPos.y ||
+                      otherPos.y + blockers[i]->height <= pos.y);
+    if (xOverlap && yOverlap) return false;
+  }
+  return true;
 }
 
-bool Tank::validateMove(Position &pos) {
-  return isWithinBounds(pos) && noTanksCollided(pos) &&
-         noBarrierCollisions(pos);
+bool Tank::sweepMove(int dx, int dy) {
+  Tank *blockers[MAX_STAGE_TANKS];
+  int numBlockers = gatherBlockingTanks(dx, dy, blockers);
+
+  Position start = getPosition();
+  Position pos = start;
+  int stepX = dx > 0 ? 1 : -1;
+  int stepY = dy > 0 ? 1 : -1;
+  int remainingX = dx > 0 ? dx : -dx;
+  int remainingY = dy > 0 ? dy : -dy;
+
+  while (remainingX > 0 || remainingY > 0) {
+    Position both = {pos.x + (remainingX > 0 ? stepX : 0),
+                     pos.y + (remainingY > 0 ? stepY : 0)};
+    Position alongX = {both.x, pos.y};
+    Position alongY = {pos.x, both.y};
+
+    if (canOccupy(both, blockers, numBlockers)) {
+      pos = both;
+    } else if (remainingX > 0 && canOccupy(alongX, blockers, numBlockers)) {
+      // Slide along a wall that blocks y
+      pos = alongX;
+      remainingY = 0;
+      kinematics.stopY();
+    } else if (remainingY > 0 && canOccupy(alongY, blockers, numBlockers)) {
+      // Slide along a wall that blocks x
+      pos = alongY;
+      remainingX = 0;
+      kinematics.stopX();
+    } else {
+      kinematics.stopX();
+      kinematics.stopY();
+      break;
+    }
+
+    if (remainingX > 0) remainingX--;
+    if (remainingY > 0) remainingY--;
+  }
+
+  if (pos.x == start.x && pos.y == start.y) return false;
+  setPosition(pos.x, pos.y);
+  return true;
 }
 
 void Tank::addPositionHistory() {
@@ -114,153 +176,61 @@ void Tank::addPositionHistory() {
 //---------------------------------------------------------------------------------
 
 Tank::Tank(Stage *stage, int x, int y, TankColor color, TankDirection direction)
-    : stage(stage), color(color) {
-  // Set tank attributes base on the tank color
-  switch (color) {
-  case T_COLOR_BROWN:
-    movement = T_MOVEMENT_STATIONARY;
-    bullet_speed = B_SPEED_NORMAL;
-    fire_rate_cooldown = T_COOLDOWN_SLOW;
-    max_bullet_ricochets = 1;
-    max_bullets = 1;
-    behavior = T_BEHAVIOR_PASSIVE;
-    break;
-  case T_COLOR_ASH:
-    movement = T_MOVEMENT_SLOW;
-    bullet_speed = B_SPEED_NORMAL;
-    fire_rate_cooldown = T_COOLDOWN_SLOW;
-    max_bullet_ricochets = 1;
-    max_bullets = 1;
-    behavior = T_BEHAVIOR_DEFENSIVE;
-    break;
-  case T_COLOR_MARINE:
-    movement = T_MOVEMENT_SLOW;
-    bullet_speed = B_SPEED_FAST;
-    fire_rate_cooldown = T_COOLDOWN_SLOW;
-    max_bullet_ricochets = 0;
-    max_bullets = 1;
-    behavior = T_BEHAVIOR_DEFENSIVE;
-    break;
-  case T_COLOR_YELLOW:
-    movement = T_MOVEMENT_NORMAL;
-    bullet_speed = B_SPEED_NORMAL;
-    fire_rate_cooldown = T_COOLDOWN_SLOW;
-    max_bullet_ricochets = 1;
-    max_bullets = 1;
-    behavior = T_BEHAVIOR_INCAUTIOUS;
-    break;
-  case T_COLOR_PINK:
-    movement = T_MOVEMENT_SLOW;
-    bullet_speed = B_SPEED_NORMAL;
-    fire_rate_cooldown = T_COOLDOWN_FAST;
-    max_bullet_ricochets = 1;
-    max_bullets = 3;
-    behavior = T_BEHAVIOR_OFFENSIVE;
-    break;
-  case T_COLOR_GREEN:
-    movement = T_MOVEMENT_STATIONARY;
-    bullet_speed = B_SPEED_FAST;
-    fire_rate_cooldown = T_COOLDOWN_FAST;
-    max_bullet_ricochets = 2;
-    max_bullets = 2;
-    behavior = T_BEHAVIOR_ACTIVE;
-    break;
-  case T_COLOR_VIOLET:
-    movement = T_MOVEMENT_NORMAL;
-    bullet_speed = B_SPEED_NORMAL;
-    fire_rate_cooldown = T_COOLDOWN_FAST;
-    max_bullet_ricochets = 1;
-    max_bullets = 5;
-    behavior = T_BEHAVIOR_OFFENSIVE;
-    break;
-  case T_COLOR_WHITE:
-    movement = T_MOVEMENT_SLOW;
-    bullet_speed = B_SPEED_NORMAL;
-    fire_rate_cooldown = T_COOLDOWN_FAST;
-    max_bullet_ricochets = 1;
-    max_bullets = 5;
-    behavior = T_BEHAVIOR_OFFENSIVE;
-    break;
-  case T_COLOR_BLACK:
-    movement = T_MOVEMENT_FAST;
-    bullet_speed = B_SPEED_FAST;
-    fire_rate_cooldown = T_COOLDOWN_FAST;
-    max_bullet_ricochets = 0;
-    max_bullets = 3;
-    behavior = T_BEHAVIOR_DYNAMIC;
-    break;
-  default:
-    movement = T_MOVEMENT_NORMAL;
-    bullet_speed = B_SPEED_NORMAL;
-    fire_rate_cooldown = T_COOLDOWN_CONTROLLED;
-    max_bullet_ricochets = 1;
-    max_bullets = 5;
-    behavior = T_BEHAVIOR_CONTROLLED;
-  }
+    : Tank(stage, x, y, color, direction, getTankArchetype(color)) {}
 
+Tank::Tank(Stage *stage, int x, int y, TankColor color, TankDirection direction,
+           const TankArchetype &archetype)
+    : stage(stage), color(color), archetype(archetype) {
   // Create the sprite objects
+  MemoryScope scope(Stage::memory, MEM_TANKS);
   this->body = new Sprite();
   this->turret = new Sprite();
-  this->explosion = new Sprite();
 
   // Update the position of both sprites
   this->setPosition(x, y);
   this->setOffset(8, 8);
 
   // Set the oam attributes for the tank body
-  this->body->id = Sprite::num_sprites++;
-  this->body->palette_alpha = this->body->id;
-  this->body->affine_index = this->body->id;
+  this->body->rank = S_RANK_TANK;
+  this->body->rotates = true;
   this->body->priority = 3;
 
-  // Update Sprite ID Count
   // Set the oam attributes for the tank turret
-  this->turret->id = Sprite::num_sprites++;
-  this->turret->palette_alpha = this->turret->id;
-  this->turret->affine_index = this->turret->id;
+  this->turret->rank = S_RANK_TANK;
+  this->turret->rotates = true;
   this->turret->priority = 1;
   this->turret->tile_offset = { 8, 8 };
 
-  // Initialize the explosion animation
-  this->explosion->id = Sprite::num_sprites++;
-  this->explosion->palette_alpha = this->explosion->id;
-  this->explosion->affine_index = -1;
-  this->explosion->priority = 1;
-  this->explosion->hide = true;
-  this->explosion->num_anim_frames = 6;
-  this->explosion->anim_speed = 3;
-
-  // Set the sprite sheet positions for the tank's sprites
-  this->body->sprite_sheet_pos = {0, 0 + color};
-  this->turret->sprite_sheet_pos = {3, 0 + color};
-  this->explosion->sprite_sheet_pos = {1, 12};
+  // Set the tank's animations from the sprite atlas, one per color
+  this->body->anim = (SpriteAnim)(SPRITE_ANIM_TANK_BODY_BLUE + color);
+  this->turret->anim = (SpriteAnim)(SPRITE_ANIM_TANK_TURRET_BLUE + color);
 
   // Initialize the graphics for the sprites
   this->body->initGfx();
   this->turret->initGfx();
-  this->explosion->initGfx();
-
-  // Display the initial graphics frames on screen
-  this->body->copyGfxFrameToVRAM();
-  this->turret->copyGfxFrameToVRAM();
-  this->explosion->copyGfxFrameToVRAM();
 
   // Create and initialize the bullet sprites for this tank
   createBullets();
+  createMines();
 
   // Face tank in initial direction
   faceDirection(direction);
 }
 
 Tank::~Tank() {
-  // Clean up any remaining bullets
-  for (int i = (int)bullets.size() - 1; i >= 0; i--) {
-    if (bullets[i] != nullptr) {
-      delete bullets[i];
-      bullets[i] = nullptr;
-    }
+  stage->deactivateTank(this);
+  Stage::timers.cancel(&fire_cooldown_timer);
+  Stage::timers.cancel(&tread_anim_timer);
+
+  // Clean up the mine pool
+  for (int i = (int)mines.size() - 1; i >= 0; i--) {
+    delete mines[i];
+    mines[i] = nullptr;
   }
 
+  // Give the bullets back, the pool outlives the stage
+  for (int i = archetype.max_bullets - 1; i >= 0; i--) bullets[i].detach();
+
   // Clean up tank body and turret sprites
   if (body != nullptr) {
     delete body;
@@ -283,7 +253,9 @@ void Tank::setPosition(char axis, int value) {
   // Update sprite positions
   body->pos = { x, y };
   turret->pos = { x, y };
-  explosion->pos = { x, y };
+  if (alive) {
+    stage->tank_grid.move(&grid_hook, x + TANK_SIZE / 2, y + TANK_SIZE / 2);
+  }
 
   addPositionHistory();
 }
@@ -292,7 +264,9 @@ void Tank::setPosition(int x, int y) {
   // Update sprite positions
   body->pos = {x, y};
   turret->pos = {x, y};
-  explosion->pos = {x, y};
+  if (alive) {
+    stage->tank_grid.move(&grid_hook, x + TANK_SIZE / 2, y + TANK_SIZE / 2);
+  }
 
   addPositionHistory();
 }
@@ -308,7 +282,6 @@ int Tank::getPosition(char axis) {
 
 void Tank::setOffset(int x, int y) {
   body->tile_offset = {x, y};
-  explosion->tile_offset = {x, y};
 }
 
 Position &Tank::getPosition() { return body->pos; }
@@ -319,111 +292,50 @@ Position Tank::getOffsetPosition() {
 }
 
 void Tank::interpolateBodyRotation() {
-  // Normalize both angles to [0, 360) range first
-  float target_angle = direction;
-  float current_angle = body->rotation_angle;
-
-  // Compute the shortest rotation direction
-  float angle_diff = target_angle - current_angle;
-
-  // Adjust for crossing over 0/360 boundary
-  if (angle_diff > 180.0f) {
-    angle_diff -= 360.0f;
-  } else if (angle_diff < -180.0f) {
-    angle_diff += 360.0f;
-  }
+  int target_angle = angleFromDegrees(direction);
 
-  // Rotate in the shortest direction with smooth interpolation
-  if (fabs(angle_diff) > 0.1f) { // Small threshold to prevent jittering
-    if (angle_diff > 0) {
-      body->rotation_angle += body_rotation_speed;
-    } else {
-      body->rotation_angle -= body_rotation_speed;
-    }
+  // Compute the shortest rotation direction, across the 0/360 boundary too
+  int angle_diff = angleDelta(body->rotation_angle, target_angle);
+
+  // Rotate in the shortest direction, snapping once within one step
+  if (angle_diff > body_rotation_speed) {
+    body->rotation_angle += body_rotation_speed;
+  } else if (angle_diff < -body_rotation_speed) {
+    body->rotation_angle -= body_rotation_speed;
   } else {
-    body->rotation_angle = target_angle; // Snap to exact angle when very close
+    body->rotation_angle = target_angle;
   }
 
-  // Keep the angle in [0, 360) range
-  body->rotation_angle =
-      fmod(fmod(body->rotation_angle, 360.0f) + 360.0f, 360.0f);
+  body->rotation_angle = wrapAngle(body->rotation_angle);
 }
 
 void Tank::move(TankDirection direction) {
   this->direction = direction; // Save tank direction for linear interpolation
-  if (direction != body->rotation_angle) return;
-
-  bool hasMoved = false; // For checking
-  int baseSpeed = 1;     // For use with slightly slowing down diagonal speed
-
-  // Accumulate fractional movement
-  static float accumulatedX = 0.0f;
-  static float accumulatedY = 0.0f;
-
-  bool isDiagonal = (direction == T_DIR_NE) || (direction == T_DIR_SE) ||
-                    (direction == T_DIR_SW) || (direction == T_DIR_NW);
-
-  // Handle Y movement
-  Position newPosY = {getPosition('x'), getPosition('y')};
-  bool hasPosY =
-      direction == T_DIR_NW || direction == T_DIR_N || direction == T_DIR_NE;
-  bool hasNegY =
-      direction == T_DIR_SW || direction == T_DIR_S || direction == T_DIR_SE;
-  if (hasPosY || hasNegY) {
-    float yMove = baseSpeed * (isDiagonal ? 0.707f : 1.0f);
-    float testY = accumulatedY + yMove;
-    int moveAmount = (int)testY;
-
-    if (moveAmount != 0) {
-      if (hasPosY) {
-        newPosY.y -= moveAmount;
-      } else {
-        newPosY.y += moveAmount;
-      }
-
-      if (validateMove(newPosY)) {
-        setPosition('y', newPosY.y);
-        hasMoved = true;
-        accumulatedY =
-            testY - moveAmount; // Only update accumulator if move was valid
-      }
-    } else {
-      accumulatedY = testY; // Accumulate small movements
-    }
-  }
-
-  // Handle X movement
-  Position newPosX = {getPosition('x'), getPosition('y')};
-  bool hasPosX =
-      direction == T_DIR_NE || direction == T_DIR_E || direction == T_DIR_SE;
-  bool hasNegX =
-      direction == T_DIR_NW || direction == T_DIR_W || direction == T_DIR_SW;
-  if (hasPosX || hasNegX) {
-    float xMove = baseSpeed * (isDiagonal ? 0.707f : 1.0f);
-    float testX = accumulatedX + xMove;
-    int moveAmount = (int)testX;
-
-    if (moveAmount != 0) {
-      if (hasPosX) {
-        newPosX.x += moveAmount;
-      } else {
-        newPosX.x -= moveAmount;
-      }
-
-      if (validateMove(newPosX)) {
-        setPosition('x', newPosX.x);
-        hasMoved = true;
-        accumulatedX =
-            testX - moveAmount; // Only update accumulator if move was valid
-      }
-    } else {
-      accumulatedX = testX; // Accumulate small movements
-    }
-  }
-
-  if (hasMoved) {
+  if (angleFromDegrees(direction) != body->rotation_angle) return;
+
+  int speed = TANK_MOVEMENT_SPEEDS[archetype.movement];
+  if (speed == 0) return;
+
+  // Compass direction as a unit step (screen y grows downwards)
+  int dx = 0;
+  int dy = 0;
+  if (direction == T_DIR_NE || direction == T_DIR_E || direction == T_DIR_SE)
+    dx = 1;
+  if (direction == T_DIR_NW || direction == T_DIR_W || direction == T_DIR_SW)
+    dx = -1;
+  if (direction == T_DIR_NW || direction == T_DIR_N || direction == T_DIR_NE)
+    dy = -1;
+  if (direction == T_DIR_SW || direction == T_DIR_S || direction == T_DIR_SE)
+    dy = 1;
+
+  int moveX, moveY;
+  kinematics.advance(dx, dy, speed, moveX, moveY);
+  if (moveX == 0 && moveY == 0) return;
+
+  // Roll the treads at most once every anim_speed frames while moving
+  if (sweepMove(moveX, moveY) && !tread_anim_timer.armed) {
     body->incrementAnimationFrame(true);
-    body->copyGfxFrameToVRAM();
+    Stage::timers.schedule(&tread_anim_timer, body->anim_speed);
   }
 }
 
@@ -432,9 +344,26 @@ void Tank::rotateTurret(Position pos) {
   Position center = getPosition();
   center.x += TANK_SIZE / 2;
   center.y += TANK_SIZE / 2;
-  float angle = calculateAngle(center.x, center.y, pos.x, pos.y);
-  turret->rotation_angle = fmod(270 - angle, 360.0f);
-  if (turret->rotation_angle < 0) turret->rotation_angle += 360.0f;
+  turret->rotation_angle = turretAngleTowards(center, pos);
+}
+
+bool Tank::aimTurret(Position pos, int speed) {
+  Position center = getPosition();
+  center.x += TANK_SIZE / 2;
+  center.y += TANK_SIZE / 2;
+  int target = turretAngleTowards(center, pos);
+
+  // Turn the shortest way round, snapping once within one step
+  int step = angleFromDegrees(speed);
+  int angle_diff = angleDelta(turret->rotation_angle, target);
+  if (angle_diff >= -step && angle_diff <= step) {
+    turret->rotation_angle = target;
+    return true;
+  }
+
+  turret->rotation_angle =
+      wrapAngle(turret->rotation_angle + (angle_diff > 0 ? step : -step));
+  return false;
 }
 
 void Tank::rotateTurret(touchPosition &touch) {
@@ -442,43 +371,68 @@ void Tank::rotateTurret(touchPosition &touch) {
 }
 
 void Tank::rotateTurret(int angle) {
-  turret->rotation_angle = angle;
+  turret->rotation_angle = wrapAngle(angleFromDegrees(angle));
 }
 
 void Tank::faceDirection(TankDirection direction) {
   // Set the tank's direction
   this->direction = direction;
   // Rotate the turret
-  turret->rotation_angle = direction;
+  turret->rotation_angle = angleFromDegrees(direction);
   // Rotate the tank body
-  body->rotation_angle = direction;
+  body->rotation_angle = angleFromDegrees(direction);
 }
 
 void Tank::createBullets() {
-  // Initialize all bullet pointers
-  for (int i = 0; i < max_bullets; i++) {
-    // Create new Bullet with this tank as owner
-    bullets.push_back(new Bullet(stage, this, bullet_speed, max_bullet_ricochets));
+  // The stage's pool was sized for every tank's bullets at compile time
+  bullets = stage->claimBullets(archetype.max_bullets);
+  for (int i = 0; i < archetype.max_bullets; i++) {
+    bullets[i].attach(stage, this, archetype.bullet_speed,
+                      archetype.max_bullet_ricochets);
   }
 }
 
+bool Tank::canFire() { return !fire_cooldown_timer.armed; }
+
 void Tank::fire() {
+  if (!canFire()) return;
+
   // Fire the next available bullet
-  for (int i = 0; i < max_bullets; i++) {
-    if (bullets[i]->in_flight) continue;
-    bullets[i]->fire();
+  for (int i = 0; i < archetype.max_bullets; i++) {
+    if (bullets[i].in_flight) continue;
+    bullets[i].fire();
+
+    int cooldown = TANK_FIRE_COOLDOWN_FRAMES[archetype.fire_rate_cooldown];
+    if (cooldown > 0) Stage::timers.schedule(&fire_cooldown_timer, cooldown);
+    break;
+  }
+}
+
+void Tank::createMines() {
+  MemoryScope scope(Stage::memory, MEM_MINES);
+  for (int i = 0; i < archetype.max_mines; i++) {
+    mines.push_back(new Mine(stage, this));
+  }
+}
+
+void Tank::layMine() {
+  // Lay the next mine that isn't already down (or still going off)
+  for (int i = 0; i < archetype.max_mines; i++) {
+    if (mines[i]->live || mines[i]->blast_timer.armed) continue;
+    mines[i]->lay({getPosition('x') + TANK_SIZE / 2,
+                   getPosition('y') + TANK_SIZE / 2});
     break;
   }
 }
 
 void Tank::updateBulletPositions() {
-  for (int i = 0; i < max_bullets; i++) {
-    bullets[i]->updatePosition();
+  for (int i = 0; i < archetype.max_bullets; i++) {
+    bullets[i].updatePosition();
   }
 }
 
-void Tank::drawTreadmarks() {
-  for (int i = 0; i < (int)position_history.size(); i++) {
+void Tank::drawTreadmarks(DrawList &list, int stride) {
+  for (int i = (int)position_history.size() - 1; i >= 0; i -= stride) {
     // Treadmark color
     int color = RGB15(24, 21, 18);
     int treadWidth = 3;
@@ -590,17 +544,25 @@ void Tank::drawTreadmarks() {
         rightMarkEnd.y = rightMarkStart.y - 4;
         break;
     };
-    glLine(leftMarkStart.x, leftMarkStart.y, leftMarkEnd.x, leftMarkEnd.y, color);
-    glLine(rightMarkStart.x, rightMarkStart.y, rightMarkEnd.x, rightMarkEnd.y, color);
+    list.line(leftMarkStart.x, leftMarkStart.y, leftMarkEnd.x, leftMarkEnd.y,
+              color);
+    list.line(rightMarkStart.x, rightMarkStart.y, rightMarkEnd.x,
+              rightMarkEnd.y, color);
   }
 }
 
 void Tank::explode() {
-  // Play the explosion animation
+  // The tank goes up in debris and smoke
   alive = false;
+  stage->deactivateTank(this);
   body->hide = true;
   turret->hide = true;
-  explosion->hide = false;
+
+  int centerX = getPosition('x') + TANK_SIZE / 2;
+  int centerY = getPosition('y') + TANK_SIZE / 2;
+  Stage::particles.emit(PARTICLES_TANK_DEBRIS, centerX, centerY, 0);
+  Stage::particles.emit(PARTICLES_TANK_SMOKE, centerX, centerY, 0);
+  Stage::telemetry.event(TELEMETRY_KILL, color, centerX, centerY);
 
   body->updateOAM();
   turret->updateOAM();
@@ -609,9 +571,9 @@ void Tank::explode() {
 void Tank::reset() {
   // Reset the tank to its initial state
   alive = true;
+  stage->activateTank(this);
   body->hide = false;
   turret->hide = false;
-  explosion->hide = true;
 
   setPosition(position_history[0].pos.x, position_history[0].pos.y);
   direction = T_DIR_N;
@@ -620,17 +582,11 @@ void Tank::reset() {
 
   body->updateOAM();
   turret->updateOAM();
-  explosion->updateOAM();
 }
 
 void Tank::updateOAM() {
-  // Handle explosion on death
-  if (body->hide == true) {
-    explosion->copyGfxFrameToVRAM();
-    explosion->incrementAnimationFrame(false, false);
-    explosion->updateOAM();
-    return;
-  }
+  // Dead tanks leave the active list, they're only debris now
+  if (body->hide == true) return;
 
   interpolateBodyRotation();
 
@@ -663,4 +619,39 @@ void Tank::updateOAM() {
 
   // Reset rotational adjustment
   setOffset(8, 8);
-}
\ No newline at end of file
+}
+
+void Tank::captureState(TankState &state) {
+  state = {};
+  state.pos = getPosition();
+  state.sub_x = kinematics.sub_x;
+  state.sub_y = kinematics.sub_y;
+  state.body_rotation = body->rotation_angle;
+  state.turret_rotation = turret->rotation_angle;
+  state.direction = direction;
+  state.alive = alive;
+  state.body_hide = body->hide;
+  state.turret_hide = turret->hide;
+  state.body_anim_frame = body->anim_frame;
+  Stage::timers.captureState(&fire_cooldown_timer, state.fire_cooldown);
+  Stage::timers.captureState(&tread_anim_timer, state.tread_anim);
+}
+
+void Tank::restoreState(const TankState &state) {
+  // Move the sprites directly, restoring shouldn't lay down treadmarks
+  body->pos = state.pos;
+  turret->pos = state.pos;
+  kinematics.sub_x = state.sub_x;
+  kinematics.sub_y = state.sub_y;
+
+  body->rotation_angle = state.body_rotation;
+  turret->rotation_angle = state.turret_rotation;
+  direction = (TankDirection)state.direction;
+  alive = state.alive;
+  body->hide = state.body_hide;
+  turret->hide = state.turret_hide;
+
+  body->setAnimationFrame(state.body_anim_frame);
+  Stage::timers.restoreState(&fire_cooldown_timer, state.fire_cooldown);
+  Stage::timers.restoreState(&tread_anim_timer, state.tread_anim);
+}
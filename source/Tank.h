@@ -1,10 +1,14 @@
 #ifndef TANK_H
 #define TANK_H
 
+#include "Angle.h"
 #include "Bullet.h"
+#include "DrawList.h"
+#include "Kinematics.h"
+#include "Mine.h"
 #include "Sprite.h"
+#include "TankArchetype.h"
 #include "calico/types.h"
-#include "sprite-sheet.h"
 #include <nds.h>
 #include <vector>
 
@@ -15,6 +19,7 @@
 //---------------------------------------------------------------------------------
 
 const int TANK_SIZE = 16;
+const int MAX_STAGE_TANKS = 16; // Upper bound for per-frame scratch arrays
 
 //---------------------------------------------------------------------------------
 //
@@ -22,22 +27,6 @@ const int TANK_SIZE = 16;
 //
 //---------------------------------------------------------------------------------
 
-enum TankColor {
-  // Player Colors
-  T_COLOR_BLUE = 0, // Player 1
-  T_COLOR_RED = 1,  // Player 2
-  // Computer Colors
-  T_COLOR_BROWN = 2,
-  T_COLOR_ASH = 3,
-  T_COLOR_MARINE = 4,
-  T_COLOR_YELLOW = 5,
-  T_COLOR_PINK = 6,
-  T_COLOR_GREEN = 7,
-  T_COLOR_VIOLET = 8,
-  T_COLOR_WHITE = 9,
-  T_COLOR_BLACK = 10,
-};
-
 enum TankDirection {
   T_DIR_N = 0,    // North
   T_DIR_NE = 315, // Northeast
@@ -49,39 +38,41 @@ enum TankDirection {
   T_DIR_NW = 45   // Northwest
 };
 
-enum TankMovement {
-  T_MOVEMENT_NORMAL = 0,
-  T_MOVEMENT_STATIONARY = 1,
-  T_MOVEMENT_SLOW = 2,
-  T_MOVEMENT_FAST = 3
-};
-
-enum TankFireRateCooldown {
-  // Player has no cooldown, self controlled
-  T_COOLDOWN_CONTROLLED = 0,
-  // Computer fire rate cooldowns
-  T_COOLDOWN_SLOW = 1,
-  T_COOLDOWN_FAST = 2
-};
-
-enum TankBehavior {
-  // Player behavior is controlled by them
-  T_BEHAVIOR_CONTROLLED = 0,
-  // Computer behavior
-  T_BEHAVIOR_PASSIVE = 1,
-  T_BEHAVIOR_DEFENSIVE = 2,
-  T_BEHAVIOR_INCAUTIOUS = 3,
-  T_BEHAVIOR_OFFENSIVE = 4,
-  T_BEHAVIOR_ACTIVE = 5,
-  T_BEHAVIOR_DYNAMIC = 6,
-};
-
 //---------------------------------------------------------------------------------
 //
 // TYPE DEFINITIONS
 //
 //---------------------------------------------------------------------------------
 
+/**
+ * @brief Where and how a tank starts on a stage.
+ */
+struct TankSpawn {
+  int x;
+  int y;
+  TankColor color;
+  TankDirection direction;
+};
+
+/**
+ * @brief Plain copy of a tank's simulation state (its bullets are captured
+ *        separately). Treadmarks are cosmetic and not included.
+ */
+struct TankState {
+  Position pos;
+  int sub_x;
+  int sub_y;
+  u16 body_rotation;
+  u16 turret_rotation;
+  s16 direction;
+  u8 alive;
+  u8 body_hide;
+  u8 turret_hide;
+  u8 body_anim_frame;
+  TimerState fire_cooldown;
+  TimerState tread_anim;
+};
+
 class Stage; // Avoids circular dependencies
 class Tank {
 private:
@@ -101,24 +92,39 @@ private:
   bool isWithinBounds(Position &pos);
 
   /**
-   * @brief Checks if a tank at the given position would collide with any other
-   * tank.
+   * @brief Checks if the tank's position collides with any barriers in the
+   * stage.
    * @param pos The position to check.
    */
-  bool noTanksCollided(Position &pos);
+  bool noBarrierCollisions(Position &pos);
 
   /**
-   * @brief Checks if the tank's position collides with any barriers in the
-   * stage.
+   * @brief Collects the other tanks that could block a move, so the sweep
+   *        only tests those instead of every tank on every step.
+   * @param dx The x distance of the move in pixels.
+   * @param dy The y distance of the move in pixels.
+   * @param blockers Filled with up to MAX_STAGE_TANKS tanks.
+   * @return The number of tanks written to blockers.
+   */
+  int gatherBlockingTanks(int dx, int dy, Tank **blockers);
+
+  /**
+   * @brief Checks if the tank fits at a position without hitting the screen
+   *        edge, a barrier or any of the given tanks.
    * @param pos The position to check.
+   * @param blockers The tanks to check against.
+   * @param numBlockers The number of blockers.
    */
-  bool noBarrierCollisions(Position &pos);
+  bool canOccupy(Position &pos, Tank **blockers, int numBlockers);
 
   /**
-   * @brief Validates if a move is allowed based on screen bounds and
-   *        collisions.
+   * @brief Moves the tank up to dx/dy pixels one pixel at a time, sliding
+   *        along whatever it runs into.
+   * @param dx The x distance to move in pixels.
+   * @param dy The y distance to move in pixels.
+   * @return True if the tank moved at all.
    */
-  bool validateMove(Position &pos);
+  bool sweepMove(int dx, int dy);
 
   /**
    * @brief Appends current position and direction to history vector
@@ -136,26 +142,27 @@ public:
   // Tank Component Sprites
   Sprite *body;
   Sprite *turret;
-  Sprite *explosion;
 
   // Tank Attributes
   bool alive = true;       // Is the tank alive
   TankDirection direction = T_DIR_N; // Start facing north
-  TankMovement movement;   // How fast the tank moves
   TankColor color;         // Color of the tank - Default to player
-  TankFireRateCooldown fire_rate_cooldown; // Default to player
-  TankBehavior behavior;                   // Default to player
+  const TankArchetype &archetype; // Movement, bullets and behavior of color
+  Kinematics kinematics;   // Sub-pixel movement carried between frames
+  Timer fire_cooldown_timer; // Armed while the tank can't fire
+  Timer tread_anim_timer;    // Armed while the treads wait for the next frame
+  ListHook<Tank> active_hook = ListHook<Tank>(this);   // Stage::active_tanks
+  ListHook<Tank> behavior_hook = ListHook<Tank>(this); // Stage::behavior_groups
+  GridHook<Tank> grid_hook = GridHook<Tank>(this);     // Stage::tank_grid
 
   // Sprite Attributes
-  int body_rotation_speed = 5;
+  int body_rotation_speed = angleFromDegrees(5); // Binary angle per frame
   int height = TANK_SIZE; // Visual height of the tank in px within the Tile
   int width = TANK_SIZE;  // Visual height of the tank in px within the Tile
 
   // Bullet related attributes
-  BulletSpeed bullet_speed;                  // Speed of the bullets
-  std::vector<Bullet*> bullets;     // Hold the bullet sprites
-  int max_bullets = 5;    // Default to player
-  int max_bullet_ricochets;
+  Bullet *bullets = nullptr;        // max_bullets of the stage's pool
+  std::vector<Mine*> mines;         // Pool of mines the tank can lay
 
   /**
    * Struct constructor
@@ -167,6 +174,15 @@ public:
    */
   Tank(Stage *stage, int x, int y, TankColor color, TankDirection direction);
 
+  /**
+   * Struct constructor, for a tank played with other than its color's
+   * archetype (eg. while tuning them)
+   * @param archetype Movement, bullets and behavior to play with. It must
+   *        outlive the tank.
+   */
+  Tank(Stage *stage, int x, int y, TankColor color, TankDirection direction,
+       const TankArchetype &archetype);
+
   /**
    * Struct deconstructor
    */
@@ -229,6 +245,15 @@ public:
    */
   void rotateTurret(Position pos);
 
+  /**
+   * @brief Turns the tank's turret towards a point on the screen, at most a
+   *        certain number of degrees this frame.
+   * @param pos The position to turn the turret towards.
+   * @param speed The maximum degrees to turn.
+   * @return True once the turret points straight at the position.
+   */
+  bool aimTurret(Position pos, int speed);
+
   /**
    * @brief Rotates the tank's turret to the touch position.
    * @param touch The touch position to rotate the turret towards.
@@ -242,27 +267,45 @@ public:
   void rotateTurret(int angle);
 
   /**
-   * @brief Creates the bullet sprites and stores them in the bullets array.
+   * @brief Takes the tank's bullets from the stage's pool and attaches them.
    */
   void createBullets();
 
+  /**
+   * @brief Whether the fire rate cooldown has run out.
+   */
+  bool canFire();
+
   /**
    * @brief If bullets are available, fires them in the direction pointed.
    */
   void fire();
 
+  /**
+   * @brief Creates the tank's pool of mines.
+   */
+  void createMines();
+
+  /**
+   * @brief If a mine is available, lays it under the tank.
+   */
+  void layMine();
+
   /**
    * @brief Updates the positions for any in-flight bullets.
    */
   void updateBulletPositions();
 
   /**
-   * @brief Draws the treadmarks for the tank on screen with gl2d.
+   * @brief Queues the treadmarks for the tank to be drawn with gl2d.
+   * @param list This frame's draw list
+   * @param stride Draws every nth mark counting back from the newest, 1 for
+   *        all of them
    */
-  void drawTreadmarks();
+  void drawTreadmarks(DrawList &list, int stride);
 
   /**
-   * @brief Marks the tank for explosion so the necessary animations can be played.
+   * @brief Marks the tank as destroyed and throws out its debris and smoke.
    */
   void explode();
 
@@ -275,6 +318,18 @@ public:
    * @brief Updates the OAM for both the tank body and tank turret.
    */
   void updateOAM();
+
+  /**
+   * @brief Copies the tank's simulation state out.
+   * @param state The state to fill in.
+   */
+  void captureState(TankState &state);
+
+  /**
+   * @brief Overwrites the tank's simulation state and refreshes its gfx.
+   * @param state The state to restore.
+   */
+  void restoreState(const TankState &state);
 };
 
 //---------------------------------------------------------------------------------
@@ -289,8 +344,8 @@ public:
  * @param y1 The y-coordinate of the first point.
  * @param x2 The x-coordinate of the second point.
  * @param y2 The y-coordinate of the second point.
- * @return The angle in degrees.
+ * @return The binary angle (see Angle.h), 0 along +x.
  */
-float calculateAngle(int x1, int y1, int x2, int y2);
+int calculateAngle(int x1, int y1, int x2, int y2);
 
 #endif // TANK_H
\ No newline at end of file
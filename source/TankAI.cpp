@@ -0,0 +1,78 @@
+/*---------------------------------------------------------------------------------
+
+TankAI.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "TankAI.h"
+#include "Tank.h"
+
+//---------------------------------------------------------------------------------
+//
+// BEHAVIOR UPDATES
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Updates every tank in a behavior group. The traits are constants, so
+ *        each instantiation compiles down to just the work its behavior does.
+ * @param stage The stage the tanks are on
+ * @param group The alive tanks sharing behavior B
+ * @param player The player's tank
+ */
+template <TankBehavior B>
+static void updateBehaviorGroup(Stage *stage, IntrusiveList<Tank> &group,
+                                Tank *player) {
+  typedef TankBehaviorTraits<B> Traits;
+
+  Position target = player->getPosition();
+  target.x += TANK_SIZE / 2;
+  target.y += TANK_SIZE / 2;
+
+  // Only alive tanks are in the group
+  for (Tank *tank : group) {
+    if (Traits::tracks_player && player->alive) {
+      bool onTarget = tank->aimTurret(target, Traits::turret_turn_speed);
+
+      // The fire rate cooldown timer decides how often this lands, and
+      // there's no point firing straight into a wall
+      if (Traits::fires_on_target && onTarget && tank->canFire()) {
+        Position muzzle = tank->getPosition();
+        muzzle.x += TANK_SIZE / 2;
+        muzzle.y += TANK_SIZE / 2;
+        if (stage->walls.hasLineOfSight(muzzle, target)) tank->fire();
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void updateComputerTanks(Stage *stage) {
+  if (stage->num_tanks == 0) return;
+  Tank *player = stage->tanks->at(0);
+
+  // The player (T_BEHAVIOR_CONTROLLED) is driven by input instead
+  updateBehaviorGroup<T_BEHAVIOR_PASSIVE>(
+      stage, stage->behavior_groups[T_BEHAVIOR_PASSIVE], player);
+  updateBehaviorGroup<T_BEHAVIOR_DEFENSIVE>(
+      stage, stage->behavior_groups[T_BEHAVIOR_DEFENSIVE], player);
+  updateBehaviorGroup<T_BEHAVIOR_INCAUTIOUS>(
+      stage, stage->behavior_groups[T_BEHAVIOR_INCAUTIOUS], player);
+  updateBehaviorGroup<T_BEHAVIOR_OFFENSIVE>(
+      stage, stage->behavior_groups[T_BEHAVIOR_OFFENSIVE], player);
+  updateBehaviorGroup<T_BEHAVIOR_ACTIVE>(
+      stage, stage->behavior_groups[T_BEHAVIOR_ACTIVE], player);
+  updateBehaviorGroup<T_BEHAVIOR_DYNAMIC>(
+      stage, stage->behavior_groups[T_BEHAVIOR_DYNAMIC], player);
+}
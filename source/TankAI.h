@@ -0,0 +1,14 @@
+#ifndef TANK_AI_H
+#define TANK_AI_H
+
+#include "Stage.h"
+
+/**
+ * @brief Runs one frame of AI for every computer tank on the stage. Each
+ *        behavior group is updated by its own compile-time specialized loop,
+ *        so nothing inside the loops branches on a tank's archetype.
+ * @param stage The stage to update the computer tanks of
+ */
+void updateComputerTanks(Stage *stage);
+
+#endif // TANK_AI_H
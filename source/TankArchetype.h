@@ -0,0 +1,225 @@
+#ifndef TANK_ARCHETYPE_H
+#define TANK_ARCHETYPE_H
+
+//---------------------------------------------------------------------------------
+//
+// ENUMS
+//
+//---------------------------------------------------------------------------------
+
+enum TankColor {
+  // Player Colors
+  T_COLOR_BLUE = 0, // Player 1
+  T_COLOR_RED = 1,  // Player 2
+  // Computer Colors
+  T_COLOR_BROWN = 2,
+  T_COLOR_ASH = 3,
+  T_COLOR_MARINE = 4,
+  T_COLOR_YELLOW = 5,
+  T_COLOR_PINK = 6,
+  T_COLOR_GREEN = 7,
+  T_COLOR_VIOLET = 8,
+  T_COLOR_WHITE = 9,
+  T_COLOR_BLACK = 10,
+  T_COLOR_COUNT
+};
+
+enum TankMovement {
+  T_MOVEMENT_NORMAL = 0,
+  T_MOVEMENT_STATIONARY = 1,
+  T_MOVEMENT_SLOW = 2,
+  T_MOVEMENT_FAST = 3
+};
+
+enum TankFireRateCooldown {
+  // Player has no cooldown, self controlled
+  T_COOLDOWN_CONTROLLED = 0,
+  // Computer fire rate cooldowns
+  T_COOLDOWN_SLOW = 1,
+  T_COOLDOWN_FAST = 2
+};
+
+enum TankBehavior {
+  // Player behavior is controlled by them
+  T_BEHAVIOR_CONTROLLED = 0,
+  // Computer behavior
+  T_BEHAVIOR_PASSIVE = 1,
+  T_BEHAVIOR_DEFENSIVE = 2,
+  T_BEHAVIOR_INCAUTIOUS = 3,
+  T_BEHAVIOR_OFFENSIVE = 4,
+  T_BEHAVIOR_ACTIVE = 5,
+  T_BEHAVIOR_DYNAMIC = 6,
+  T_BEHAVIOR_COUNT
+};
+
+enum BulletSpeed { B_SPEED_NORMAL = 2, B_SPEED_FAST = 3 };
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Everything that differs between tank colors. New tank types are
+ *        added as a row in TANK_ARCHETYPES.
+ */
+struct TankArchetype {
+  TankMovement movement;                   // How fast the tank moves
+  BulletSpeed bullet_speed;                // Speed of the bullets
+  TankFireRateCooldown fire_rate_cooldown; // How often it may fire
+  int max_bullet_ricochets;                // Bounces before a bullet pops
+  int max_bullets;                         // Bullets in flight at once
+  TankBehavior behavior;                   // Which AI drives the tank
+  int max_mines;                           // Mines laid at once
+};
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Pixels per frame in 1/256ths, indexed by TankMovement
+ */
+constexpr int TANK_MOVEMENT_SPEEDS[] = {
+    256, // T_MOVEMENT_NORMAL
+    0,   // T_MOVEMENT_STATIONARY
+    160, // T_MOVEMENT_SLOW
+    384, // T_MOVEMENT_FAST
+};
+
+/**
+ * Frames between shots, indexed by TankFireRateCooldown
+ */
+constexpr int TANK_FIRE_COOLDOWN_FRAMES[] = {
+    0,   // T_COOLDOWN_CONTROLLED
+    120, // T_COOLDOWN_SLOW
+    45,  // T_COOLDOWN_FAST
+};
+
+/**
+ * Indexed by TankColor
+ */
+constexpr TankArchetype TANK_ARCHETYPES[] = {
+    // T_COLOR_BLUE
+    {T_MOVEMENT_NORMAL, B_SPEED_NORMAL, T_COOLDOWN_CONTROLLED, 1, 5,
+     T_BEHAVIOR_CONTROLLED, 2},
+    // T_COLOR_RED
+    {T_MOVEMENT_NORMAL, B_SPEED_NORMAL, T_COOLDOWN_CONTROLLED, 1, 5,
+     T_BEHAVIOR_CONTROLLED, 2},
+    // T_COLOR_BROWN
+    {T_MOVEMENT_STATIONARY, B_SPEED_NORMAL, T_COOLDOWN_SLOW, 1, 1,
+     T_BEHAVIOR_PASSIVE, 0},
+    // T_COLOR_ASH
+    {T_MOVEMENT_SLOW, B_SPEED_NORMAL, T_COOLDOWN_SLOW, 1, 1,
+     T_BEHAVIOR_DEFENSIVE, 0},
+    // T_COLOR_MARINE
+    {T_MOVEMENT_SLOW, B_SPEED_FAST, T_COOLDOWN_SLOW, 0, 1,
+     T_BEHAVIOR_DEFENSIVE, 0},
+    // T_COLOR_YELLOW
+    {T_MOVEMENT_NORMAL, B_SPEED_NORMAL, T_COOLDOWN_SLOW, 1, 1,
+     T_BEHAVIOR_INCAUTIOUS, 4},
+    // T_COLOR_PINK
+    {T_MOVEMENT_SLOW, B_SPEED_NORMAL, T_COOLDOWN_FAST, 1, 3,
+     T_BEHAVIOR_OFFENSIVE, 0},
+    // T_COLOR_GREEN
+    {T_MOVEMENT_STATIONARY, B_SPEED_FAST, T_COOLDOWN_FAST, 2, 2,
+     T_BEHAVIOR_ACTIVE, 0},
+    // T_COLOR_VIOLET
+    {T_MOVEMENT_NORMAL, B_SPEED_NORMAL, T_COOLDOWN_FAST, 1, 5,
+     T_BEHAVIOR_OFFENSIVE, 2},
+    // T_COLOR_WHITE
+    {T_MOVEMENT_SLOW, B_SPEED_NORMAL, T_COOLDOWN_FAST, 1, 5,
+     T_BEHAVIOR_OFFENSIVE, 2},
+    // T_COLOR_BLACK
+    {T_MOVEMENT_FAST, B_SPEED_FAST, T_COOLDOWN_FAST, 0, 3,
+     T_BEHAVIOR_DYNAMIC, 2},
+};
+
+static_assert(sizeof(TANK_ARCHETYPES) / sizeof(TANK_ARCHETYPES[0]) ==
+                  T_COLOR_COUNT,
+              "Every TankColor needs a row in TANK_ARCHETYPES");
+
+/**
+ * Most bullets any one tank can have in flight. Sizes the bullet pool of
+ * stages laid out at run time (see StageLayout), so an archetype (or a
+ * tuned one) can't go over it.
+ */
+const int MAX_TANK_BULLETS = 5;
+
+static_assert(
+    [] {
+      for (const TankArchetype &archetype : TANK_ARCHETYPES) {
+        if (archetype.max_bullets > MAX_TANK_BULLETS) return false;
+      }
+      return true;
+    }(),
+    "Every archetype's bullets must fit in MAX_TANK_BULLETS");
+
+//---------------------------------------------------------------------------------
+//
+// COMPILE TIME TRAITS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Per-behavior constants, resolved at compile time by the update path
+ */
+template <TankBehavior B> struct TankBehaviorTraits {
+  // The player aims with the stylus
+  static constexpr bool tracks_player = B != T_BEHAVIOR_CONTROLLED;
+  // The player fires with the L button
+  static constexpr bool fires_on_target = B != T_BEHAVIOR_CONTROLLED;
+  // Degrees per frame the turret turns towards its target
+  static constexpr int turret_turn_speed = B == T_BEHAVIOR_PASSIVE   ? 1
+                                           : B == T_BEHAVIOR_DYNAMIC ? 4
+                                           : B == T_BEHAVIOR_ACTIVE ||
+                                                   B == T_BEHAVIOR_OFFENSIVE
+                                               ? 3
+                                               : 2;
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Looks up the archetype for a tank color
+ */
+constexpr const TankArchetype &getTankArchetype(TankColor color) {
+  return TANK_ARCHETYPES[color];
+}
+
+/**
+ * @brief Sums the bullets a set of tanks can have in flight at once, so a
+ *        stage's bullet pool can be sized at compile time.
+ * @param spawns Anything with a color member (eg. TankSpawn)
+ */
+template <typename Spawn, int N>
+constexpr int maxBulletsFor(const Spawn (&spawns)[N]) {
+  int total = 0;
+  for (int i = 0; i < N; i++) {
+    total += TANK_ARCHETYPES[spawns[i].color].max_bullets;
+  }
+  return total;
+}
+
+/**
+ * @brief Sums the mines a set of tanks can have laid at once, so a stage's
+ *        mine sprites can be budgeted at compile time.
+ * @param spawns Anything with a color member (eg. TankSpawn)
+ */
+template <typename Spawn, int N>
+constexpr int maxMinesFor(const Spawn (&spawns)[N]) {
+  int total = 0;
+  for (int i = 0; i < N; i++) {
+    total += TANK_ARCHETYPES[spawns[i].color].max_mines;
+  }
+  return total;
+}
+
+#endif // TANK_ARCHETYPE_H
@@ -0,0 +1,130 @@
+#ifndef TCM_H
+#define TCM_H
+
+#include "FrameProfiler.h"
+#include <nds.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+/*
+ * Where the collision hot paths live. Each placement is switched on from the
+ * Makefile on its own, e.g.
+ *
+ *   make TCM="RICOCHET TERRAIN_CELLS"
+ *
+ * and off by default, when everything stays in main RAM. The attributes put
+ * code in .itcm and data in .sbss, the sections ds_arm9.ld already places
+ * in ITCM and DTCM (crt0 copies them in at boot). A TCM build prints how
+ * full each is when it links.
+ *
+ * Every placement is timed by a profiler section (TCM_PLACEMENT_SECTIONS),
+ * which the profiler's console marks with a * when the build has it. Keep a
+ * placement only if its section's time drops against a build without it.
+ *
+ * ITCM (32 KB, no wait states, never evicted from the instruction cache):
+ *   RICOCHET          Bullet::findFaceAhead and Bullet::ricochet   bullets
+ *   BULLET_MOVE       Bullet::updatePosition                       bullets
+ *   TANK_BARRIERS     Tank::noBarrierCollisions                    ai
+ *   BULLET_COLLISION  Stage::checkForBulletCollision               collision
+ *
+ * DTCM (16 KB, shared with the stacks):
+ *   TERRAIN_CELLS     Terrain's coarse cell summary, which nearly   bullets
+ *                     every barrier lookup reads before (or instead
+ *                     of) the packed chunks. Sized for the largest
+ *                     arena (4 KB). Only one Terrain can exist with
+ *                     this on.
+ *   BULLET_SWEEPS     The live bullets' swept boxes, the SoA the    collision
+ *                     pair tests read (640 bytes)
+ */
+
+enum TcmPlacement {
+  TCM_PLACE_RICOCHET,
+  TCM_PLACE_BULLET_MOVE,
+  TCM_PLACE_TANK_BARRIERS,
+  TCM_PLACE_BULLET_COLLISION,
+  TCM_PLACE_TERRAIN_CELLS,
+  TCM_PLACE_BULLET_SWEEPS,
+  TCM_PLACEMENT_COUNT
+};
+
+// The section each placement should speed up. Tanks only check barriers
+// while moving, which the AI (and the player's input) does.
+const ProfileSection TCM_PLACEMENT_SECTIONS[TCM_PLACEMENT_COUNT] = {
+    PROFILE_BULLETS, PROFILE_BULLETS, PROFILE_AI,
+    PROFILE_COLLISION, PROFILE_BULLETS, PROFILE_COLLISION,
+};
+
+#ifdef TCM_RICOCHET
+#define RICOCHET_CODE ITCM_CODE
+const u32 TCM_HAS_RICOCHET = BIT(TCM_PLACE_RICOCHET);
+#else
+#define RICOCHET_CODE
+const u32 TCM_HAS_RICOCHET = 0;
+#endif
+
+#ifdef TCM_BULLET_MOVE
+#define BULLET_MOVE_CODE ITCM_CODE
+const u32 TCM_HAS_BULLET_MOVE = BIT(TCM_PLACE_BULLET_MOVE);
+#else
+#define BULLET_MOVE_CODE
+const u32 TCM_HAS_BULLET_MOVE = 0;
+#endif
+
+#ifdef TCM_TANK_BARRIERS
+#define TANK_BARRIERS_CODE ITCM_CODE
+const u32 TCM_HAS_TANK_BARRIERS = BIT(TCM_PLACE_TANK_BARRIERS);
+#else
+#define TANK_BARRIERS_CODE
+const u32 TCM_HAS_TANK_BARRIERS = 0;
+#endif
+
+#ifdef TCM_BULLET_COLLISION
+#define BULLET_COLLISION_CODE ITCM_CODE
+const u32 TCM_HAS_BULLET_COLLISION = BIT(TCM_PLACE_BULLET_COLLISION);
+#else
+#define BULLET_COLLISION_CODE
+const u32 TCM_HAS_BULLET_COLLISION = 0;
+#endif
+
+#ifdef TCM_TERRAIN_CELLS
+const u32 TCM_HAS_TERRAIN_CELLS = BIT(TCM_PLACE_TERRAIN_CELLS);
+#else
+const u32 TCM_HAS_TERRAIN_CELLS = 0;
+#endif
+
+#ifdef TCM_BULLET_SWEEPS
+#define BULLET_SWEEPS_DATA DTCM_BSS
+const u32 TCM_HAS_BULLET_SWEEPS = BIT(TCM_PLACE_BULLET_SWEEPS);
+#else
+#define BULLET_SWEEPS_DATA
+const u32 TCM_HAS_BULLET_SWEEPS = 0;
+#endif
+
+// TcmPlacement bits this build has, also written to the telemetry header
+const u32 TCM_PLACEMENTS = TCM_HAS_RICOCHET | TCM_HAS_BULLET_MOVE |
+                           TCM_HAS_TANK_BARRIERS | TCM_HAS_BULLET_COLLISION |
+                           TCM_HAS_TERRAIN_CELLS | TCM_HAS_BULLET_SWEEPS;
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Whether this build has a placement that section should time
+ */
+inline bool tcmPlacedIn(ProfileSection section) {
+  for (int i = 0; i < TCM_PLACEMENT_COUNT; i++) {
+    if ((TCM_PLACEMENTS & BIT(i)) && TCM_PLACEMENT_SECTIONS[i] == section) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#endif // TCM_H
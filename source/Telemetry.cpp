@@ -0,0 +1,164 @@
+/*---------------------------------------------------------------------------------
+
+Telemetry.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Telemetry.h"
+#include "Stage.h"
+#include "Tcm.h"
+#include <string.h>
+#ifdef ARM9
+#include <fat.h>
+#endif
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+#ifdef ARM9
+static const char *TELEMETRY_PATH = "fat:/tanks-telemetry.bin";
+#else
+static const char *TELEMETRY_PATH = "tanks-telemetry.bin";
+#endif
+
+static_assert(TELEMETRY_SECTIONS == PROFILE_SECTION_COUNT,
+              "Frame records carry every profiler section");
+static_assert(TELEMETRY_RING_SIZE % TELEMETRY_CHUNK == 0,
+              "Chunks must never wrap around the ring");
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool Telemetry::push(const void *data, u32 size) {
+  u32 at = head;
+  if (TELEMETRY_RING_SIZE - (at - tail) < size) return false;
+
+  // Copy in (in two parts if it wraps) before moving the head over it
+  u32 start = at % TELEMETRY_RING_SIZE;
+  u32 first = size < TELEMETRY_RING_SIZE - start ? size
+                                                 : TELEMETRY_RING_SIZE - start;
+  memcpy(ring + start, data, first);
+  memcpy(ring, (const u8 *)data + first, size - first);
+  RING_BARRIER();
+  head = at + size;
+  return true;
+}
+
+void Telemetry::pushRecord(TelemetryRecordType type, const void *record,
+                           u32 size) {
+  if (file == nullptr) return;
+
+  // Say how many went missing before carrying on
+  if (dropped > 0) {
+    u8 bytes[1 + sizeof(TelemetryDropped)] = {TELEMETRY_DROPPED};
+    TelemetryDropped lost = {(u32)Stage::frame_counter, dropped};
+    memcpy(bytes + 1, &lost, sizeof(lost));
+    if (!push(bytes, sizeof(bytes))) {
+      dropped++;
+      return;
+    }
+    dropped = 0;
+  }
+
+  // Type and record go in together or not at all
+  u8 bytes[1 + sizeof(TelemetryFrame)];
+  bytes[0] = type;
+  memcpy(bytes + 1, record, size);
+  if (!push(bytes, 1 + size)) dropped++;
+}
+
+void Telemetry::writeChunk() {
+  u32 at = tail;
+  RING_BARRIER();
+  fwrite(ring + at % TELEMETRY_RING_SIZE, 1, TELEMETRY_CHUNK, file);
+  RING_BARRIER();
+  tail = at + TELEMETRY_CHUNK;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool Telemetry::open() {
+  if (file != nullptr) return true;
+#ifdef ARM9
+  if (!fatInitDefault()) return false;
+#endif
+  file = fopen(TELEMETRY_PATH, "wb");
+  if (file == nullptr) return false;
+  // Chunks are already sector sized, stdio buffering would only copy them
+  setvbuf(file, nullptr, _IONBF, 0);
+
+  TelemetryHeader header = {TELEMETRY_MAGIC, TELEMETRY_VERSION,
+                            TELEMETRY_SECTIONS, PROFILE_TICKS_PER_MS,
+                            TCM_PLACEMENTS};
+  push(&header, sizeof(header));
+  return true;
+}
+
+void Telemetry::close() {
+  if (file == nullptr) return;
+
+  // Full chunks first, then whatever is left (which may wrap)
+  while (head - tail >= TELEMETRY_CHUNK) writeChunk();
+  u32 at = tail, left = head - tail;
+  u32 start = at % TELEMETRY_RING_SIZE;
+  u32 first = left < TELEMETRY_RING_SIZE - start ? left
+                                                 : TELEMETRY_RING_SIZE - start;
+  fwrite(ring + start, 1, first, file);
+  fwrite(ring, 1, left - first, file);
+  tail = at + left;
+
+  fclose(file);
+  file = nullptr;
+}
+
+void Telemetry::recordFrame(Stage *stage) {
+  if (file == nullptr) return;
+
+  TelemetryFrame record;
+  // Already counted, events this frame were stamped with the one before
+  record.frame = Stage::frame_counter - 1;
+  for (int i = 0; i < TELEMETRY_SECTIONS; i++) {
+    record.section_ticks[i] = Stage::profiler.lastTicks((ProfileSection)i);
+  }
+  record.tanks = stage->active_tanks.size();
+  record.bullets = stage->live_bullets.size();
+  record.mines = stage->live_mines.size();
+  record.oam = Stage::renderer.oam_used;
+  record.particles = Stage::particles.liveCount();
+  record.heap_peak = Stage::memory.usage(MEM_HEAP).peak;
+  record.sprite_vram_peak = Stage::memory.usage(MEM_SPRITE_VRAM).peak;
+  record.texture_vram_peak = Stage::memory.usage(MEM_TEXTURE_VRAM).peak;
+  pushRecord(TELEMETRY_FRAME, &record, sizeof(record));
+}
+
+void Telemetry::event(TelemetryEventType type, int subject, int x, int y) {
+  if (file == nullptr) return;
+  TelemetryEvent record = {(u32)Stage::frame_counter, (u8)type, (u8)subject,
+                          (s16)x, (s16)y};
+  pushRecord(TELEMETRY_EVENT, &record, sizeof(record));
+}
+
+void Telemetry::flushIdle() {
+  if (file == nullptr || head - tail < TELEMETRY_CHUNK) return;
+  // A busy frame leaves it in the ring, there's room for a few more
+  if (Stage::profiler.lastTicks(PROFILE_FRAME) >= PROFILE_FRAME_BUDGET / 2) {
+    return;
+  }
+  writeChunk();
+}
@@ -0,0 +1,104 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "TelemetryFormat.h"
+#include "calico/types.h"
+#include <stdio.h>
+#ifndef ARM9
+#include <atomic>
+#endif
+
+class Stage;
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const u32 TELEMETRY_RING_SIZE = 16 * 1024; // A whole number of chunks
+const u32 TELEMETRY_CHUNK = 4 * 1024;      // Written at once, 8 sectors
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+#ifdef ARM9
+// One core, and the writer never interrupts the gameplay code, so all the
+// ring needs is for the compiler to keep its order
+typedef volatile u32 RingIndex;
+#define RING_BARRIER() asm volatile("" ::: "memory")
+#else
+typedef std::atomic<u32> RingIndex;
+#define RING_BARRIER()
+#endif
+
+/**
+ * Streams a binary log (see TelemetryFormat.h) to the SD card, or to a local
+ * file off the DS. Gameplay code appends records to a single producer, single
+ * consumer ring and never waits: if the ring is full the record is dropped
+ * and counted. The ring is written out a whole chunk at a time, so every
+ * write is sector aligned, and only when the frame has time to spare.
+ */
+class Telemetry {
+private:
+  u8 ring[TELEMETRY_RING_SIZE];
+  RingIndex head{0}; // Bytes ever written, only the producer moves it
+  RingIndex tail{0}; // Bytes ever flushed, only the consumer moves it
+  u32 dropped = 0;   // Records lost since the last TELEMETRY_DROPPED
+  FILE *file = nullptr;
+
+  /**
+   * @brief Appends bytes to the ring if they all fit
+   */
+  bool push(const void *data, u32 size);
+
+  /**
+   * @brief Appends a type byte and its record, or counts it as dropped
+   */
+  void pushRecord(TelemetryRecordType type, const void *record, u32 size);
+
+  /**
+   * @brief Writes the oldest chunk out, the ring is a whole number of them
+   *        so it's never split
+   */
+  void writeChunk();
+
+public:
+  /**
+   * @brief Mounts the SD card and starts a new log on it (a local file off
+   *        the DS)
+   * @return False if there's nowhere to write, records are then ignored
+   */
+  bool open();
+
+  /**
+   * @brief Writes out everything left and closes the log
+   */
+  void close();
+
+  bool isOpen() const { return file != nullptr; }
+
+  /**
+   * @brief Records the frame just finished: the profiler's times, what's
+   *        alive and the memory peaks. Call after FrameProfiler::endFrame.
+   */
+  void recordFrame(Stage *stage);
+
+  /**
+   * @brief Records something that happened this frame
+   * @param subject The color of the tank involved
+   */
+  void event(TelemetryEventType type, int subject, int x, int y);
+
+  /**
+   * @brief Writes one chunk out if a whole one is waiting and the last frame
+   *        took under half its budget. Call before waiting for VBlank, the
+   *        write blocks on the card.
+   */
+  void flushIdle();
+};
+
+#endif // TELEMETRY_H
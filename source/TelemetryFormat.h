@@ -0,0 +1,83 @@
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+#include <stdint.h>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// The log is a TelemetryHeader then records back to back, each a type byte
+// and that type's struct, all little endian. Shared with the host decoder
+// in utils/telemetry, so no libnds types in here.
+const uint32_t TELEMETRY_MAGIC = 0x544B4E54; // "TNKT"
+const uint16_t TELEMETRY_VERSION = 3;
+const int TELEMETRY_SECTIONS = 8; // Kept in step with PROFILE_SECTION_COUNT
+
+enum TelemetryRecordType : uint8_t {
+  TELEMETRY_FRAME = 1,
+  TELEMETRY_EVENT = 2,
+  TELEMETRY_DROPPED = 3, // Records lost to a full ring since the last one
+};
+
+enum TelemetryEventType : uint8_t {
+  TELEMETRY_FIRE,          // A tank fired, at the muzzle
+  TELEMETRY_RICOCHET,      // A bullet bounced, where it hit
+  TELEMETRY_KILL,          // A tank was destroyed, at its center
+  TELEMETRY_MINE_LAID,     // A mine was laid
+  TELEMETRY_MINE_DETONATE, // A mine went off, chain reactions included
+  TELEMETRY_QUALITY,       // Quality level changed to subject, x is the
+                           // average frame in microseconds
+  TELEMETRY_EVENT_COUNT
+};
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+struct __attribute__((packed)) TelemetryHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t sections;      // Section times in each frame record
+  uint32_t ticks_per_ms;  // What the section times are counted in
+  uint32_t tcm_placements; // TcmPlacement bits the build has, see Tcm.h
+};
+
+/**
+ * @brief One frame's cost, what was alive and the memory peaks so far
+ */
+struct __attribute__((packed)) TelemetryFrame {
+  uint32_t frame;
+  uint32_t section_ticks[TELEMETRY_SECTIONS]; // The profiler's, last frame
+  uint8_t tanks;     // Alive
+  uint8_t bullets;   // In flight
+  uint8_t mines;     // Laid
+  uint8_t oam;       // Entries used
+  uint16_t particles;
+  uint32_t heap_peak;
+  uint32_t sprite_vram_peak;
+  uint32_t texture_vram_peak;
+};
+
+/**
+ * @brief Something that happened, subject is the tank involved's color
+ *        unless the type says otherwise
+ */
+struct __attribute__((packed)) TelemetryEvent {
+  uint32_t frame;
+  uint8_t type; // TelemetryEventType
+  uint8_t subject;
+  int16_t x;
+  int16_t y;
+};
+
+struct __attribute__((packed)) TelemetryDropped {
+  uint32_t frame;
+  uint32_t records;
+};
+
+#endif // TELEMETRY_FORMAT_H
@@ -0,0 +1,237 @@
+/*---------------------------------------------------------------------------------
+
+Terrain.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Terrain.h"
+#include <nds.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void Terrain::set(int x, int y, int value) {
+  // Only destructible pixels change, and their chunks always have pixels
+  u8 *pixels = chunks[(y / TERRAIN_CHUNK_SIZE) * chunk_cols +
+                      x / TERRAIN_CHUNK_SIZE];
+  int cx = x & (TERRAIN_CHUNK_SIZE - 1), cy = y & (TERRAIN_CHUNK_SIZE - 1);
+  u8 &byte = pixels[cy * TERRAIN_CHUNK_STRIDE + (cx >> 2)];
+  int shift = (cx & 3) * 2;
+  byte = (byte & ~(3 << shift)) | (value << shift);
+}
+
+void Terrain::summarizeCell(int cell) {
+  int cellX = (cell % cols) * GRID_CELL_SIZE;
+  int cellY = (cell / cols) * GRID_CELL_SIZE;
+
+  int first = at(cellX, cellY);
+  for (int y = cellY; y < cellY + GRID_CELL_SIZE; y++) {
+    for (int x = cellX; x < cellX + GRID_CELL_SIZE; x++) {
+      if (at(x, y) != first) {
+        cells[cell] = CELL_MIXED;
+        return;
+      }
+    }
+  }
+  cells[cell] = first;
+}
+
+void Terrain::buildChunks() {
+  int chunkRows = height / TERRAIN_CHUNK_SIZE;
+  chunk_cols = width / TERRAIN_CHUNK_SIZE;
+  chunks.assign(chunk_cols * chunkRows, nullptr);
+  uniform.assign(chunk_cols * chunkRows, BARRIER_EMPTY);
+  if (original_barriers == nullptr) return;
+
+  for (int chunk = 0; chunk < (int)chunks.size(); chunk++) {
+    int left = (chunk % chunk_cols) * TERRAIN_CHUNK_SIZE;
+    int top = (chunk / chunk_cols) * TERRAIN_CHUNK_SIZE;
+
+    // Whole bytes compare four pixels at a time
+    const u8 *row = original_barriers + top * (width / 4) + left / 4;
+    u8 first = row[0];
+    bool same = first == 0x00 || first == 0x55 || first == 0xAA;
+    for (int y = 0; y < TERRAIN_CHUNK_SIZE && same; y++) {
+      for (int i = 0; i < TERRAIN_CHUNK_STRIDE && same; i++) {
+        same = row[y * (width / 4) + i] == first;
+      }
+    }
+    if (same) {
+      uniform[chunk] = first & 3;
+      continue;
+    }
+
+    u8 *pixels = new u8[TERRAIN_CHUNK_BYTES];
+    for (int y = 0; y < TERRAIN_CHUNK_SIZE; y++) {
+      memcpy(pixels + y * TERRAIN_CHUNK_STRIDE, row + y * (width / 4),
+             TERRAIN_CHUNK_STRIDE);
+    }
+    chunks[chunk] = pixels;
+  }
+}
+
+void Terrain::freeChunks() {
+  for (u8 *pixels : chunks) delete[] pixels;
+  chunks.clear();
+}
+
+void Terrain::findFloorTile() {
+  // Tally the map entries of tiles with no barriers under them, the floor
+  // is by far the most common
+  const int MAX_CANDIDATES = 32;
+  u16 entries[MAX_CANDIDATES];
+  int counts[MAX_CANDIDATES];
+  int numCandidates = 0;
+
+  for (int ty = 0; ty < height / 8; ty++) {
+    for (int tx = 0; tx < width / 8; tx++) {
+      bool clear = true;
+      for (int y = ty * 8; y < ty * 8 + 8 && clear; y++) {
+        for (int x = tx * 8; x < tx * 8 + 8 && clear; x++) {
+          clear = originalAt(x, y) == BARRIER_EMPTY;
+        }
+      }
+      if (!clear) continue;
+
+      u16 entry = original_map[ty * (width / 8) + tx];
+      int i = 0;
+      while (i < numCandidates && entries[i] != entry) i++;
+      if (i == numCandidates) {
+        if (numCandidates == MAX_CANDIDATES) continue;
+        entries[numCandidates] = entry;
+        counts[numCandidates++] = 0;
+      }
+      counts[i]++;
+    }
+  }
+
+  for (int i = 0; i < numCandidates; i++) {
+    if (counts[i] > counts[0]) {
+      counts[0] = counts[i];
+      entries[0] = entries[i];
+    }
+  }
+  if (numCandidates > 0) floor_tile = entries[0];
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+PER_THREAD VBlankQueue Terrain::uploads;
+#ifdef TCM_TERRAIN_CELLS
+u8 Terrain::cells[TERRAIN_MAX_CELLS] DTCM_BSS;
+#endif
+
+void Terrain::load(int width, int height, const u8 *barriers,
+                   const u16 *map) {
+  sassert(width % TERRAIN_CHUNK_SIZE == 0 && height % TERRAIN_CHUNK_SIZE == 0,
+          "Arena must be whole chunks");
+  sassert(width >= SCREEN_WIDTH && width <= ARENA_MAX_WIDTH &&
+              height >= SCREEN_HEIGHT && height <= ARENA_MAX_HEIGHT,
+          "Arena size out of range");
+  this->width = width;
+  this->height = height;
+  cols = width / GRID_CELL_SIZE;
+  rows = height / GRID_CELL_SIZE;
+  original_barriers = barriers;
+  original_map = map;
+  destroyed.assign(cols * rows, false);
+#ifndef TCM_TERRAIN_CELLS
+  cells.resize(cols * rows);
+#endif
+
+  freeChunks();
+  buildChunks();
+  for (int cell = 0; cell < cols * rows; cell++) summarizeCell(cell);
+  if (barriers != nullptr && map != nullptr) findFloorTile();
+}
+
+u16 Terrain::mapEntry(int tx, int ty) {
+  if (original_map == nullptr) return 0;
+  // Four tiles to a cell
+  if (destroyed[(ty / 2) * cols + tx / 2]) return floor_tile;
+  return original_map[ty * (width / 8) + tx];
+}
+
+bool Terrain::addListener(TerrainListener callback, void *context) {
+  if (num_listeners == MAX_TERRAIN_LISTENERS) return false;
+  listeners[num_listeners++] = {callback, context};
+  return true;
+}
+
+void Terrain::setCellDestroyed(int cell, bool destroyed) {
+  if (original_barriers == nullptr) return;
+  if (this->destroyed[cell] == destroyed) return;
+  this->destroyed[cell] = destroyed;
+
+  int col = cell % cols;
+  int row = cell / cols;
+  int cellX = col * GRID_CELL_SIZE;
+  int cellY = row * GRID_CELL_SIZE;
+  for (int y = cellY; y < cellY + GRID_CELL_SIZE; y++) {
+    for (int x = cellX; x < cellX + GRID_CELL_SIZE; x++) {
+      if (originalAt(x, y) != BARRIER_DESTRUCTIBLE) continue;
+      set(x, y, destroyed ? BARRIER_EMPTY : BARRIER_DESTRUCTIBLE);
+    }
+  }
+  summarizeCell(cell);
+
+  for (int i = 0; i < num_listeners; i++) {
+    listeners[i].callback(listeners[i].context, col, row);
+  }
+}
+
+void Terrain::destroyInRadius(Position center, int radius) {
+  if (original_barriers == nullptr) return;
+
+  // Any destructible cell whose center is caught by the blast goes
+  int reach = radius + GRID_CELL_SIZE / 2;
+  int row1 = (center.y - reach) / GRID_CELL_SIZE;
+  int row2 = (center.y + reach) / GRID_CELL_SIZE;
+  int col1 = (center.x - reach) / GRID_CELL_SIZE;
+  int col2 = (center.x + reach) / GRID_CELL_SIZE;
+  if (row1 < 0) row1 = 0;
+  if (col1 < 0) col1 = 0;
+  if (row2 >= rows) row2 = rows - 1;
+  if (col2 >= cols) col2 = cols - 1;
+
+  for (int row = row1; row <= row2; row++) {
+    int cellY = row * GRID_CELL_SIZE + GRID_CELL_SIZE / 2;
+    int dy = cellY - center.y;
+    if (dy > reach || dy < -reach) continue;
+    for (int col = col1; col <= col2; col++) {
+      int cellX = col * GRID_CELL_SIZE + GRID_CELL_SIZE / 2;
+      int dx = cellX - center.x;
+      if (dx > reach || dx < -reach) continue;
+      if (dx * dx + dy * dy > reach * reach) continue;
+
+      if (originalAt(cellX, cellY) != BARRIER_DESTRUCTIBLE) continue;
+      setCellDestroyed(row * cols + col, true);
+    }
+  }
+}
+
+int Terrain::stateSize() { return destroyed.size(); }
+
+void Terrain::saveState(u8 *out) {
+  memcpy(out, destroyed.data(), destroyed.size());
+}
+
+void Terrain::loadState(const u8 *in) {
+  for (int cell = 0; cell < cols * rows; cell++) {
+    setCellDestroyed(cell, in[cell] != 0);
+  }
+}
@@ -0,0 +1,223 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include "PerThread.h"
+#include "Position.h"
+#include "SpatialGrid.h"
+#include "Tcm.h"
+#include "VBlankQueue.h"
+#include "calico/types.h"
+#include "nds/arm9/video.h"
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Barrier values, as packed by utils/assetc
+const int BARRIER_EMPTY = 0;
+const int BARRIER_WALL = 1;         // Stops tanks, bullets and mines
+const int BARRIER_HOLE = 2;         // Stops tanks only
+const int BARRIER_DESTRUCTIBLE = 3; // A wall that mine blasts clear
+
+const u8 CELL_MIXED = 0xFF; // The cell holds more than one barrier value
+const int MAX_TERRAIN_LISTENERS = 4;
+
+// Arenas are a whole number of chunks, from one screen up to these
+const int ARENA_MAX_WIDTH = 1024;
+const int ARENA_MAX_HEIGHT = 1024;
+const int TERRAIN_MAX_CELLS =
+    (ARENA_MAX_WIDTH / GRID_CELL_SIZE) * (ARENA_MAX_HEIGHT / GRID_CELL_SIZE);
+
+// Barriers are stored in square chunks of packed pixels, a power of two
+const int TERRAIN_CHUNK_SIZE = 32;
+const int TERRAIN_CHUNK_STRIDE = TERRAIN_CHUNK_SIZE / 4; // Bytes a row
+const int TERRAIN_CHUNK_BYTES = TERRAIN_CHUNK_SIZE * TERRAIN_CHUNK_STRIDE;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Told which 16px cell changed so anything derived from the walls can
+ *        rebuild just that part
+ */
+typedef void (*TerrainListener)(void *context, int col, int row);
+
+/**
+ * The arena's barriers and the BG map drawn over them, kept in step as walls
+ * are destroyed (or put back by a rewind). Listeners (the wall faces, the
+ * camera) hear which cells changed.
+ *
+ * Barriers are packed 2 bits a pixel in TERRAIN_CHUNK_SIZE square chunks,
+ * so memory follows the arena's area. A chunk that is all floor or all
+ * solid wall, which most of a large arena is, stores just that value. Each
+ * 16px cell also keeps a coarse summary, its barrier value if every pixel
+ * shares it or CELL_MIXED, so most lookups are answered without touching
+ * the chunks at all.
+ */
+class Terrain {
+private:
+  int width = SCREEN_WIDTH; // Pixels
+  int height = SCREEN_HEIGHT;
+  int cols = 0; // 16px cells
+  int rows = 0;
+  int chunk_cols = 0;
+  std::vector<u8 *> chunks; // Packed pixels, nullptr if all one value
+  std::vector<u8> uniform;  // That value, for chunks without pixels
+#ifdef TCM_TERRAIN_CELLS
+  static u8 cells[TERRAIN_MAX_CELLS]; // In DTCM, see Tcm.h
+#else
+  std::vector<u8> cells;
+#endif
+  std::vector<u8> destroyed; // By cell
+
+  const u8 *original_barriers = nullptr; // The stage's, packed row by row
+  const u16 *original_map = nullptr; // The stage's BG map before any blasts
+  u16 floor_tile = 0;                // Map entry drawn where walls were
+
+  struct Listener {
+    TerrainListener callback;
+    void *context;
+  };
+  Listener listeners[MAX_TERRAIN_LISTENERS];
+  int num_listeners = 0;
+
+  void set(int x, int y, int value);
+
+  /**
+   * @brief The barrier value at a pixel before any blasts
+   */
+  int originalAt(int x, int y) {
+    int shift = (x & 3) * 2;
+    return (original_barriers[y * (width / 4) + (x >> 2)] >> shift) & 3;
+  }
+
+  /**
+   * @brief Copies the stage's barriers into chunks, leaving out the pixels
+   *        of chunks that are all one value and can't be blasted
+   */
+  void buildChunks();
+
+  void freeChunks();
+
+  /**
+   * @brief Recomputes the coarse summary of one cell
+   */
+  void summarizeCell(int cell);
+
+  /**
+   * @brief Picks the map entry most used by tiles without barriers
+   */
+  void findFloorTile();
+
+public:
+  static PER_THREAD VBlankQueue uploads; // BG map writes waiting for the VBlank
+
+  Terrain() = default;
+  Terrain(const Terrain &) = delete;
+  Terrain &operator=(const Terrain &) = delete;
+  ~Terrain() { freeChunks(); }
+
+  /**
+   * @brief Loads a stage's barriers, with nothing destroyed
+   * @param width The arena's width, a multiple of TERRAIN_CHUNK_SIZE
+   * @param height The arena's height, a multiple of TERRAIN_CHUNK_SIZE
+   * @param barriers The stage's barriers from utils/assetc, 2 bits a pixel
+   *        row by row, 4 pixels a byte (may be nullptr for none)
+   * @param map The stage's BG map, width / 8 by height / 8 entries (may be
+   *        nullptr with no barriers)
+   */
+  void load(int width, int height, const u8 *barriers, const u16 *map);
+
+  int getWidth() { return width; }
+  int getHeight() { return height; }
+  int getCols() { return cols; }
+  int getRows() { return rows; }
+
+  /**
+   * @brief Whether a pixel is inside the arena
+   */
+  bool inBounds(int x, int y) {
+    return x >= 0 && y >= 0 && x < width && y < height;
+  }
+
+  /**
+   * @brief The BG map entry to show for an 8x8 tile, the floor where walls
+   *        were destroyed. 0 if the stage has no map.
+   */
+  u16 mapEntry(int tx, int ty);
+
+  /**
+   * @brief Registers a cache built from the walls to hear about changes
+   * @return False if there is no room for another listener
+   */
+  bool addListener(TerrainListener callback, void *context);
+
+  /**
+   * @brief The barrier value at a pixel
+   */
+  int at(int x, int y) {
+    int chunk = (y / TERRAIN_CHUNK_SIZE) * chunk_cols + x / TERRAIN_CHUNK_SIZE;
+    const u8 *pixels = chunks[chunk];
+    if (pixels == nullptr) return uniform[chunk];
+    int cx = x & (TERRAIN_CHUNK_SIZE - 1), cy = y & (TERRAIN_CHUNK_SIZE - 1);
+    return (pixels[cy * TERRAIN_CHUNK_STRIDE + (cx >> 2)] >> ((cx & 3) * 2)) &
+           3;
+  }
+
+  /**
+   * @brief The barrier value shared by a whole cell, or CELL_MIXED
+   */
+  u8 cellAt(int col, int row) { return cells[row * cols + col]; }
+
+  /**
+   * @brief Whether a pixel stops tanks (walls, holes and destructibles)
+   */
+  bool blocksTanks(int x, int y) {
+    u8 cell = cells[(y / GRID_CELL_SIZE) * cols + x / GRID_CELL_SIZE];
+    if (cell != CELL_MIXED) return cell != BARRIER_EMPTY;
+    return at(x, y) != BARRIER_EMPTY;
+  }
+
+  /**
+   * @brief Whether a pixel stops bullets (holes are flown over)
+   */
+  bool blocksBullets(int x, int y) {
+    u8 cell = cells[(y / GRID_CELL_SIZE) * cols + x / GRID_CELL_SIZE];
+    int value = cell != CELL_MIXED ? cell : at(x, y);
+    return value == BARRIER_WALL || value == BARRIER_DESTRUCTIBLE;
+  }
+
+  /**
+   * @brief Clears (or puts back) a destructible cell's barriers and tells
+   *        the listeners
+   */
+  void setCellDestroyed(int cell, bool destroyed);
+
+  /**
+   * @brief Destroys the destructible cells within a radius of a point
+   */
+  void destroyInRadius(Position center, int radius);
+
+  /**
+   * @brief The number of bytes saveState writes
+   */
+  int stateSize();
+
+  /**
+   * @brief Writes which cells are destroyed
+   */
+  void saveState(u8 *out);
+
+  /**
+   * @brief Destroys or puts back cells to match a saved state
+   */
+  void loadState(const u8 *in);
+};
+
+#endif // TERRAIN_H
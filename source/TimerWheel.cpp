@@ -0,0 +1,134 @@
+/*---------------------------------------------------------------------------------
+
+TimerWheel.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "TimerWheel.h"
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void TimerWheel::insert(Timer *timer) {
+  unsigned int delta = timer->expires - now;
+
+  Timer *slot;
+  if (delta < (1u << SLOT_BITS)) {
+    slot = &slots[0][timer->expires & SLOT_MASK];
+  } else if (delta < (1u << (SLOT_BITS * 2))) {
+    slot = &slots[1][(timer->expires >> SLOT_BITS) & SLOT_MASK];
+  } else {
+    slot = &slots[2][(timer->expires >> (SLOT_BITS * 2)) & SLOT_MASK];
+  }
+
+  // Append to the end of the slot's list
+  timer->next = slot;
+  timer->prev = slot->prev;
+  slot->prev->next = timer;
+  slot->prev = timer;
+}
+
+void TimerWheel::unlink(Timer *timer) {
+  timer->prev->next = timer->next;
+  timer->next->prev = timer->prev;
+  timer->next = nullptr;
+  timer->prev = nullptr;
+}
+
+void TimerWheel::cascade(int level, int slot) {
+  Timer *head = &slots[level][slot];
+  while (head->next != head) {
+    Timer *timer = head->next;
+    unlink(timer);
+    insert(timer);
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+TimerWheel::TimerWheel() {
+  for (int level = 0; level < LEVELS; level++) {
+    for (int slot = 0; slot < SLOTS; slot++) {
+      slots[level][slot].next = &slots[level][slot];
+      slots[level][slot].prev = &slots[level][slot];
+    }
+  }
+}
+
+void TimerWheel::schedule(Timer *timer, int delay) {
+  cancel(timer);
+
+  if (delay < 1) delay = 1;
+  if (delay > MAX_DELAY) delay = MAX_DELAY;
+
+  timer->expires = now + delay;
+  timer->armed = true;
+  num_armed++;
+  insert(timer);
+}
+
+void TimerWheel::cancel(Timer *timer) {
+  if (!timer->armed) return;
+  unlink(timer);
+  timer->armed = false;
+  num_armed--;
+}
+
+void TimerWheel::tick() {
+  now++;
+
+  // Pull the next block of timers down before the level 0 slot is read
+  int slot = now & SLOT_MASK;
+  if (slot == 0) {
+    int slot1 = (now >> SLOT_BITS) & SLOT_MASK;
+    if (slot1 == 0) cascade(2, (now >> (SLOT_BITS * 2)) & SLOT_MASK);
+    cascade(1, slot1);
+  }
+
+  // Fire one at a time, callbacks may schedule or cancel other timers. A
+  // timer rescheduled from its callback lands in a later slot.
+  Timer *head = &slots[0][slot];
+  while (head->next != head) {
+    Timer *timer = head->next;
+    unlink(timer);
+    timer->armed = false;
+    num_armed--;
+    if (timer->callback) timer->callback(timer->context);
+  }
+}
+
+int TimerWheel::remaining(const Timer *timer) {
+  return timer->armed ? (int)(timer->expires - now) : 0;
+}
+
+int TimerWheel::armedCount() { return num_armed; }
+
+void TimerWheel::rewind() {
+  // An armed timer's slot was picked from the old tick
+  if (num_armed == 0) now = 0;
+}
+
+void TimerWheel::captureState(const Timer *timer, TimerState &state) {
+  state.remaining = remaining(timer);
+}
+
+void TimerWheel::restoreState(Timer *timer, const TimerState &state) {
+  if (state.remaining > 0) {
+    schedule(timer, state.remaining);
+  } else {
+    cancel(timer);
+  }
+}
@@ -0,0 +1,128 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+typedef void (*TimerCallback)(void *context);
+
+/**
+ * @brief A single scheduled event. Timers are embedded in the objects that own
+ *        them and linked into the wheel in place, so scheduling never
+ *        allocates.
+ */
+struct Timer {
+  Timer *next = nullptr;
+  Timer *prev = nullptr;
+  unsigned int expires = 0;          // Wheel tick the timer fires on
+  TimerCallback callback = nullptr;  // Called on expiry (may be nullptr)
+  void *context = nullptr;           // Passed to the callback
+  bool armed = false;                // Scheduled and not yet fired
+
+  Timer() {}
+  Timer(TimerCallback callback, void *context)
+      : callback(callback), context(context) {}
+};
+
+/**
+ * @brief Snapshot of a timer, relative to the wheel so it can be restored
+ *        into any wheel. remaining is 0 when the timer is not armed.
+ */
+struct TimerState {
+  int remaining;
+};
+
+/**
+ * Hierarchical timer wheel ticked once per frame. Level 0 has one slot per
+ * frame for the next 64 frames, each level above covers 64 times the range
+ * of the one below, and timers cascade down a level as their slot comes up.
+ * Scheduling, cancelling and firing are all O(1) per timer and frames with
+ * nothing expiring only touch a single empty slot.
+ */
+class TimerWheel {
+private:
+  static const int SLOT_BITS = 6;
+  static const int SLOTS = 1 << SLOT_BITS;
+  static const int SLOT_MASK = SLOTS - 1;
+  static const int LEVELS = 3;
+
+  // Circular list sentinels, one per slot
+  Timer slots[LEVELS][SLOTS];
+  unsigned int now = 0;
+  int num_armed = 0;
+
+  /**
+   * @brief Links an armed timer into the slot for its expiry
+   */
+  void insert(Timer *timer);
+
+  /**
+   * @brief Unlinks a timer from whatever slot it is in
+   */
+  void unlink(Timer *timer);
+
+  /**
+   * @brief Re-inserts every timer in a slot of a higher level, moving them
+   *        down to the level that now matches their remaining time
+   */
+  void cascade(int level, int slot);
+
+public:
+  /**
+   * The longest delay that can be scheduled, longer delays are clamped
+   */
+  static const int MAX_DELAY = (1 << (SLOT_BITS * LEVELS)) - 1;
+
+  TimerWheel();
+
+  /**
+   * @brief Schedules (or reschedules) a timer
+   * @param timer The timer to schedule
+   * @param delay Frames from now until it fires, at least 1
+   */
+  void schedule(Timer *timer, int delay);
+
+  /**
+   * @brief Cancels a timer if it is armed
+   */
+  void cancel(Timer *timer);
+
+  /**
+   * @brief Advances the wheel by one frame, firing everything that expires
+   */
+  void tick();
+
+  /**
+   * @brief Frames until a timer fires, 0 if it isn't armed
+   */
+  int remaining(const Timer *timer);
+
+  /**
+   * @brief Number of timers currently armed
+   */
+  int armedCount();
+
+  /**
+   * @brief Starts the wheel over from tick 0. Timers due on the same tick
+   *        fire in an order that depends on where the wheel stood when they
+   *        were scheduled, so anything replayed from a fresh start (the host
+   *        self-play runner's matches) rewinds first. Does nothing while
+   *        any timer is armed.
+   */
+  void rewind();
+
+  /**
+   * @brief Copies a timer's remaining time out
+   */
+  void captureState(const Timer *timer, TimerState &state);
+
+  /**
+   * @brief Re-arms (or cancels) a timer to match a captured state
+   */
+  void restoreState(Timer *timer, const TimerState &state);
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,50 @@
+/*---------------------------------------------------------------------------------
+
+VBlankQueue.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "VBlankQueue.h"
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void VBlankQueue::queue(u16 *dst, u16 value) {
+  for (int i = 0; i < count; i++) {
+    if (writes[i].dst == dst) {
+      writes[i].value = value;
+      return;
+    }
+  }
+
+  if (count == VBLANK_QUEUE_SIZE) {
+    *(vu16 *)dst = value;
+    return;
+  }
+  writes[count++] = {dst, value};
+}
+
+void VBlankQueue::discard(const u16 *from, const u16 *to) {
+  int kept = 0;
+  for (int i = 0; i < count; i++) {
+    if (writes[i].dst >= from && writes[i].dst < to) continue;
+    writes[kept++] = writes[i];
+  }
+  count = kept;
+}
+
+void VBlankQueue::flush() {
+  for (int i = 0; i < count; i++) *writes[i].dst = writes[i].value;
+  count = 0;
+}
+
+int VBlankQueue::pending() { return count; }
@@ -0,0 +1,63 @@
+#ifndef VBLANK_QUEUE_H
+#define VBLANK_QUEUE_H
+
+#include "calico/types.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int VBLANK_QUEUE_SIZE = 256; // Halfword writes held until the VBlank
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Holds VRAM writes made during the frame so they all land in the VBlank,
+ * where they can't tear the picture being drawn. A second write to the same
+ * address replaces the queued value instead of taking another entry.
+ */
+class VBlankQueue {
+private:
+  struct Write {
+    vu16 *dst;
+    u16 value;
+  };
+
+  Write writes[VBLANK_QUEUE_SIZE];
+  int count = 0;
+
+public:
+  /**
+   * @brief Queues a halfword write. If the queue is full the write is made
+   *        straight away instead of being dropped.
+   * @param dst The VRAM address to write
+   * @param value The value to write
+   */
+  void queue(u16 *dst, u16 value);
+
+  /**
+   * @brief Drops the queued writes to a range of addresses, when it's been
+   *        written over some other way and they would land on the new values
+   * @param from The first address
+   * @param to One past the last
+   */
+  void discard(const u16 *from, const u16 *to);
+
+  /**
+   * @brief Makes every queued write. Call right after waiting for the VBlank.
+   */
+  void flush();
+
+  /**
+   * @brief The number of writes waiting for the next flush
+   */
+  int pending();
+};
+
+#endif // VBLANK_QUEUE_H
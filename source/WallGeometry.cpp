@@ -0,0 +1,379 @@
+/*---------------------------------------------------------------------------------
+
+WallGeometry.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "WallGeometry.h"
+#include "Terrain.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Past 1 / this of the cells dirty, re-extracting everything is cheaper
+static const int FULL_EXTRACT_SHARE = 4;
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Outside the arena stops bullets too, so its edges get faces
+ */
+static bool stopsBullets(Terrain *terrain, int x, int y) {
+  if (!terrain->inBounds(x, y)) return true;
+  return terrain->blocksBullets(x, y);
+}
+
+/**
+ * @brief Which way a face on a line faces at a row (or column) along it
+ * @return 1 or -1 along the line's axis, 0 for no face
+ */
+static int faceNormalAt(Terrain *terrain, bool isVertical, int line,
+                        int along) {
+  bool before = isVertical ? stopsBullets(terrain, line - 1, along)
+                           : stopsBullets(terrain, along, line - 1);
+  bool after = isVertical ? stopsBullets(terrain, line, along)
+                          : stopsBullets(terrain, along, line);
+  if (before && !after) return 1;
+  if (!before && after) return -1;
+  return 0;
+}
+
+/**
+ * @brief Adds the faces on a line within [from, to), the same walk as
+ *        packWalls in utils/assetc so the faces match the built ones. The
+ *        span must start and end where there is no face.
+ */
+static void walkLine(Terrain *terrain, bool isVertical, int line, int from,
+                     int to, std::vector<WallSegment> &faces) {
+  int start = -1;
+  int normal = 0;
+  for (int along = from; along <= to; along++) {
+    int n = along < to ? faceNormalAt(terrain, isVertical, line, along) : 0;
+    if (n == normal) continue;
+    if (normal != 0) {
+      faces.push_back(isVertical
+                          ? WallSegment{(short)line, (short)start, (short)line,
+                                        (short)along, (signed char)normal, 0}
+                          : WallSegment{(short)start, (short)line,
+                                        (short)along, (short)line, 0,
+                                        (signed char)normal});
+    }
+    start = along;
+    normal = n;
+  }
+}
+
+/**
+ * @brief Adds the convex corners within a box of pixel corners
+ */
+static void findCorners(Terrain *terrain, int x1, int y1, int x2, int y2,
+                        std::vector<WallCorner> &corners) {
+  for (int y = y1; y <= y2; y++) {
+    for (int x = x1; x <= x2; x++) {
+      bool nw = stopsBullets(terrain, x - 1, y - 1);
+      bool ne = stopsBullets(terrain, x, y - 1);
+      bool sw = stopsBullets(terrain, x - 1, y);
+      bool se = stopsBullets(terrain, x, y);
+      if (nw + ne + sw + se != 1) continue;
+      corners.push_back({(short)x, (short)y, (signed char)(nw || sw ? 1 : -1),
+                         (signed char)(nw || ne ? 1 : -1)});
+    }
+  }
+}
+
+/**
+ * @brief Builds the index of the first face on each line of a sorted list
+ */
+static void indexLines(const std::vector<WallSegment> &faces, bool isVertical,
+                       int numLines, std::vector<unsigned short> &first) {
+  first.assign(numLines + 1, 0);
+  int face = 0;
+  for (int line = 0; line <= numLines; line++) {
+    first[line] = face;
+    while (face < (int)faces.size() &&
+           (isVertical ? faces[face].x1 : faces[face].y1) == line) {
+      face++;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void WallGeometry::buildIndex() {
+  // Lines run 0..width inclusive, plus one for the end of the last
+  indexLines(vertical, true, terrain->getWidth() + 1, first_vertical);
+  indexLines(horizontal, false, terrain->getHeight() + 1, first_horizontal);
+}
+
+void WallGeometry::extract() {
+  vertical.clear();
+  horizontal.clear();
+  corners.clear();
+
+  int width = terrain->getWidth(), height = terrain->getHeight();
+  for (int x = 0; x <= width; x++) {
+    walkLine(terrain, true, x, 0, height, vertical);
+  }
+  for (int y = 0; y <= height; y++) {
+    walkLine(terrain, false, y, 0, width, horizontal);
+  }
+  findCorners(terrain, 1, 1, width - 1, height - 1, corners);
+
+  buildIndex();
+}
+
+void WallGeometry::refresh() {
+  stale = false;
+  int width = terrain->getWidth(), height = terrain->getHeight();
+  int numCells = terrain->getCols() * terrain->getRows();
+
+  if ((int)dirty_cells.size() * FULL_EXTRACT_SHARE > numCells) {
+    extract();
+  } else {
+    for (int cell : dirty_cells) {
+      // The pixels that changed, and a pixel around them for the edges and
+      // corners they share with their neighbours
+      int col = cell % terrain->getCols(), row = cell / terrain->getCols();
+      int x1 = col * GRID_CELL_SIZE - 1, x2 = (col + 1) * GRID_CELL_SIZE + 1;
+      int y1 = row * GRID_CELL_SIZE - 1, y2 = (row + 1) * GRID_CELL_SIZE + 1;
+      x1 = x1 < 0 ? 0 : x1;
+      y1 = y1 < 0 ? 0 : y1;
+      x2 = x2 > width ? width : x2;
+      y2 = y2 > height ? height : y2;
+
+      refreshFaces(true, x1, x2, y1, y2);
+      refreshFaces(false, y1, y2, x1, x2);
+      refreshCorners(x1 < 1 ? 1 : x1, y1 < 1 ? 1 : y1,
+                     x2 > width - 1 ? width - 1 : x2,
+                     y2 > height - 1 ? height - 1 : y2);
+    }
+  }
+
+  for (int cell : dirty_cells) dirty_marked[cell] = false;
+  dirty_cells.clear();
+}
+
+void WallGeometry::refreshFaces(bool isVertical, int firstLine, int lastLine,
+                                int from, int to) {
+  std::vector<WallSegment> &faces = isVertical ? vertical : horizontal;
+  std::vector<unsigned short> &first =
+      isVertical ? first_vertical : first_horizontal;
+  auto start = [&](const WallSegment &face) {
+    return isVertical ? face.y1 : face.x1;
+  };
+  auto end = [&](const WallSegment &face) {
+    return isVertical ? face.y2 : face.x2;
+  };
+
+  // The lines' faces as they should be now, in order
+  std::vector<WallSegment> redone;
+  std::vector<int> counts;
+  for (int line = firstLine; line <= lastLine; line++) {
+    int lineFirst = first[line], lineEnd = first[line + 1];
+    int size = redone.size();
+
+    // Grow the span over any face overlapping or touching it, so the walk
+    // starts and ends where there's no face
+    int spanFrom = from, spanTo = to;
+    bool grew = true;
+    while (grew) {
+      grew = false;
+      for (int i = lineFirst; i < lineEnd; i++) {
+        if (start(faces[i]) > spanTo || end(faces[i]) < spanFrom) continue;
+        if (start(faces[i]) < spanFrom) spanFrom = start(faces[i]), grew = true;
+        if (end(faces[i]) > spanTo) spanTo = end(faces[i]), grew = true;
+      }
+    }
+
+    for (int i = lineFirst; i < lineEnd; i++) {
+      if (end(faces[i]) < spanFrom) redone.push_back(faces[i]);
+    }
+    walkLine(terrain, isVertical, line, spanFrom, spanTo, redone);
+    for (int i = lineFirst; i < lineEnd; i++) {
+      if (start(faces[i]) > spanTo) redone.push_back(faces[i]);
+    }
+    counts.push_back(redone.size() - size);
+  }
+
+  // Splice them in, then shift the index of every line after by however
+  // many faces that added
+  int spliceFrom = first[firstLine], spliceTo = first[lastLine + 1];
+  faces.erase(faces.begin() + spliceFrom, faces.begin() + spliceTo);
+  faces.insert(faces.begin() + spliceFrom, redone.begin(), redone.end());
+
+  int at = spliceFrom;
+  for (int line = firstLine; line <= lastLine; line++) {
+    first[line] = at;
+    at += counts[line - firstLine];
+  }
+  int shift = (int)redone.size() - (spliceTo - spliceFrom);
+  for (int line = lastLine + 1; line < (int)first.size(); line++) {
+    first[line] += shift;
+  }
+}
+
+void WallGeometry::refreshCorners(int x1, int y1, int x2, int y2) {
+  // Corners aren't indexed, the ones in the box are swapped out in place
+  int kept = 0;
+  for (const WallCorner &corner : corners) {
+    if (corner.x >= x1 && corner.x <= x2 && corner.y >= y1 &&
+        corner.y <= y2) {
+      continue;
+    }
+    corners[kept++] = corner;
+  }
+  corners.resize(kept);
+  findCorners(terrain, x1, y1, x2, y2, corners);
+}
+
+void WallGeometry::onTerrainChanged(void *context, int col, int row) {
+  // Several cells usually go in one blast, they're refreshed together the
+  // next time the geometry is needed
+  WallGeometry *geometry = (WallGeometry *)context;
+  int cell = row * geometry->terrain->getCols() + col;
+  if (geometry->dirty_marked[cell]) return;
+  geometry->dirty_marked[cell] = true;
+  geometry->dirty_cells.push_back(cell);
+  geometry->stale = true;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void WallGeometry::load(Terrain *terrain, const short *table) {
+  this->terrain = terrain;
+  terrain->addListener(&WallGeometry::onTerrainChanged, this);
+  stale = false;
+  dirty_cells.clear();
+  dirty_marked.assign(terrain->getCols() * terrain->getRows(), false);
+
+  // The table lists vertical faces then horizontal, each already sorted
+  vertical.clear();
+  horizontal.clear();
+  corners.clear();
+  if (table == nullptr) {
+    buildIndex();
+    return;
+  }
+
+  int numSegments = table[0];
+  int numCorners = table[1];
+  const short *entry = table + 2;
+  for (int i = 0; i < numSegments; i++, entry += 6) {
+    WallSegment face = {entry[0], entry[1], entry[2], entry[3],
+                        (signed char)entry[4], (signed char)entry[5]};
+    if (face.x1 == face.x2) vertical.push_back(face);
+    else horizontal.push_back(face);
+  }
+  for (int i = 0; i < numCorners; i++, entry += 4) {
+    corners.push_back({entry[0], entry[1], (signed char)entry[2],
+                       (signed char)entry[3]});
+  }
+
+  buildIndex();
+}
+
+const WallSegment *WallGeometry::findFace(int line, bool isVertical, int from,
+                                          int to, int normal) {
+  if (stale) refresh();
+
+  const std::vector<WallSegment> &faces = isVertical ? vertical : horizontal;
+  const std::vector<unsigned short> &first =
+      isVertical ? first_vertical : first_horizontal;
+  if (line < 0 || line + 1 >= (int)first.size()) return nullptr;
+
+  for (int i = first[line]; i < first[line + 1]; i++) {
+    const WallSegment &face = faces[i];
+    if ((isVertical ? face.nx : face.ny) != normal) continue;
+    int start = isVertical ? face.y1 : face.x1;
+    int end = isVertical ? face.y2 : face.x2;
+    if (start < to && from < end) return &face;
+  }
+  return nullptr;
+}
+
+bool WallGeometry::hasLineOfSight(Position from, Position to) {
+  if (stale) refresh();
+
+  // Work in half pixels so the points sit on pixel centers (odd) and the
+  // faces on pixel edges (even), a line can then never end on a face
+  int ax = from.x * 2 + 1, ay = from.y * 2 + 1;
+  int bx = to.x * 2 + 1, by = to.y * 2 + 1;
+  int dx = bx - ax, dy = by - ay;
+
+  if (dx != 0) {
+    int minLine = (ax < bx ? ax : bx) / 2 + 1;
+    int maxLine = (ax > bx ? ax : bx) / 2;
+    int lastLine = terrain->getWidth();
+    for (int line = minLine; line <= maxLine && line <= lastLine; line++) {
+      for (int i = first_vertical[line]; i < first_vertical[line + 1]; i++) {
+        const WallSegment &face = vertical[i];
+        // Where the line crosses x, scaled by dx to stay in integers
+        int crossing = ay * dx + (line * 2 - ax) * dy;
+        int low = face.y1 * 2 * dx, high = face.y2 * 2 * dx;
+        if (dx > 0 ? crossing >= low && crossing <= high
+                   : crossing <= low && crossing >= high) {
+          return false;
+        }
+      }
+    }
+  }
+
+  if (dy != 0) {
+    int minLine = (ay < by ? ay : by) / 2 + 1;
+    int maxLine = (ay > by ? ay : by) / 2;
+    int lastLine = terrain->getHeight();
+    for (int line = minLine; line <= maxLine && line <= lastLine; line++) {
+      for (int i = first_horizontal[line]; i < first_horizontal[line + 1];
+           i++) {
+        const WallSegment &face = horizontal[i];
+        int crossing = ax * dy + (line * 2 - ay) * dx;
+        int low = face.x1 * 2 * dy, high = face.x2 * 2 * dy;
+        if (dy > 0 ? crossing >= low && crossing <= high
+                   : crossing <= low && crossing >= high) {
+          return false;
+        }
+      }
+    }
+  }
+
+  // Grazing a convex corner exactly is too close to call, treat it as cover
+  for (const WallCorner &corner : corners) {
+    int cx = corner.x * 2 - ax, cy = corner.y * 2 - ay;
+    if (cx * dy - cy * dx != 0) continue;
+    int along = cx * dx + cy * dy;
+    if (along > 0 && along < dx * dx + dy * dy) return false;
+  }
+
+  return true;
+}
+
+int WallGeometry::numSegments() {
+  if (stale) refresh();
+  return vertical.size() + horizontal.size();
+}
+
+int WallGeometry::numCorners() {
+  if (stale) refresh();
+  return corners.size();
+}
@@ -0,0 +1,136 @@
+#ifndef WALL_GEOMETRY_H
+#define WALL_GEOMETRY_H
+
+#include "Position.h"
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief A run of pixel edges between a wall and open space. Vertical faces
+ *        have x1 == x2 and cover rows [y1, y2), horizontal faces have
+ *        y1 == y2 and cover columns [x1, x2). The normal (nx, ny) is a unit
+ *        axis vector pointing out of the wall.
+ */
+struct WallSegment {
+  short x1;
+  short y1;
+  short x2;
+  short y2;
+  signed char nx;
+  signed char ny;
+};
+
+/**
+ * @brief A convex wall corner, with a diagonal normal pointing out of it
+ */
+struct WallCorner {
+  short x;
+  short y;
+  signed char nx;
+  signed char ny;
+};
+
+class Terrain;
+
+/**
+ * The faces bullets bounce off, loaded from the table utils/assetc
+ * generates for each stage. Faces are indexed by the line they sit on, so
+ * finding the face a bullet is about to cross only looks at that line.
+ *
+ * Blasts change the walls. The terrain reports each cell that changed, and
+ * the next time the geometry is used only the faces and corners around
+ * those cells are re-extracted from the terrain.
+ */
+class WallGeometry {
+private:
+  Terrain *terrain = nullptr;
+  bool stale = false;             // Cells are waiting in dirty_cells
+  std::vector<int> dirty_cells;   // Changed since the last refresh
+  std::vector<bool> dirty_marked; // By cell, so each is queued once
+
+  std::vector<WallSegment> vertical;   // Sorted by x
+  std::vector<WallSegment> horizontal; // Sorted by y
+  std::vector<WallCorner> corners;
+  // first_vertical[x] is the index of the first face on line x, one past
+  // the end for the last line
+  std::vector<unsigned short> first_vertical;
+  std::vector<unsigned short> first_horizontal;
+
+  /**
+   * @brief Rebuilds the line indexes from the sorted faces
+   */
+  void buildIndex();
+
+  /**
+   * @brief Rebuilds every face and corner from the terrain
+   */
+  void extract();
+
+  /**
+   * @brief Re-extracts the faces and corners around the dirty cells, or
+   *        everything if so many changed that it's cheaper
+   */
+  void refresh();
+
+  /**
+   * @brief Re-extracts the faces on some lines within a span, splicing
+   *        them in and re-indexing only those lines. Faces running out of
+   *        the span are redone whole, so they stay merged.
+   * @param isVertical Vertical faces (lines are x) or horizontal (lines y)
+   * @param firstLine The first line to redo
+   * @param lastLine The last line to redo
+   * @param from The first row (or column) along the lines to redo
+   * @param to One past the last
+   */
+  void refreshFaces(bool isVertical, int firstLine, int lastLine, int from,
+                    int to);
+
+  /**
+   * @brief Re-extracts the corners within a box of pixel corners
+   */
+  void refreshCorners(int x1, int y1, int x2, int y2);
+
+  /**
+   * @brief Queues the cell that changed to be refreshed
+   */
+  static void onTerrainChanged(void *context, int col, int row);
+
+public:
+  /**
+   * @brief Loads a stage's generated faces and corners
+   * @param terrain The terrain the faces were generated from, listened to so
+   *        the faces follow it
+   * @param table The stage's walls from utils/assetc (may be nullptr for
+   *        none): the face count, the corner count, each face as x1, y1, x2,
+   *        y2, nx, ny then each corner as x, y, nx, ny
+   */
+  void load(Terrain *terrain, const short *table);
+
+  /**
+   * @brief Finds the face a box would cross moving one pixel along an axis
+   * @param line The x (vertical) or y (horizontal) line being crossed
+   * @param isVertical Whether the box is moving along x
+   * @param from The first row (or column) of the box's leading edge
+   * @param to One past the last row (or column) of the leading edge
+   * @param normal The normal sign facing the box (opposite to its motion)
+   * @return The face, or nullptr if the way is open
+   */
+  const WallSegment *findFace(int line, bool isVertical, int from, int to,
+                              int normal);
+
+  /**
+   * @brief Whether a straight line between two points misses every face.
+   *        Lines through a convex corner count as blocked.
+   */
+  bool hasLineOfSight(Position from, Position to);
+
+  int numSegments();
+  int numCorners();
+};
+
+#endif // WALL_GEOMETRY_H
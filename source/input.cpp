@@ -12,6 +12,7 @@ Camdyn Rasque
 
 #include "input.h"
 #include "calico/gba/keypad.h"
+#include <stdio.h>
 
 //---------------------------------------------------------------------------------
 //
@@ -31,8 +32,8 @@ void handleButtonInput(Stage *stage) {
       stage->tanks->at(i)->reset();
     }
   } else if (keys_down & KEY_SELECT) {
-    for (int i = 0; i < stage->num_tanks; i++) {
-      stage->tanks->at(i)->explode();
+    for (Tank *tank : stage->active_tanks) {
+      tank->explode();
     }
   }
 
@@ -85,7 +86,9 @@ void handleButtonInput(Stage *stage) {
   }
 
   // Lay Mine
-  // TODO
+  if (keys_down & KEY_R) {
+    playerTank->layMine();
+  }
 }
 
 void handleTouchInput(Stage *stage, Cursor *cursor) {
@@ -105,10 +108,51 @@ void handleTouchInput(Stage *stage, Cursor *cursor) {
   touchRead(&touch);
   // Handle touch input
   if (keys & KEY_TOUCH) {
+    // The screen shows the camera's view, aim at that point in the arena
+    Position target = {touch.px + Stage::camera.x, touch.py + Stage::camera.y};
     // Show the cursor and tail sprites
-    cursor->showSprites({ touch.px, touch.py }, stage->tanks->at(0));
-    stage->tanks->at(0)->rotateTurret(touch);    // Rotate the tank turret
+    cursor->showSprites(target, stage->tanks->at(0));
+    stage->tanks->at(0)->rotateTurret(target);   // Rotate the tank turret
   } else {
     cursor->hideSprites(); // Hide the cursor and tail sprites
   }
 }
+
+bool handleRewindInput(Stage *stage, Rewind *rewind) {
+  // Read the keypad directly, scanKeys is left to the gameplay handlers
+  int keys = keysCurrent();
+
+  if (!(keys & KEY_X)) {
+    if (rewind->isScrubbing()) {
+      rewind->resume();
+      printf("\x1b[0;0H                                ");
+    }
+    return false;
+  }
+
+  // Y jumps a second at a time using the keyframes
+  int frame = rewind->currentFrame();
+  if (keys & KEY_Y) {
+    if (keys & KEY_LEFT) {
+      int target = frame - REWIND_KEYFRAME_INTERVAL;
+      if (target < rewind->oldestFrame()) target = rewind->oldestFrame();
+      rewind->seek(target);
+    } else if (keys & KEY_RIGHT) {
+      int target = frame + REWIND_KEYFRAME_INTERVAL;
+      if (target > rewind->newestFrame()) target = rewind->newestFrame();
+      rewind->seek(target);
+    }
+  } else if (keys & KEY_LEFT) {
+    rewind->stepBack();
+  } else if (keys & KEY_RIGHT) {
+    rewind->stepForward();
+  } else if (!rewind->isScrubbing()) {
+    // Holding X alone pauses on the newest frame
+    rewind->seek(frame);
+  }
+
+  printf("\x1b[0;0Hrewind %4d [%4d-%4d] %3dKB", rewind->currentFrame(),
+         rewind->oldestFrame(), rewind->newestFrame(),
+         rewind->bytesUsed() / 1024);
+  return true;
+}
@@ -3,6 +3,7 @@
 
 #include "Cursor.h"
 #include "Position.h"
+#include "Rewind.h"
 #include "Stage.h"
 #include "Tank.h"
 
@@ -19,4 +20,14 @@ void handleButtonInput(Stage *stage);
  */
 void handleTouchInput(Stage *stage, Cursor *cursor);
 
+/**
+ * @brief Handles the debug rewind controls. Hold X to pause and scrub, with
+ *        LEFT/RIGHT stepping one frame (hold Y to jump a second at a time).
+ *        Releasing X resumes play from the frame shown.
+ * @param stage The stage being recorded.
+ * @param rewind The recorder for the stage.
+ * @return True while scrubbing, the simulation should not be stepped.
+ */
+bool handleRewindInput(Stage *stage, Rewind *rewind);
+
 #endif // INPUT_H
\ No newline at end of file
@@ -12,11 +12,14 @@ Camdyn Rasque
 
 #include "Bullet.h"
 #include "Cursor.h"
+#include "Mine.h"
+#include "Rewind.h"
+#include "Simulation.h"
 #include "Stage.h"
 #include "Tank.h"
 #include "input.h"
 #include "nds/arm9/video.h"
-#include "sprite-sheet.h"
+#include "sprite-atlas.h"
 #include <gl2d.h>
 #include <nds.h>
 #include <unistd.h>
@@ -32,8 +35,11 @@ Camdyn Rasque
  */
 void initSprites() {
   vramSetBankB(VRAM_B_MAIN_SPRITE);
-  oamInit(&oamMain, SpriteMapping_1D_32, false);
-  dmaCopy(sprite_sheetPal, SPRITE_PALETTE, sprite_sheetPalLen);
+  // Frames are shared through Stage::sprite_gfx and mix 8x8, 16x16 and
+  // 32x32, 1D_128 can address all of bank B
+  oamInit(&oamMain, SpriteMapping_1D_128, false);
+  dmaCopy(sprite_atlasPal, SPRITE_PALETTE, sprite_atlasPalLen);
+  Stage::sprite_gfx.loadAtlas();
 }
 
 /**
@@ -47,6 +53,27 @@ void initGL2D() {
   glClearPolyID(63);
   // Set up texture parameters
   glPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE);
+
+  // Sprites that don't fit in the OAM are drawn from the sheet as a texture
+  vramSetBankD(VRAM_D_TEXTURE);
+  vramSetBankE(VRAM_E_TEX_PALETTE);
+  Stage::renderer.loadTextures();
+}
+
+/**
+ * @brief Initializes the bottom screen: the console text over the minimap
+ */
+void initSubScreen() {
+  // Mode 5 for a bitmap on BG3 under the text on BG0
+  videoSetModeSub(MODE_5_2D);
+  vramSetBankC(VRAM_C_SUB_BG);
+  consoleInit(nullptr, 0, BgType_Text4bpp, BgSize_T_256x256, 31, 0, false,
+              true);
+
+  // The minimap's marks
+  vramSetBankI(VRAM_I_SUB_SPRITE);
+  oamInit(&oamSub, SpriteMapping_1D_32, false);
+  Stage::minimap.init();
 }
 
 /**
@@ -69,27 +96,34 @@ void initGraphics() {
 //---------------------------------------------------------------------------------
 
 /**
- * @brief Updates sprite attributes for all tanks.
- * @param stage the stage to update the sprites of
+ * @brief Re-submits every sprite to the OAM without stepping the simulation.
+ *        Used while scrubbing through rewind history.
+ * @param stage the stage to redraw the sprites of
  * @param cursor the player's cursor sprite
  */
-void updateSprites(Stage *stage, Cursor *cursor) {
-  // Update the cursor first and foremost
+void redrawSprites(Stage *stage, Cursor *cursor) {
   cursor->updateOAM();
 
-  // Update all the tank sprite positions
   for (int i = 0; i < stage->num_tanks; i++) {
-    stage->tanks->at(i)->updateOAM();
+    Tank *tank = stage->tanks->at(i);
+    tank->body->updateOAM();
+    tank->turret->updateOAM();
 
-    // Update positions of any active bullet sprites for each tank
-    for (int j = 0; j < stage->tanks->at(i)->max_bullets; j++) {
-      stage->tanks->at(i)->bullets[j]->updatePosition();
-      stage->tanks->at(i)->bullets[j]->updateOAM();
+    for (int j = 0; j < tank->archetype.max_bullets; j++) {
+      tank->bullets[j].updateOAM();
     }
   }
+}
 
-  // Checks to see if any bullets have collided
-  stage->checkForBulletCollision();
+/**
+ * @brief Scrolls the camera to keep the player's tank in view
+ * @param stage the stage the player is on
+ */
+void followPlayer(Stage *stage) {
+  if (stage->num_tanks == 0) return;
+  Tank *player = stage->tanks->at(0);
+  Stage::camera.follow({player->getPosition('x') + TANK_SIZE / 2,
+                        player->getPosition('y') + TANK_SIZE / 2});
 }
 
 /**
@@ -98,9 +132,23 @@ void updateSprites(Stage *stage, Cursor *cursor) {
  */
 void updateTreadBitmapGfx(Stage *stage) {
   // Update all the tank sprite positions
-  glPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE | POLY_ID(2));
+  Stage::draw_list.setLayer(D_LAYER_TREADS);
+  Stage::draw_list.setPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE | POLY_ID(2));
+  int stride = Stage::governor.settings().tread_stride;
   for (int i = 0; i < stage->num_tanks; i++) {
-    stage->tanks->at(i)->drawTreadmarks();
+    stage->tanks->at(i)->drawTreadmarks(Stage::draw_list, stride);
+  }
+}
+
+/**
+ * @brief Renders the mines laid on the stage in OpenGL
+ * @param stage the stage to update the drawings of
+ */
+void updateMineBitmapGfx(Stage *stage) {
+  Stage::draw_list.setLayer(D_LAYER_MINES);
+  Stage::draw_list.setPolyFmt(POLY_ALPHA(31) | POLY_CULL_NONE | POLY_ID(3));
+  for (Mine *mine : stage->live_mines) {
+    mine->draw(Stage::draw_list);
   }
 }
 
@@ -110,12 +158,18 @@ void updateTreadBitmapGfx(Stage *stage) {
  * @param cursor the player's cursor sprite
  */
 void updateGl2dGfx(Stage *stage, Cursor *cursor) {
-  // Begin 2D drawing
-  glBegin2D();
+  Stage::profiler.begin(PROFILE_GL2D);
   // Draw treads FIRST
   updateTreadBitmapGfx(stage);
-  // End 2D drawing
-  glEnd2D();
+  // Mines sit on top of the treads
+  updateMineBitmapGfx(stage);
+  // Sparks, smoke and debris over the mines
+  Stage::particles.draw(Stage::draw_list);
+  // Sprites that didn't get an OAM entry go on top
+  Stage::renderer.drawSpilled(Stage::draw_list);
+  // Sort and send the whole frame to the geometry engine
+  Stage::draw_list.flush();
+  Stage::profiler.end(PROFILE_GL2D);
 }
 
 //---------------------------------------------------------------------------------
@@ -125,34 +179,120 @@ void updateGl2dGfx(Stage *stage, Cursor *cursor) {
 //---------------------------------------------------------------------------------
 
 int main(void) {
-  consoleDemoInit();
+  initSubScreen();
 
   // Initialize the graphics (set video mode, set VRAM banks, etc)
   initGraphics();
+  Stage::profiler.start();
+  // Log frames and events to the SD card if there is one
+  Stage::telemetry.open();
 
   // Create a player cursor
-  Cursor *cursor = new Cursor();
+  Cursor *cursor;
+  {
+    MemoryScope scope(Stage::memory, MEM_UI);
+    cursor = new Cursor();
+  }
 
   // Initialize the first stage
-  Stage *stage = new Stage(4);
+  Stage *stage;
+  {
+    MemoryScope scope(Stage::memory, MEM_STAGE);
+    stage = new Stage(4);
+  }
   stage->initBackground();
 
+#ifdef DEBUG_BUILD
+  // Record every frame so collision bugs can be scrubbed through
+  Rewind *rewind;
+  {
+    MemoryScope scope(Stage::memory, MEM_DEBUG);
+    rewind = new Rewind(stage);
+  }
+#endif
+
   while (pmMainLoop()) {
+#ifdef DEBUG_BUILD
+    if (handleRewindInput(stage, rewind)) {
+      // Show the restored frame without simulating
+      followPlayer(stage);
+      Stage::minimap.update(stage);
+      redrawSprites(stage, cursor);
+      Stage::renderer.assignOam();
+      updateGl2dGfx(stage, cursor);
+      glFlush(0);
+      swiWaitForVBlank();
+      Terrain::uploads.flush();
+      bgUpdate();
+      oamUpdate(&oamMain);
+      Stage::minimap.flush();
+      continue;
+    }
+#endif
+
+    Stage::profiler.beginFrame();
+
     // Handle all inputs
+    Stage::profiler.begin(PROFILE_INPUT);
     handleButtonInput(stage);
     handleTouchInput(stage, cursor);
-    // Update sprites in the Object Attribute Model
-    updateSprites(stage, cursor);
+    Stage::profiler.end(PROFILE_INPUT);
+    // Queue the cursor first and foremost
+    Stage::profiler.begin(PROFILE_SPRITES);
+    cursor->updateOAM();
+    Stage::profiler.end(PROFILE_SPRITES);
+    // Step the tanks, bullets and effects and queue them to be drawn
+    stepSimulation(stage);
+
+    // Keep the player in view before anything is placed on screen
+    followPlayer(stage);
+
+    // Hand out OAM entries now the frame has settled, the rest spill to gl2d
+    Stage::profiler.begin(PROFILE_SPRITES);
+    Stage::renderer.assignOam();
+    Stage::profiler.end(PROFILE_SPRITES);
     // Update the OpenGL 2D graphics
     updateGl2dGfx(stage, cursor);
+    // Move anything that moved on the bottom screen
+    Stage::profiler.begin(PROFILE_MINIMAP);
+    Stage::minimap.update(stage);
+    Stage::profiler.end(PROFILE_MINIMAP);
 
-    // Increment the frame counter
-    Stage::frame_counter++;
+#ifdef DEBUG_BUILD
+    rewind->record();
+#endif
+
+    Stage::profiler.endFrame();
+    Stage::telemetry.recordFrame(stage);
+    // Shed or restore cosmetic work if the frames have got slow or fast
+    if (Stage::governor.update()) {
+      const QualitySettings &quality = Stage::governor.settings();
+      Stage::particles.burst_shift = quality.particle_shift;
+      cursor->setTailStep(quality.tail_step);
+#ifdef DEBUG_BUILD
+      Stage::governor.print(23); // The console's last row
+#endif
+    }
+#ifdef DEBUG_BUILD
+    // Refresh the timings and memory under the rewind line every so often
+    if (Stage::frame_counter % PROFILE_WINDOW == 0) {
+      Stage::profiler.print(1);
+      Stage::memory.print(1 + PROFILE_SECTION_COUNT);
+    }
+#endif
+    // Spare time before VBlank goes on writing the log out
+    Stage::telemetry.flushIdle();
 
     glFlush(0); // Make sure frame has finished rendering
     swiWaitForVBlank();
+    // Patch any BG map tiles and minimap pixels changed or scrolled in
+    // this frame, and the scroll itself, while nothing is drawn
+    Terrain::uploads.flush();
+    bgUpdate();
     oamUpdate(&oamMain);
+    Stage::minimap.flush();
   }
 
+  Stage::telemetry.close();
   return 0;
 }
@@ -1,29 +0,0 @@
-
-//{{BLOCK(sprite_sheet)
-
-//======================================================================
-//
-//	sprite_sheet, 128x416@8, 
-//	Transparent color : FF,00,FF
-//	+ palette 256 entries, not compressed
-//	+ 832 tiles Metatiled by 4x4 not compressed
-//	Total size: 512 + 53248 = 53760
-//
-//	Time-stamp: 2025-02-15, 21:04:20
-//	Exported by Cearn's GBA Image Transmogrifier, v0.9.2
-//	( http://www.coranac.com/projects/#grit )
-//
-//======================================================================
-
-#ifndef GRIT_SPRITE_SHEET_H
-#define GRIT_SPRITE_SHEET_H
-
-#define sprite_sheetTilesLen 53248
-extern const unsigned int sprite_sheetTiles[13312];
-
-#define sprite_sheetPalLen 512
-extern const unsigned short sprite_sheetPal[256];
-
-#endif // GRIT_SPRITE_SHEET_H
-
-//}}BLOCK(sprite_sheet)
@@ -13,6 +13,27 @@ Camdyn Rasque
 #include "stage-1.h"
 #include <vector>
 
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+constexpr TankSpawn STAGE_1_SPAWNS[] = {
+    // Player Tank
+    {STAGE_1_CELL_SIZE, (SCREEN_HEIGHT / 2) - (STAGE_1_CELL_SIZE / 2),
+     T_COLOR_BLUE, T_DIR_E},
+    // Enemy Tank
+    {SCREEN_WIDTH - (STAGE_1_CELL_SIZE * 2),
+     (SCREEN_HEIGHT / 2) - (STAGE_1_CELL_SIZE / 2), T_COLOR_BROWN, T_DIR_W},
+};
+
+constexpr int STAGE_1_MAX_BULLETS = maxBulletsFor(STAGE_1_SPAWNS);
+constexpr int STAGE_1_MAX_MINES = maxMinesFor(STAGE_1_SPAWNS);
+
+// Every tank's bullets, handed out as the tanks are made
+static PER_THREAD Bullet stage_1_bullets[STAGE_1_MAX_BULLETS];
+
 //---------------------------------------------------------------------------------
 //
 // FUNCTIONS
@@ -21,14 +42,14 @@ Camdyn Rasque
 
 std::vector<Tank *> *CREATE_STAGE_1_TANKS(Stage *stage) {
   std::vector<Tank *> *tanks = new std::vector<Tank *>();
+  stage->bullet_pool = stage_1_bullets;
+  stage->bullet_capacity = STAGE_1_MAX_BULLETS;
+  stage->mine_capacity = STAGE_1_MAX_MINES;
 
-  // Create the Player Tank
-  tanks->push_back(new Tank(stage, STAGE_1_CELL_SIZE,
-               (SCREEN_HEIGHT / 2) - (STAGE_1_CELL_SIZE / 2), T_COLOR_BLUE, T_DIR_E));
-
-  // Create the Enemy Tank
-  tanks->push_back(new Tank(stage, SCREEN_WIDTH - (STAGE_1_CELL_SIZE * 2),
-               (SCREEN_HEIGHT / 2) - (STAGE_1_CELL_SIZE / 2), T_COLOR_BROWN, T_DIR_W));
+  for (const TankSpawn &spawn : STAGE_1_SPAWNS) {
+    tanks->push_back(
+        new Tank(stage, spawn.x, spawn.y, spawn.color, spawn.direction));
+  }
 
   return tanks;
-}
\ No newline at end of file
+}
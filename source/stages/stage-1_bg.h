@@ -1,32 +0,0 @@
-
-//{{BLOCK(stage_1_bg)
-
-//======================================================================
-//
-//	stage_1_bg, 256x256@8, 
-//	+ palette 256 entries, not compressed
-//	+ 769 tiles (t|f reduced) not compressed
-//	+ regular map (in SBBs), not compressed, 32x32 
-//	Total size: 512 + 49216 + 2048 = 51776
-//
-//	Time-stamp: 2025-02-20, 21:24:07
-//	Exported by Cearn's GBA Image Transmogrifier, v0.9.2
-//	( http://www.coranac.com/projects/#grit )
-//
-//======================================================================
-
-#ifndef GRIT_STAGE_1_BG_H
-#define GRIT_STAGE_1_BG_H
-
-#define stage_1_bgTilesLen 49216
-extern const unsigned int stage_1_bgTiles[12304];
-
-#define stage_1_bgMapLen 2048
-extern const unsigned short stage_1_bgMap[1024];
-
-#define stage_1_bgPalLen 512
-extern const unsigned short stage_1_bgPal[256];
-
-#endif // GRIT_STAGE_1_BG_H
-
-//}}BLOCK(stage_1_bg)
@@ -15,24 +15,43 @@ Camdyn Rasque
 
 //---------------------------------------------------------------------------------
 //
-// FUNCTIONS
+// CONSTANTS & GLOBALS
 //
 //---------------------------------------------------------------------------------
 
-std::vector<Tank *> *CREATE_STAGE_4_TANKS(Stage *stage) {
-  std::vector<Tank *> *tanks = new std::vector<Tank *>();
+constexpr TankSpawn STAGE_4_SPAWNS[] = {
+    // Player Tank
+    {STAGE_4_CELL_SIZE * 2, STAGE_4_CELL_SIZE * 19 / 2, T_COLOR_BLUE, T_DIR_N},
+    // Enemy Tanks
+    {STAGE_4_CELL_SIZE * 8, STAGE_4_CELL_SIZE, T_COLOR_BROWN, T_DIR_S},
+    {STAGE_4_CELL_SIZE * 27 / 2, STAGE_4_CELL_SIZE, T_COLOR_ASH, T_DIR_S},
+    // {STAGE_4_CELL_SIZE * 8, STAGE_4_CELL_SIZE * 5, T_COLOR_ASH, T_DIR_E},
+    // {STAGE_4_CELL_SIZE * 27 / 2, STAGE_4_CELL_SIZE * 5, T_COLOR_BROWN,
+    //  T_DIR_W},
+};
 
-  // Create the Player Tank
-  tanks->push_back(new Tank(stage, STAGE_4_CELL_SIZE * 2, STAGE_4_CELL_SIZE * 9.5, T_COLOR_BLUE, T_DIR_N));
+constexpr int STAGE_4_MAX_BULLETS = maxBulletsFor(STAGE_4_SPAWNS);
+constexpr int STAGE_4_MAX_MINES = maxMinesFor(STAGE_4_SPAWNS);
 
-  // Create the Enemy Tanks
-  tanks->push_back(new Tank(stage, STAGE_4_CELL_SIZE * 8, STAGE_4_CELL_SIZE, T_COLOR_BROWN, T_DIR_S));
+// Every tank's bullets, handed out as the tanks are made
+static PER_THREAD Bullet stage_4_bullets[STAGE_4_MAX_BULLETS];
 
-  tanks->push_back(new Tank(stage, STAGE_4_CELL_SIZE * 13.5, STAGE_4_CELL_SIZE, T_COLOR_ASH, T_DIR_S));
+//---------------------------------------------------------------------------------
+//
+// FUNCTIONS
+//
+//---------------------------------------------------------------------------------
 
-  // tanks->push_back(new Tank(stage, STAGE_4_CELL_SIZE * 8, STAGE_4_CELL_SIZE * 5, T_COLOR_ASH, T_DIR_E));
+std::vector<Tank *> *CREATE_STAGE_4_TANKS(Stage *stage) {
+  std::vector<Tank *> *tanks = new std::vector<Tank *>();
+  stage->bullet_pool = stage_4_bullets;
+  stage->bullet_capacity = STAGE_4_MAX_BULLETS;
+  stage->mine_capacity = STAGE_4_MAX_MINES;
 
-  // tanks->push_back(new Tank(stage, STAGE_4_CELL_SIZE * 13.5, STAGE_4_CELL_SIZE * 5, T_COLOR_BROWN, T_DIR_W));
+  for (const TankSpawn &spawn : STAGE_4_SPAWNS) {
+    tanks->push_back(
+        new Tank(stage, spawn.x, spawn.y, spawn.color, spawn.direction));
+  }
 
   return tanks;
-}
\ No newline at end of file
+}
@@ -1,32 +0,0 @@
-
-//{{BLOCK(stage_4_bg)
-
-//======================================================================
-//
-//	stage_4_bg, 256x256@8, 
-//	+ palette 256 entries, not compressed
-//	+ 769 tiles (t|f reduced) not compressed
-//	+ regular map (in SBBs), not compressed, 32x32 
-//	Total size: 512 + 49216 + 2048 = 51776
-//
-//	Time-stamp: 2025-02-21, 21:37:44
-//	Exported by Cearn's GBA Image Transmogrifier, v0.9.2
-//	( http://www.coranac.com/projects/#grit )
-//
-//======================================================================
-
-#ifndef GRIT_STAGE_4_BG_H
-#define GRIT_STAGE_4_BG_H
-
-#define stage_4_bgTilesLen 49216
-extern const unsigned int stage_4_bgTiles[12304];
-
-#define stage_4_bgMapLen 2048
-extern const unsigned short stage_4_bgMap[1024];
-
-#define stage_4_bgPalLen 512
-extern const unsigned short stage_4_bgPal[256];
-
-#endif // GRIT_STAGE_4_BG_H
-
-//}}BLOCK(stage_4_bg)
@@ -0,0 +1,267 @@
+/*---------------------------------------------------------------------------------
+
+main.cpp
+Camdyn Rasque
+
+The integer angle benchmark and accuracy check, run on the host:
+
+  anglebench [-n calls] [-r radius]
+
+Checks angleSin and angleCos at every binary angle, and angleAtan2 at
+every vector out to -r (and a spread of vectors up to the largest it
+takes), against the double precision answers. Fails if any error is over
+the bound the tables are documented to, so a change to a table or the
+lerp that loses accuracy shows up here. Then times -n calls of each
+against the float atan2f / sinf / cosf path the game used before, and the
+two together as aiming a shot does. The host has an FPU, the DS doesn't,
+so the float path is far slower there than these timings show.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Angle.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Most the tables may be off by, see angleSin and angleAtan2
+const double SIN_MAX_ERROR = 1.0;    // In 4.12 units, 1 / TRIG_ONE
+const double ATAN2_MAX_ERROR = 0.75; // In binary angle units
+
+const int ATAN2_LARGEST = 32767; // Components have to stay below 32768
+const int ATAN2_SPREAD = 1000000; // Random vectors up to ATAN2_LARGEST
+
+const int BENCH_VECTORS = 4096; // Cycled through, a power of 2
+const int BENCH_SPEED = 3 << 8; // B_SPEED_FAST in SUBPIXEL_ONE units
+
+static const double TWO_PI = 6.283185307179586;
+
+static volatile int sink; // Keeps the timed loops from being optimized out
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief What the command line asked for
+ */
+struct BenchOptions {
+  long calls = 10000000;
+  int radius = 512; // Screen sized and then some
+};
+
+/**
+ * @brief The worst and mean error of one function
+ */
+struct AngleError {
+  double worst = 0;
+  double total = 0;
+  long samples = 0;
+  int worst_y = 0; // Where the worst was, the angle for sine and cosine
+  int worst_x = 0;
+
+  void add(double error, int y, int x) {
+    error = fabs(error);
+    total += error;
+    samples++;
+    if (error > worst) {
+      worst = error;
+      worst_y = y;
+      worst_x = x;
+    }
+  }
+};
+
+/**
+ * @brief xorshift32, the same every run
+ */
+struct BenchRandom {
+  uint32_t state = 2463534242u;
+
+  int next(int range) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (int)(state % (uint32_t)range);
+  }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Nanoseconds since some fixed point
+ */
+static double nowNanos() {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief How far angleAtan2 is from the real angle of (x, y), the short
+ *        way round
+ */
+static double atan2Error(int y, int x) {
+  double exact = atan2((double)y, (double)x) * ANGLE_CIRCLE / TWO_PI;
+  double error = fmod(angleAtan2(y, x) - exact, ANGLE_CIRCLE);
+  if (error > ANGLE_HALF) error -= ANGLE_CIRCLE;
+  if (error < -ANGLE_HALF) error += ANGLE_CIRCLE;
+  return error;
+}
+
+/**
+ * @brief Prints one function's error and whether it's within bound
+ * @return True if it is
+ */
+static bool reportError(const char *name, const AngleError &error,
+                        double bound, const char *units) {
+  bool within = error.worst <= bound;
+  printf("%-12s worst %.3f  mean %.3f %s (bound %.3f) over %ld, worst at "
+         "(%d, %d)%s\n",
+         name, error.worst, error.total / error.samples, units, bound,
+         error.samples, error.worst_y, error.worst_x,
+         within ? "" : "  OVER");
+  return within;
+}
+
+/**
+ * @brief Times a loop over the bench vectors
+ * @return Nanoseconds a call
+ */
+template <typename Call>
+static double timeCalls(long calls, const int (*vectors)[2], Call call) {
+  int sum = 0;
+  double start = nowNanos();
+  for (long i = 0; i < calls; i++) {
+    const int *vector = vectors[i & (BENCH_VECTORS - 1)];
+    sum += call(vector[0], vector[1]);
+  }
+  double elapsed = nowNanos() - start;
+  sink = sum;
+  return elapsed / calls;
+}
+
+/**
+ * @brief Prints the integer and float timings side by side
+ */
+static void reportTiming(const char *name, double integer, double floating) {
+  printf("%-12s int %6.2f ns  float %6.2f ns  %.2fx\n", name, integer,
+         floating, floating / integer);
+}
+
+//---------------------------------------------------------------------------------
+//
+// MAIN
+//
+//---------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      options.calls = atol(argv[++i]);
+    } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+      options.radius = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: anglebench [-n calls] [-r radius]\n");
+      return 1;
+    }
+  }
+  if (options.calls < 1 || options.radius < 1 ||
+      options.radius > ATAN2_LARGEST) {
+    fprintf(stderr, "anglebench: needs a call or more and a radius of 1 to "
+                    "%d\n",
+            ATAN2_LARGEST);
+    return 1;
+  }
+
+  // Sine and cosine, every angle there is
+  AngleError sine, cosine;
+  for (int angle = 0; angle < ANGLE_CIRCLE; angle++) {
+    double radians = angle * TWO_PI / ANGLE_CIRCLE;
+    sine.add(angleSin(angle) - sin(radians) * TRIG_ONE, angle, 0);
+    cosine.add(angleCos(angle) - cos(radians) * TRIG_ONE, angle, 0);
+  }
+
+  // atan2, every vector out to the radius then random ones past it
+  AngleError atan2Near, atan2Far;
+  for (int y = -options.radius; y <= options.radius; y++) {
+    for (int x = -options.radius; x <= options.radius; x++) {
+      if (x != 0 || y != 0) atan2Near.add(atan2Error(y, x), y, x);
+    }
+  }
+  BenchRandom random;
+  for (int i = 0; i < ATAN2_SPREAD; i++) {
+    int y = random.next(2 * ATAN2_LARGEST + 1) - ATAN2_LARGEST;
+    int x = random.next(2 * ATAN2_LARGEST + 1) - ATAN2_LARGEST;
+    if (x != 0 || y != 0) atan2Far.add(atan2Error(y, x), y, x);
+  }
+
+  printf("anglebench: accuracy against double precision\n\n");
+  bool within = reportError("angleSin", sine, SIN_MAX_ERROR, "/4096");
+  within &= reportError("angleCos", cosine, SIN_MAX_ERROR, "/4096");
+  within &= reportError("angleAtan2", atan2Near, ATAN2_MAX_ERROR, "units");
+  within &= reportError("  far", atan2Far, ATAN2_MAX_ERROR, "units");
+
+  // The same vectors for both paths, aim vectors a screen across
+  static int vectors[BENCH_VECTORS][2];
+  for (int i = 0; i < BENCH_VECTORS; i++) {
+    vectors[i][0] = random.next(2 * 256 + 1) - 256;
+    vectors[i][1] = random.next(2 * 256 + 1) - 256;
+  }
+
+  double intAtan2 = timeCalls(options.calls, vectors, [](int y, int x) {
+    return angleAtan2(y, x);
+  });
+  double floatAtan2 = timeCalls(options.calls, vectors, [](int y, int x) {
+    return (int)(atan2f((float)y, (float)x) * (180.0f / (float)M_PI));
+  });
+  double intSinCos = timeCalls(options.calls, vectors, [](int y, int) {
+    return angleSin(y * 64) + angleCos(y * 64);
+  });
+  double floatSinCos = timeCalls(options.calls, vectors, [](int y, int) {
+    float radians = y * ((float)M_PI / 180.0f);
+    return (int)(sinf(radians) * 4096) + (int)(cosf(radians) * 4096);
+  });
+  // Aiming a shot: the turret's angle to the target, then the velocity
+  double intAim = timeCalls(options.calls, vectors, [](int y, int x) {
+    int angle = wrapAngle(angleFromDegrees(270) - angleAtan2(y, x));
+    return -angleSin(angle) * BENCH_SPEED / TRIG_ONE -
+           angleCos(angle) * BENCH_SPEED / TRIG_ONE;
+  });
+  double floatAim = timeCalls(options.calls, vectors, [](int y, int x) {
+    float angle = 270 - atan2f((float)y, (float)x) * (180.0f / (float)M_PI);
+    float radians = angle * ((float)M_PI / 180.0f);
+    return (int)(-sinf(radians) * BENCH_SPEED) -
+           (int)(cosf(radians) * BENCH_SPEED);
+  });
+
+  printf("\nanglebench: %ld calls each\n\n", options.calls);
+  reportTiming("atan2", intAtan2, floatAtan2);
+  reportTiming("sin + cos", intSinCos, floatSinCos);
+  reportTiming("aim a shot", intAim, floatAim);
+
+  if (!within) {
+    fprintf(stderr, "anglebench: FAILED, an error is over its bound\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,605 @@
+/*---------------------------------------------------------------------------------
+
+Atlas.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Atlas.h"
+#include "Png.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// OAM sizes, smallest first, in libnds's SpriteSize order
+static const int SIZES[][2] = {
+    {8, 8},   {16, 8},  {8, 16},  {16, 16}, {32, 8},  {8, 32},
+    {32, 16}, {16, 32}, {32, 32}, {64, 32}, {32, 64}, {64, 64},
+};
+
+static const int LZ_MIN_MATCH = 3;
+static const int LZ_MAX_MATCH = 18;
+static const int LZ_WINDOW = 4096;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief A parsed JSON value, as much of JSON as the manifests use
+ */
+struct Json {
+  enum Type { NONE, NUMBER, STRING, BOOLEAN, ARRAY, OBJECT } type = NONE;
+  double number = 0;
+  std::string text;
+  bool boolean = false;
+  std::vector<Json> items;
+  std::map<std::string, Json> fields;
+
+  const Json &operator[](const std::string &key) const {
+    static const Json none;
+    auto field = fields.find(key);
+    return field == fields.end() ? none : field->second;
+  }
+};
+
+/**
+ * @brief Reads JSON text into a Json, failing on anything it doesn't expect
+ */
+class JsonReader {
+private:
+  const std::string &text;
+  size_t pos = 0;
+
+  void skipSpace() {
+    while (pos < text.size() && isspace((unsigned char)text[pos])) pos++;
+  }
+
+  bool expect(char c) {
+    skipSpace();
+    if (pos >= text.size() || text[pos] != c) return false;
+    pos++;
+    return true;
+  }
+
+  bool readString(std::string &out) {
+    if (!expect('"')) return false;
+    while (pos < text.size() && text[pos] != '"') {
+      if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+      out += text[pos++];
+    }
+    return expect('"');
+  }
+
+public:
+  explicit JsonReader(const std::string &text) : text(text) {}
+
+  bool read(Json &value) {
+    skipSpace();
+    if (pos >= text.size()) return false;
+    char c = text[pos];
+
+    if (c == '{') {
+      pos++;
+      value.type = Json::OBJECT;
+      if (expect('}')) return true;
+      do {
+        std::string key;
+        if (!readString(key) || !expect(':') || !read(value.fields[key])) {
+          return false;
+        }
+      } while (expect(','));
+      return expect('}');
+    }
+    if (c == '[') {
+      pos++;
+      value.type = Json::ARRAY;
+      if (expect(']')) return true;
+      do {
+        value.items.emplace_back();
+        if (!read(value.items.back())) return false;
+      } while (expect(','));
+      return expect(']');
+    }
+    if (c == '"') {
+      value.type = Json::STRING;
+      return readString(value.text);
+    }
+    if (text.compare(pos, 4, "true") == 0 ||
+        text.compare(pos, 5, "false") == 0) {
+      value.type = Json::BOOLEAN;
+      value.boolean = c == 't';
+      pos += value.boolean ? 4 : 5;
+      return true;
+    }
+
+    char *end;
+    value.type = Json::NUMBER;
+    value.number = strtod(text.c_str() + pos, &end);
+    if (end == text.c_str() + pos) return false;
+    pos = end - text.c_str();
+    return true;
+  }
+
+  bool atEnd() {
+    skipSpace();
+    return pos == text.size();
+  }
+};
+
+/**
+ * @brief Where a frame's tiles sit in its cell
+ */
+struct FrameBox {
+  int width;
+  int height;
+  int x;
+  int y;
+};
+
+struct AtlasFrame {
+  int cell;
+  FrameBox box;
+  uint32_t offset; // Bytes into the unpacked tiles
+  bool hflip;
+  bool vflip;
+};
+
+struct AtlasAnim {
+  std::string name;
+  int first;
+  int count;
+};
+
+/**
+ * @brief The sheet's pixels as palette indexes, 0 being transparent
+ */
+struct IndexedSheet {
+  int width = 0;
+  int cell_size = 0;
+  int cells_per_row = 0;
+  std::vector<uint8_t> pixels;
+
+  uint8_t cellPixel(int cell, int x, int y) const {
+    int px = (cell % cells_per_row) * cell_size + x;
+    int py = (cell / cells_per_row) * cell_size + y;
+    return pixels[py * width + px];
+  }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Picks the OAM size and where it sits in the cell
+ * @return False if the cell has nothing in it
+ */
+static bool trimFrame(const IndexedSheet &sheet, int cell, bool rotates,
+                      FrameBox &box) {
+  int cellSize = sheet.cell_size;
+  int x0 = cellSize, y0 = cellSize, x1 = -1, y1 = -1;
+  double reach = 0;
+  double center = cellSize / 2;
+  for (int y = 0; y < cellSize; y++) {
+    for (int x = 0; x < cellSize; x++) {
+      if (!sheet.cellPixel(cell, x, y)) continue;
+      x0 = std::min(x0, x);
+      y0 = std::min(y0, y);
+      x1 = std::max(x1, x);
+      y1 = std::max(y1, y);
+      // How far the pixel's far corner is from the center
+      double dx = std::max(std::fabs(x - center), std::fabs(x + 1 - center));
+      double dy = std::max(std::fabs(y - center), std::fabs(y + 1 - center));
+      reach = std::max(reach, std::hypot(dx, dy));
+    }
+  }
+  if (x1 < 0) return false;
+
+  for (const int *size : SIZES) {
+    int width = size[0], height = size[1];
+    if (width > cellSize || height > cellSize) continue;
+    if (rotates) {
+      if (width / 2.0 < reach || height / 2.0 < reach) continue;
+      box = {width, height, cellSize / 2 - width / 2,
+             cellSize / 2 - height / 2};
+      return true;
+    }
+    if (width < x1 - x0 + 1 || height < y1 - y0 + 1) continue;
+    box = {width, height, std::min(x0, cellSize - width),
+           std::min(y0, cellSize - height)};
+    return true;
+  }
+  // Nothing smaller fits, keep the whole cell
+  box = {cellSize, cellSize, 0, 0};
+  return true;
+}
+
+/**
+ * @brief The frame's pixels laid out in 8x8 tiles, 1D mapped
+ */
+static std::vector<uint8_t> tileFrame(const IndexedSheet &sheet, int cell,
+                                      const FrameBox &box, bool hflip,
+                                      bool vflip) {
+  std::vector<uint8_t> tiles(box.width * box.height);
+  int tilesWide = box.width / 8;
+  for (int y = 0; y < box.height; y++) {
+    for (int x = 0; x < box.width; x++) {
+      int sx = hflip ? box.width - 1 - x : x;
+      int sy = vflip ? box.height - 1 - y : y;
+      int offset = ((y / 8) * tilesWide + x / 8) * 64 + (y % 8) * 8 + x % 8;
+      tiles[offset] = sheet.cellPixel(cell, box.x + sx, box.y + sy);
+    }
+  }
+  return tiles;
+}
+
+/**
+ * @brief Identifies a frame's tiles for sharing, its size and its bytes
+ */
+static std::string tileKey(const FrameBox &box,
+                           const std::vector<uint8_t> &tiles) {
+  return std::to_string(box.width) + "x" + std::to_string(box.height) + ":" +
+         std::string(tiles.begin(), tiles.end());
+}
+
+/**
+ * @brief LZ77 in the BIOS format: a 0x10 header with the unpacked size,
+ *        then groups of 8 blocks behind a flag byte, set bits being back
+ *        references. Padded to whole words.
+ */
+static std::vector<uint8_t> compressLZ77(const std::vector<uint8_t> &data) {
+  int length = data.size();
+  std::vector<uint8_t> out = {0x10, (uint8_t)(length & 0xFF),
+                              (uint8_t)((length >> 8) & 0xFF),
+                              (uint8_t)((length >> 16) & 0xFF)};
+  // Past the end reads as 0, the chains only need the first 3 bytes
+  auto at = [&](int i) -> uint32_t { return i < length ? data[i] : 0; };
+  std::unordered_map<uint32_t, std::vector<int>> chains;
+  int pos = 0;
+
+  while (pos < length) {
+    size_t flagIndex = out.size();
+    uint8_t flags = 0;
+    out.push_back(0);
+
+    for (int block = 0; block < 8 && pos < length; block++) {
+      int bestLen = 0;
+      int bestDisp = 0;
+      uint32_t key = at(pos) << 16 | at(pos + 1) << 8 | at(pos + 2);
+      auto chain = chains.find(key);
+      if (chain != chains.end()) {
+        const std::vector<int> &from = chain->second;
+        for (int c = (int)from.size() - 1; c >= 0; c--) {
+          if (pos - from[c] > LZ_WINDOW) break;
+          int len = 0;
+          while (len < LZ_MAX_MATCH && pos + len < length &&
+                 data[from[c] + len] == data[pos + len]) {
+            len++;
+          }
+          if (len > bestLen) {
+            bestLen = len;
+            bestDisp = pos - from[c];
+            if (len == LZ_MAX_MATCH) break;
+          }
+        }
+      }
+
+      int step = bestLen >= LZ_MIN_MATCH ? bestLen : 1;
+      if (bestLen >= LZ_MIN_MATCH) {
+        flags |= 0x80 >> block;
+        int value = (bestLen - LZ_MIN_MATCH) << 12 | (bestDisp - 1);
+        out.push_back(value >> 8);
+        out.push_back(value & 0xFF);
+      } else {
+        out.push_back(data[pos]);
+      }
+
+      for (int i = 0; i < step; i++, pos++) {
+        chains[at(pos) << 16 | at(pos + 1) << 8 | at(pos + 2)].push_back(pos);
+      }
+    }
+    out[flagIndex] = flags;
+  }
+
+  while (out.size() % 4) out.push_back(0);
+  return out;
+}
+
+static bool writeText(const std::string &path, const std::string &text) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << text;
+  return (bool)file;
+}
+
+/**
+ * @brief Formats a list as C initializer rows, perLine to a row
+ */
+static std::string rows(const std::vector<std::string> &list, int perLine) {
+  std::string out;
+  for (size_t i = 0; i < list.size(); i += perLine) {
+    if (i > 0) out += "\n";
+    out += "   ";
+    for (size_t j = i; j < list.size() && j < i + perLine; j++) {
+      out += " " + list[j] + ",";
+    }
+  }
+  return out;
+}
+
+static std::string hex(uint32_t value, int digits) {
+  char text[16];
+  snprintf(text, sizeof(text), "0x%0*x", digits, value);
+  return text;
+}
+
+static std::string upper(std::string text) {
+  for (char &c : text) c = toupper((unsigned char)c);
+  return text;
+}
+
+//---------------------------------------------------------------------------------
+//
+// FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool packAtlas(const std::string &manifestPath, const std::string &outputBase,
+               std::string &summary, std::string &error) {
+  namespace fs = std::filesystem;
+
+  std::ifstream manifestFile(manifestPath);
+  std::stringstream manifestText;
+  manifestText << manifestFile.rdbuf();
+  std::string text = manifestText.str();
+  Json manifest;
+  JsonReader reader(text);
+  if (!manifestFile || !reader.read(manifest) || !reader.atEnd() ||
+      manifest.type != Json::OBJECT) {
+    error = "couldn't read the manifest";
+    return false;
+  }
+
+  fs::path imagePath =
+      fs::path(manifestPath).parent_path() / manifest["image"].text;
+  std::ifstream imageFile(imagePath, std::ios::binary);
+  std::vector<uint8_t> png((std::istreambuf_iterator<char>(imageFile)),
+                           std::istreambuf_iterator<char>());
+  Image image;
+  if (!imageFile || !decodePng(png, image, error)) {
+    error = imagePath.string() + ": " +
+            (error.empty() ? "couldn't read it" : error);
+    return false;
+  }
+
+  IndexedSheet sheet;
+  sheet.width = image.width;
+  sheet.cell_size = (int)manifest["cellSize"].number;
+  sheet.cells_per_row = image.width / sheet.cell_size;
+  uint32_t transparent = strtoul(manifest["transparent"].text.c_str(), 0, 16);
+
+  // Index the image, transparent is always 0 and the rest go in the order
+  // they're first seen
+  std::vector<uint16_t> palette = {0};
+  std::unordered_map<uint32_t, uint8_t> colorIndex;
+  sheet.pixels.resize(image.pixels.size());
+  for (size_t i = 0; i < image.pixels.size(); i++) {
+    uint32_t pixel = image.pixels[i];
+    uint32_t rgb = pixel & 0xFFFFFF;
+    if ((pixel >> 24) < 128 || rgb == transparent) continue;
+
+    auto known = colorIndex.find(rgb);
+    if (known == colorIndex.end()) {
+      if (palette.size() == 256) {
+        error = "more than 255 colors";
+        return false;
+      }
+      int r = rgb >> 16, g = (rgb >> 8) & 0xFF, b = rgb & 0xFF;
+      known = colorIndex.emplace(rgb, (uint8_t)palette.size()).first;
+      palette.push_back(r >> 3 | (g >> 3) << 5 | (b >> 3) << 10);
+    }
+    sheet.pixels[i] = known->second;
+  }
+
+  // Lay out the frames, sharing tiles between matching frames
+  std::vector<AtlasFrame> frames;
+  std::vector<AtlasAnim> animations;
+  std::unordered_map<std::string, uint32_t> stored; // Tiles to their offset
+  std::vector<uint8_t> tiles;
+  int trimmedLen = 0;
+  int shared = 0;
+
+  for (const Json &anim : manifest["animations"].items) {
+    int count = (int)anim["frames"].number;
+    bool rotates = anim["rotates"].boolean;
+    animations.push_back({anim["name"].text, (int)frames.size(), count});
+    int firstCell = (int)anim["cell"].items[1].number * sheet.cells_per_row +
+                    (int)anim["cell"].items[0].number;
+
+    for (int i = 0; i < count; i++) {
+      AtlasFrame frame = {firstCell + i, {}, 0, false, false};
+      if (!trimFrame(sheet, frame.cell, rotates, frame.box)) {
+        error = "cell " + std::to_string(frame.cell) + " is empty";
+        return false;
+      }
+      trimmedLen += frame.box.width * frame.box.height;
+
+      // Mirror images can only be reused by sprites that don't rotate
+      bool matched = false;
+      for (int flip = 0; flip < (rotates ? 1 : 4) && !matched; flip++) {
+        bool hflip = flip & 1, vflip = flip & 2;
+        auto match = stored.find(tileKey(
+            frame.box, tileFrame(sheet, frame.cell, frame.box, hflip, vflip)));
+        if (match == stored.end()) continue;
+        frame.offset = match->second;
+        frame.hflip = hflip;
+        frame.vflip = vflip;
+        matched = true;
+      }
+
+      if (matched) {
+        shared++;
+      } else {
+        std::vector<uint8_t> own =
+            tileFrame(sheet, frame.cell, frame.box, false, false);
+        frame.offset = tiles.size();
+        stored[tileKey(frame.box, own)] = tiles.size();
+        tiles.insert(tiles.end(), own.begin(), own.end());
+      }
+      frames.push_back(frame);
+    }
+  }
+
+  std::vector<uint8_t> packed = compressLZ77(tiles);
+
+  // Write it all out
+  std::string baseName = fs::path(outputBase).filename().string();
+  std::string symbol = baseName;
+  for (char &c : symbol) {
+    if (c == '-') c = '_';
+  }
+  std::string guard = upper(symbol) + "_H";
+  std::string source = fs::path(manifestPath).filename().string();
+  std::string frameCount = std::to_string(frames.size());
+
+  std::vector<std::string> words;
+  for (size_t i = 0; i < packed.size(); i += 4) {
+    words.push_back(hex(packed[i] | packed[i + 1] << 8 | packed[i + 2] << 16 |
+                            (uint32_t)packed[i + 3] << 24,
+                        8));
+  }
+  std::string numWords = std::to_string(words.size());
+
+  std::string header =
+      "// Generated by utils/assetc from " + source + ", do not edit\n"
+      "#ifndef " + guard + "\n"
+      "#define " + guard + "\n"
+      R"(
+#include <nds.h>
+
+#ifndef SPRITE_ATLAS_TYPES
+#define SPRITE_ATLAS_TYPES
+/**
+ * @brief A frame's tiles and where they go. The tiles are the smallest OAM
+ *        size that holds the art, anchored at (anchor_x, anchor_y) in the
+ *        frame's sheet cell, and are shared with any matching frame.
+ */
+typedef struct SpriteAtlasFrame {
+  u32 tile_offset; // Bytes into the unpacked tiles
+  SpriteSize size; // The OAM size of the tiles
+  u8 width;
+  u8 height;
+  u8 anchor_x; // Top left of the tiles within the cell
+  u8 anchor_y;
+  u8 hflip; // The tiles are stored mirrored, flip them back
+  u8 vflip;
+  u16 cell; // The sheet cell the frame was cut from
+} SpriteAtlasFrame;
+
+/**
+ * @brief An animation's frames, in order
+ */
+typedef struct SpriteAtlasAnim {
+  u16 first_frame; // Index into the frame table
+  u16 num_frames;
+} SpriteAtlasAnim;
+#endif // SPRITE_ATLAS_TYPES
+
+enum SpriteAnim {
+)";
+  for (const AtlasAnim &anim : animations) {
+    header += "  SPRITE_ANIM_" + upper(anim.name) + ",\n";
+  }
+  header += "  SPRITE_ANIM_COUNT\n};\n\n";
+  header += "#define " + symbol + "CellSize " +
+            std::to_string(sheet.cell_size) + "\n";
+  header += "#define " + symbol + "CellsPerRow " +
+            std::to_string(sheet.cells_per_row) + "\n";
+  header += "#define " + symbol + "FrameCount " + frameCount + "\n";
+  header += "#define " + symbol + "TilesLen " +
+            std::to_string(tiles.size()) + " // Unpacked\n";
+  header += "#define " + symbol + "PalLen 512\n\n";
+  header += "extern const unsigned int " + symbol + "Tiles[" + numWords +
+            "]; // LZ77\n";
+  header += "extern const unsigned short " + symbol + "Pal[256];\n";
+  header += "extern const SpriteAtlasFrame " + symbol + "Frames[" +
+            frameCount + "];\n";
+  header += "extern const SpriteAtlasAnim " + symbol +
+            "Anims[SPRITE_ANIM_COUNT];\n\n";
+  header += "#endif // " + guard + "\n";
+
+  std::vector<std::string> colors;
+  for (int i = 0; i < 256; i++) {
+    colors.push_back(hex(i < (int)palette.size() ? palette[i] : 0, 4));
+  }
+
+  std::string data =
+      "// Generated by utils/assetc from " + source + ", do not edit\n";
+  data += "#include \"" + baseName + ".h\"\n\n";
+  data += "const unsigned int " + symbol + "Tiles[" + numWords +
+          "] __attribute__((aligned(4))) = {\n" + rows(words, 8) + "\n};\n\n";
+  data += "const unsigned short " + symbol +
+          "Pal[256] __attribute__((aligned(4))) = {\n" + rows(colors, 8) +
+          "\n};\n\n";
+  data += "const SpriteAtlasFrame " + symbol + "Frames[" + frameCount +
+          "] = {\n";
+  for (const AtlasFrame &frame : frames) {
+    const FrameBox &box = frame.box;
+    data += "    {" + std::to_string(frame.offset) + ", SpriteSize_" +
+            std::to_string(box.width) + "x" + std::to_string(box.height) +
+            ", " + std::to_string(box.width) + ", " +
+            std::to_string(box.height) + ", " + std::to_string(box.x) + ", " +
+            std::to_string(box.y) + ", " + std::to_string(frame.hflip) +
+            ", " + std::to_string(frame.vflip) + ", " +
+            std::to_string(frame.cell) + "},\n";
+  }
+  data += "};\n\n";
+  data += "const SpriteAtlasAnim " + symbol +
+          "Anims[SPRITE_ANIM_COUNT] = {\n";
+  for (const AtlasAnim &anim : animations) {
+    data += "    {" + std::to_string(anim.first) + ", " +
+            std::to_string(anim.count) + "}, // " + anim.name + "\n";
+  }
+  data += "};\n";
+
+  std::string depends = outputBase + ".c " + outputBase + ".h: " +
+                        fs::absolute(imagePath).lexically_normal().string() +
+                        "\n";
+
+  if (!writeText(outputBase + ".h", header) ||
+      !writeText(outputBase + ".c", data) ||
+      !writeText(outputBase + ".atlas.d", depends)) {
+    error = "couldn't write the outputs";
+    return false;
+  }
+
+  int fullLen = frames.size() * sheet.cell_size * sheet.cell_size;
+  summary = baseName + ": " + frameCount + " frames, " +
+            std::to_string(shared) + " shared, " + std::to_string(fullLen) +
+            " -> " + std::to_string(trimmedLen) + " bytes trimmed, " +
+            std::to_string(tiles.size()) + " deduplicated, " +
+            std::to_string(packed.size()) + " packed";
+  return true;
+}
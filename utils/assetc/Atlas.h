@@ -0,0 +1,33 @@
+#ifndef ASSETC_ATLAS_H
+#define ASSETC_ATLAS_H
+
+#include <string>
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Packs the sprite sheet a manifest describes into an atlas for the
+ *        OAM. The manifest names each animation and the sheet cells its
+ *        frames are in. Every frame is trimmed to the smallest OAM size
+ *        that holds its art, frames that are identical (or mirror images)
+ *        share their tiles, and the tiles are LZ77 compressed the way the
+ *        BIOS decompresses them.
+ *
+ *        Frames of rotating animations are trimmed around the cell's
+ *        center, with room for the art to turn, since affine sprites rotate
+ *        about their middle. They aren't matched against mirror images,
+ *        affine sprites can't flip.
+ * @param manifestPath The manifest, its image is found next to it
+ * @param outputBase Writes <base>.c with the data, <base>.h with the frame
+ *        table and <base>.atlas.d so make rebuilds when the image changes
+ * @param summary What it made of the sheet, for the build log
+ * @param error Why it failed, if it did
+ */
+bool packAtlas(const std::string &manifestPath, const std::string &outputBase,
+               std::string &summary, std::string &error);
+
+#endif // ASSETC_ATLAS_H
@@ -0,0 +1,310 @@
+/*---------------------------------------------------------------------------------
+
+Background.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Background.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief A set of BGR555 colors being median cut
+ */
+struct ColorBox {
+  std::vector<std::pair<uint16_t, int>> colors; // Color and pixel count
+
+  int channel(uint16_t color, int axis) const {
+    return (color >> (axis * 5)) & 31;
+  }
+
+  int range(int axis) const {
+    int lo = 31, hi = 0;
+    for (auto &c : colors) {
+      lo = std::min(lo, channel(c.first, axis));
+      hi = std::max(hi, channel(c.first, axis));
+    }
+    return hi - lo;
+  }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+static uint16_t toBGR555(uint32_t pixel) {
+  int r = (pixel >> 16) & 0xFF, g = (pixel >> 8) & 0xFF, b = pixel & 0xFF;
+  return (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10);
+}
+
+static int colorDistance(uint16_t a, uint16_t b) {
+  int distance = 0;
+  for (int axis = 0; axis < 3; axis++) {
+    int d = ((a >> (axis * 5)) & 31) - ((b >> (axis * 5)) & 31);
+    distance += d * d;
+  }
+  return distance;
+}
+
+/**
+ * @brief Picks up to 256 colors for all the images, in the order they're
+ *        first seen when there are few enough, else by median cut
+ * @return What each BGR555 color maps to
+ */
+static std::vector<uint8_t>
+buildPalette(const std::vector<const Image *> &images, uint16_t palette[256]) {
+  std::vector<int> counts(1 << 15);
+  std::vector<uint16_t> order;
+  for (const Image *image : images) {
+    for (uint32_t pixel : image->pixels) {
+      uint16_t color = toBGR555(pixel);
+      if (counts[color]++ == 0) order.push_back(color);
+    }
+  }
+
+  std::vector<uint8_t> lookup(1 << 15);
+  if (order.size() <= 256) {
+    for (size_t i = 0; i < order.size(); i++) {
+      palette[i] = order[i];
+      lookup[order[i]] = i;
+    }
+    return lookup;
+  }
+
+  // Split the box with the widest spread at the pixel weighted median of
+  // that channel until there are 256
+  std::vector<ColorBox> boxes(1);
+  for (uint16_t color : order) boxes[0].colors.push_back({color, counts[color]});
+
+  while (boxes.size() < 256) {
+    int best = -1, bestRange = 0, bestAxis = 0;
+    for (size_t i = 0; i < boxes.size(); i++) {
+      if (boxes[i].colors.size() < 2) continue;
+      for (int axis = 0; axis < 3; axis++) {
+        int range = boxes[i].range(axis);
+        if (range > bestRange) {
+          best = i;
+          bestRange = range;
+          bestAxis = axis;
+        }
+      }
+    }
+    if (best < 0) break;
+
+    ColorBox &box = boxes[best];
+    std::sort(box.colors.begin(), box.colors.end(),
+              [&](const std::pair<uint16_t, int> &a,
+                  const std::pair<uint16_t, int> &b) {
+                return box.channel(a.first, bestAxis) <
+                       box.channel(b.first, bestAxis);
+              });
+    long total = 0, half = 0;
+    for (auto &c : box.colors) total += c.second;
+    size_t split = 0;
+    while (split < box.colors.size() - 1 && half * 2 < total) {
+      half += box.colors[split++].second;
+    }
+    split = std::max<size_t>(split, 1);
+
+    ColorBox upper;
+    upper.colors.assign(box.colors.begin() + split, box.colors.end());
+    box.colors.resize(split);
+    boxes.push_back(upper);
+  }
+
+  // Each box becomes its pixel weighted average
+  for (size_t i = 0; i < boxes.size(); i++) {
+    long sum[3] = {}, total = 0;
+    for (auto &c : boxes[i].colors) {
+      for (int axis = 0; axis < 3; axis++) {
+        sum[axis] += (long)boxes[i].channel(c.first, axis) * c.second;
+      }
+      total += c.second;
+    }
+    palette[i] = 0;
+    for (int axis = 0; axis < 3; axis++) {
+      palette[i] |= ((sum[axis] + total / 2) / total) << (axis * 5);
+    }
+  }
+
+  // Every color goes to its nearest entry, not just the box it fell in
+  for (uint16_t color : order) {
+    int best = 0;
+    for (size_t i = 1; i < boxes.size(); i++) {
+      if (colorDistance(color, palette[i]) <
+          colorDistance(color, palette[best])) {
+        best = i;
+      }
+    }
+    lookup[color] = best;
+  }
+  return lookup;
+}
+
+/**
+ * @brief A tile flipped (its own inverse), bit 0 mirrors and bit 1 flips
+ */
+static std::string flipTile(const std::string &tile, int flip) {
+  std::string flipped(BG_TILE_BYTES, 0);
+  for (int y = 0; y < 8; y++) {
+    for (int x = 0; x < 8; x++) {
+      int sx = flip & 1 ? 7 - x : x;
+      int sy = flip & 2 ? 7 - y : y;
+      flipped[y * 8 + x] = tile[sy * 8 + sx];
+    }
+  }
+  return flipped;
+}
+
+/**
+ * @brief Whether no pixel of two tiles is further apart than tolerance in
+ *        any channel, 0 being an exact match
+ */
+static bool tilesMatch(const std::string &a, const std::string &b,
+                       const uint16_t palette[256], int tolerance) {
+  if (tolerance == 0) return a == b;
+  for (int i = 0; i < BG_TILE_BYTES; i++) {
+    uint16_t ca = palette[(uint8_t)a[i]], cb = palette[(uint8_t)b[i]];
+    for (int axis = 0; axis < 3; axis++) {
+      int d = ((ca >> (axis * 5)) & 31) - ((cb >> (axis * 5)) & 31);
+      if (d > tolerance || d < -tolerance) return false;
+    }
+  }
+  return true;
+}
+
+SharedBackgrounds convertBackgrounds(const std::vector<const Image *> &images,
+                                     int tolerance) {
+  SharedBackgrounds out;
+  std::vector<uint8_t> lookup = buildPalette(images, out.palette);
+
+  // Distinct tiles, the first of each kind standing in for the rest
+  struct Kind {
+    std::string tile;
+    int sums[3] = {};     // Per channel, tiles this far apart can't match
+    int numStages = 0;    // Stages using it
+    int lastStage = -1;
+    int index = -1;       // Where it ended up
+  };
+  std::vector<Kind> kinds;
+  std::map<std::string, int> exact; // Every flip of every kind
+
+  // Each map entry as its kind and the flip that turns that into the tile
+  struct Cell {
+    int kind;
+    int flip;
+  };
+  std::vector<std::vector<Cell>> cells(images.size());
+
+  for (size_t s = 0; s < images.size(); s++) {
+    const Image &image = *images[s];
+
+    // Off the image is color 0, for an edge that isn't on a tile boundary
+    for (int ty = 0; ty < (image.height + 7) / 8; ty++) {
+      for (int tx = 0; tx < (image.width + 7) / 8; tx++) {
+        std::string tile(BG_TILE_BYTES, 0);
+        for (int y = 0; y < 8; y++) {
+          for (int x = 0; x < 8; x++) {
+            int px = tx * 8 + x, py = ty * 8 + y;
+            if (px >= image.width || py >= image.height) continue;
+            tile[y * 8 + x] = lookup[toBGR555(image.at(px, py))];
+          }
+        }
+
+        Cell cell = {-1, 0};
+        auto it = exact.find(tile);
+        if (it != exact.end()) {
+          cell.kind = it->second;
+          cell.flip = -1; // Worked out below
+        }
+
+        int sums[3] = {};
+        for (int i = 0; i < BG_TILE_BYTES; i++) {
+          for (int axis = 0; axis < 3; axis++) {
+            sums[axis] += (out.palette[(uint8_t)tile[i]] >> (axis * 5)) & 31;
+          }
+        }
+
+        // Close enough to a kind already seen, as is or flipped
+        for (size_t k = 0; k < kinds.size() && cell.kind < 0; k++) {
+          bool near = true;
+          for (int axis = 0; axis < 3; axis++) {
+            int d = kinds[k].sums[axis] - sums[axis];
+            near &= d <= tolerance * BG_TILE_BYTES &&
+                    d >= -tolerance * BG_TILE_BYTES;
+          }
+          if (!near) continue;
+          for (int flip = 0; flip < 4 && cell.kind < 0; flip++) {
+            if (tilesMatch(kinds[k].tile, flipTile(tile, flip), out.palette,
+                           tolerance)) {
+              cell = {(int)k, flip};
+            }
+          }
+        }
+
+        if (cell.kind < 0) {
+          Kind kind;
+          kind.tile = tile;
+          std::copy(sums, sums + 3, kind.sums);
+          cell = {(int)kinds.size(), 0};
+          for (int flip = 3; flip >= 0; flip--) {
+            exact[flipTile(tile, flip)] = kinds.size();
+          }
+          kinds.push_back(kind);
+        } else if (cell.flip < 0) {
+          for (int flip = 0; flip < 4 && cell.flip < 0; flip++) {
+            if (flipTile(tile, flip) == kinds[cell.kind].tile) cell.flip = flip;
+          }
+        }
+
+        Kind &kind = kinds[cell.kind];
+        if (kind.lastStage != (int)s) {
+          kind.lastStage = s;
+          kind.numStages++;
+        }
+        cells[s].push_back(cell);
+      }
+    }
+  }
+
+  // Tiles more than one stage uses are shared, numbered as first seen
+  for (Kind &kind : kinds) {
+    if (kind.numStages < 2) continue;
+    kind.index = out.tiles.size() / BG_TILE_BYTES;
+    out.tiles.insert(out.tiles.end(), kind.tile.begin(), kind.tile.end());
+  }
+
+  // The rest are the stage's own, numbered after the shared ones
+  int numShared = out.tiles.size() / BG_TILE_BYTES;
+  out.stages.assign(images.size(), StageBackground());
+  for (size_t s = 0; s < images.size(); s++) {
+    StageBackground &stage = out.stages[s];
+    for (Cell &cell : cells[s]) {
+      Kind &kind = kinds[cell.kind];
+      if (kind.index < 0) {
+        kind.index = numShared + stage.tiles.size() / BG_TILE_BYTES;
+        stage.tiles.insert(stage.tiles.end(), kind.tile.begin(),
+                           kind.tile.end());
+      }
+      stage.map.push_back(kind.index | (cell.flip & 1 ? MAP_HFLIP : 0) |
+                          (cell.flip & 2 ? MAP_VFLIP : 0));
+    }
+  }
+  return out;
+}
@@ -0,0 +1,66 @@
+#ifndef ASSETC_BACKGROUND_H
+#define ASSETC_BACKGROUND_H
+
+#include "Png.h"
+#include <cstdint>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int BG_TILE_BYTES = 8 * 8;    // 8 bit tiles
+const int BG_MAX_TILES = 1024;      // Tiles a text BG can index, they go
+                                    // after the 4 KB map
+const int MAP_HFLIP = 1 << 10;      // Map entry flip bits
+const int MAP_VFLIP = 1 << 11;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief What one stage adds to the shared set
+ */
+struct StageBackground {
+  std::vector<uint8_t> tiles; // Only this stage uses these, they go in VRAM
+                              // straight after the shared tiles
+  std::vector<uint16_t> map;  // One entry per 8x8 of the image, row by row.
+                              // Camera streams it onto the hardware map.
+};
+
+/**
+ * @brief Every stage's background for a 256 color text BG, sharing one
+ *        palette and the tiles more than one stage uses
+ */
+struct SharedBackgrounds {
+  std::vector<uint8_t> tiles;          // 8x8 tiles of palette indexes
+  uint16_t palette[256] = {};          // BGR555
+  std::vector<StageBackground> stages; // In the order the images were given
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Converts each stage's image, arena sized, to tiles and a map
+ *        against one palette. Colors are reduced to BGR555 and, if all the
+ *        images still use more than 256, median cut down to 256. Tiles that
+ *        repeat, or repeat flipped, anywhere are stored once like grit's
+ *        -mRtf; ones in more than one stage go in the shared set.
+ * @param tolerance How far apart (in BGR555 steps, per channel) two tiles'
+ *        pixels may be and still count as a repeat. 0 only merges exact
+ *        repeats; the stages' art is the same wood and cork but redrawn with
+ *        a little noise, so it takes 1 or 2 to find it.
+ */
+SharedBackgrounds convertBackgrounds(const std::vector<const Image *> &images,
+                                     int tolerance);
+
+#endif // ASSETC_BACKGROUND_H
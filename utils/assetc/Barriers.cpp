@@ -0,0 +1,144 @@
+/*---------------------------------------------------------------------------------
+
+Barriers.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Barriers.h"
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Whether a pixel stops bullets, off the image counts as a wall
+ */
+static bool stopsBullets(const BarrierGrid &grid, int x, int y) {
+  if (x < 0 || y < 0 || x >= grid.width || y >= grid.height) return true;
+  int value = grid.at(x, y);
+  return value == BARRIER_WALL || value == BARRIER_DESTRUCTIBLE;
+}
+
+static void pushS16(std::vector<uint8_t> &out, int value) {
+  out.push_back(value & 0xFF);
+  out.push_back((value >> 8) & 0xFF);
+}
+
+bool readBarriers(const Image &image, BarrierGrid &grid, std::string &error) {
+  if (image.width % ARENA_CHUNK_SIZE != 0 ||
+      image.height % ARENA_CHUNK_SIZE != 0 || image.width < ARENA_MIN_WIDTH ||
+      image.height < ARENA_MIN_HEIGHT || image.width > ARENA_MAX_WIDTH ||
+      image.height > ARENA_MAX_HEIGHT) {
+    error = std::to_string(image.width) + "x" + std::to_string(image.height) +
+            " isn't an arena size, it takes multiples of " +
+            std::to_string(ARENA_CHUNK_SIZE) + " from " +
+            std::to_string(ARENA_MIN_WIDTH) + "x" +
+            std::to_string(ARENA_MIN_HEIGHT) + " to " +
+            std::to_string(ARENA_MAX_WIDTH) + "x" +
+            std::to_string(ARENA_MAX_HEIGHT);
+    return false;
+  }
+
+  grid.width = image.width;
+  grid.height = image.height;
+  grid.values.resize(image.pixels.size());
+
+  for (size_t i = 0; i < image.pixels.size(); i++) {
+    switch (image.pixels[i]) {
+    case 0xFF000000: grid.values[i] = BARRIER_EMPTY; break;
+    case 0xFFFFFFFF: grid.values[i] = BARRIER_WALL; break;
+    case 0xFF0000FF: grid.values[i] = BARRIER_HOLE; break;
+    case 0xFF00FF00: grid.values[i] = BARRIER_DESTRUCTIBLE; break;
+    default:
+      error = "pixel " + std::to_string(i % image.width) + "," +
+              std::to_string(i / image.width) +
+              " isn't pure black, white, blue or green";
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<uint8_t> packBarriers(const BarrierGrid &grid) {
+  std::vector<uint8_t> out((grid.width / 4) * grid.height);
+  for (int y = 0; y < grid.height; y++) {
+    for (int x = 0; x < grid.width; x++) {
+      out[y * (grid.width / 4) + x / 4] |= grid.at(x, y) << ((x & 3) * 2);
+    }
+  }
+  return out;
+}
+
+std::vector<uint8_t> packWalls(const BarrierGrid &grid) {
+  std::vector<int> faces;   // 6 values a face
+  std::vector<int> corners; // 4 values a corner
+
+  // A face is a maximal run of pixel edges between a pixel that stops
+  // bullets and one that doesn't. Vertical faces first, by line then top
+  // to bottom, each normal pointing out of the wall.
+  for (int x = 0; x <= grid.width; x++) {
+    int start = -1, normal = 0;
+    for (int y = 0; y <= grid.height; y++) {
+      int n = 0;
+      if (y < grid.height) {
+        bool left = stopsBullets(grid, x - 1, y);
+        bool right = stopsBullets(grid, x, y);
+        if (left && !right) n = 1;
+        else if (!left && right) n = -1;
+      }
+      if (n != normal) {
+        if (normal != 0) faces.insert(faces.end(), {x, start, x, y, normal, 0});
+        start = y;
+        normal = n;
+      }
+    }
+  }
+
+  // Then horizontal faces, by line then left to right
+  for (int y = 0; y <= grid.height; y++) {
+    int start = -1, normal = 0;
+    for (int x = 0; x <= grid.width; x++) {
+      int n = 0;
+      if (x < grid.width) {
+        bool above = stopsBullets(grid, x, y - 1);
+        bool below = stopsBullets(grid, x, y);
+        if (above && !below) n = 1;
+        else if (!above && below) n = -1;
+      }
+      if (n != normal) {
+        if (normal != 0) faces.insert(faces.end(), {start, y, x, y, 0, normal});
+        start = x;
+        normal = n;
+      }
+    }
+  }
+
+  // Convex corners have exactly one blocking pixel around the vertex, their
+  // normal points diagonally away from it
+  for (int y = 1; y < grid.height; y++) {
+    for (int x = 1; x < grid.width; x++) {
+      bool nw = stopsBullets(grid, x - 1, y - 1);
+      bool ne = stopsBullets(grid, x, y - 1);
+      bool sw = stopsBullets(grid, x - 1, y);
+      bool se = stopsBullets(grid, x, y);
+      if (nw + ne + sw + se != 1) continue;
+      corners.insert(corners.end(),
+                     {x, y, nw || sw ? 1 : -1, nw || ne ? 1 : -1});
+    }
+  }
+
+  std::vector<uint8_t> out;
+  pushS16(out, faces.size() / 6);
+  pushS16(out, corners.size() / 4);
+  for (int value : faces) pushS16(out, value);
+  for (int value : corners) pushS16(out, value);
+  return out;
+}
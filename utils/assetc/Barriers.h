@@ -0,0 +1,73 @@
+#ifndef ASSETC_BARRIERS_H
+#define ASSETC_BARRIERS_H
+
+#include "Png.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Barrier values, kept in step with source/Terrain.h
+const int BARRIER_EMPTY = 0;        // Black
+const int BARRIER_WALL = 1;         // White, stops everything
+const int BARRIER_HOLE = 2;         // Blue, stops tanks only
+const int BARRIER_DESTRUCTIBLE = 3; // Green, a wall mine blasts clear
+
+// Arena sizes Terrain takes, kept in step with source/Terrain.h
+const int ARENA_MIN_WIDTH = 256;
+const int ARENA_MIN_HEIGHT = 192;
+const int ARENA_MAX_WIDTH = 1024;
+const int ARENA_MAX_HEIGHT = 1024;
+const int ARENA_CHUNK_SIZE = 32;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief A barrier image as values, row by row
+ */
+struct BarrierGrid {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> values;
+
+  int at(int x, int y) const { return values[y * width + x]; }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Reads the barrier values out of an image, which may only use pure
+ *        black, white, blue and green, and must be an arena size: a multiple
+ *        of ARENA_CHUNK_SIZE between the screen and ARENA_MAX_WIDTH/HEIGHT
+ * @return False (with an error) if it's anything else
+ */
+bool readBarriers(const Image &image, BarrierGrid &grid, std::string &error);
+
+/**
+ * @brief Packs the grid 2 bits a pixel, 4 pixels a byte with the leftmost in
+ *        the low bits, row by row. Terrain::load reads this layout.
+ */
+std::vector<uint8_t> packBarriers(const BarrierGrid &grid);
+
+/**
+ * @brief Extracts the faces and convex corners bullets bounce off and packs
+ *        them as little endian s16s: the face count, the corner count, each
+ *        face as x1, y1, x2, y2, nx, ny and each corner as x, y, nx, ny.
+ *        Kept in step with WallGeometry::extract in source/.
+ */
+std::vector<uint8_t> packWalls(const BarrierGrid &grid);
+
+#endif // ASSETC_BARRIERS_H
@@ -0,0 +1,321 @@
+/*---------------------------------------------------------------------------------
+
+Png.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Png.h"
+#include <cstdlib>
+#include <cstring>
+
+//---------------------------------------------------------------------------------
+//
+// INFLATE
+//
+//---------------------------------------------------------------------------------
+
+// Deflate's base lengths and distances, and the extra bits read after them
+static const uint16_t LENGTH_BASE[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                         1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                         4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DIST_BASE[30] = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,
+    65,  97,  129, 193, 257, 385,  513,  769,  1025, 1537, 2049, 3073,
+    4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,
+                                       4, 4, 5, 5, 6, 6, 7,  7,  8,  8,
+                                       9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// The order code length code lengths are sent in
+static const uint8_t CODE_ORDER[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                       11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+/**
+ * @brief A canonical Huffman code, decoded a bit at a time
+ */
+struct Huffman {
+  uint16_t counts[16];   // Codes of each length
+  uint16_t symbols[288]; // Symbols ordered by code
+};
+
+struct BitReader {
+  const uint8_t *data;
+  size_t size;
+  size_t pos = 0;
+  uint32_t bits = 0;
+  int count = 0;
+  bool overrun = false;
+
+  int read(int need) {
+    while (count < need) {
+      if (pos == size) {
+        overrun = true;
+        return 0;
+      }
+      bits |= (uint32_t)data[pos++] << count;
+      count += 8;
+    }
+    int value = bits & ((1u << need) - 1);
+    bits >>= need;
+    count -= need;
+    return value;
+  }
+};
+
+static void buildHuffman(Huffman &code, const uint8_t *lengths, int n) {
+  memset(code.counts, 0, sizeof(code.counts));
+  for (int i = 0; i < n; i++) code.counts[lengths[i]]++;
+  code.counts[0] = 0;
+
+  uint16_t offsets[16] = {};
+  for (int len = 1; len < 16; len++) {
+    offsets[len] = offsets[len - 1] + code.counts[len - 1];
+  }
+  for (int i = 0; i < n; i++) {
+    if (lengths[i]) code.symbols[offsets[lengths[i]]++] = i;
+  }
+}
+
+static int decodeSymbol(BitReader &in, const Huffman &code) {
+  int value = 0, first = 0, index = 0;
+  for (int len = 1; len < 16; len++) {
+    value |= in.read(1);
+    int count = code.counts[len];
+    if (value - first < count) return code.symbols[index + value - first];
+    index += count;
+    first = (first + count) << 1;
+    value <<= 1;
+    if (in.overrun) break;
+  }
+  return -1;
+}
+
+static bool inflateBlock(BitReader &in, std::vector<uint8_t> &out,
+                         const Huffman &lengths, const Huffman &distances) {
+  while (true) {
+    int symbol = decodeSymbol(in, lengths);
+    if (symbol < 0) return false;
+    if (symbol < 256) {
+      out.push_back(symbol);
+      continue;
+    }
+    if (symbol == 256) return true;
+
+    symbol -= 257;
+    if (symbol >= 29) return false;
+    int length = LENGTH_BASE[symbol] + in.read(LENGTH_EXTRA[symbol]);
+    int dist = decodeSymbol(in, distances);
+    if (dist < 0 || dist >= 30) return false;
+    size_t back = DIST_BASE[dist] + in.read(DIST_EXTRA[dist]);
+    if (back > out.size() || in.overrun) return false;
+
+    size_t from = out.size() - back;
+    for (int i = 0; i < length; i++) out.push_back(out[from + i]);
+  }
+}
+
+/**
+ * @brief Inflates a zlib stream (the header and checksum are skipped)
+ */
+static bool inflateZlib(const std::vector<uint8_t> &data,
+                        std::vector<uint8_t> &out) {
+  if (data.size() < 2) return false;
+  BitReader in{data.data() + 2, data.size() - 2};
+
+  int last;
+  do {
+    last = in.read(1);
+    int type = in.read(2);
+
+    if (type == 0) {
+      // Stored, byte aligned
+      in.bits = 0;
+      in.count = 0;
+      if (in.pos + 4 > in.size) return false;
+      int len = in.data[in.pos] | (in.data[in.pos + 1] << 8);
+      in.pos += 4;
+      if (in.pos + len > in.size) return false;
+      out.insert(out.end(), in.data + in.pos, in.data + in.pos + len);
+      in.pos += len;
+    } else if (type == 1) {
+      Huffman lengths, distances;
+      uint8_t lens[288];
+      for (int i = 0; i < 288; i++) {
+        lens[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+      }
+      buildHuffman(lengths, lens, 288);
+      for (int i = 0; i < 30; i++) lens[i] = 5;
+      buildHuffman(distances, lens, 30);
+      if (!inflateBlock(in, out, lengths, distances)) return false;
+    } else if (type == 2) {
+      int numLengths = in.read(5) + 257;
+      int numDistances = in.read(5) + 1;
+      int numCodes = in.read(4) + 4;
+
+      uint8_t lens[320] = {};
+      for (int i = 0; i < numCodes; i++) lens[CODE_ORDER[i]] = in.read(3);
+      Huffman codes;
+      buildHuffman(codes, lens, 19);
+
+      memset(lens, 0, sizeof(lens));
+      for (int i = 0; i < numLengths + numDistances;) {
+        int symbol = decodeSymbol(in, codes);
+        if (symbol < 0) return false;
+        if (symbol < 16) {
+          lens[i++] = symbol;
+          continue;
+        }
+        int repeat, value = 0;
+        if (symbol == 16) {
+          if (i == 0) return false;
+          value = lens[i - 1];
+          repeat = 3 + in.read(2);
+        } else if (symbol == 17) {
+          repeat = 3 + in.read(3);
+        } else {
+          repeat = 11 + in.read(7);
+        }
+        if (i + repeat > numLengths + numDistances) return false;
+        while (repeat--) lens[i++] = value;
+      }
+
+      Huffman lengths, distances;
+      buildHuffman(lengths, lens, numLengths);
+      buildHuffman(distances, lens + numLengths, numDistances);
+      if (!inflateBlock(in, out, lengths, distances)) return false;
+    } else {
+      return false;
+    }
+    if (in.overrun) return false;
+  } while (!last);
+
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PNG
+//
+//---------------------------------------------------------------------------------
+
+static uint32_t readBE32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static int paeth(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+  if (pa <= pb && pa <= pc) return a;
+  return pb <= pc ? b : c;
+}
+
+bool decodePng(const std::vector<uint8_t> &data, Image &image,
+               std::string &error) {
+  static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A,
+                                       '\n'};
+  if (data.size() < 8 || memcmp(data.data(), SIGNATURE, 8) != 0) {
+    error = "not a PNG";
+    return false;
+  }
+
+  int colorType = -1;
+  std::vector<uint8_t> idat;
+  std::vector<uint32_t> palette;
+  for (size_t pos = 8; pos + 12 <= data.size();) {
+    uint32_t len = readBE32(&data[pos]);
+    const uint8_t *type = &data[pos + 4];
+    const uint8_t *body = &data[pos + 8];
+    if (pos + 12 + len > data.size()) break;
+
+    if (!memcmp(type, "IHDR", 4)) {
+      image.width = readBE32(body);
+      image.height = readBE32(body + 4);
+      colorType = body[9];
+      if (body[8] != 8 || body[12] != 0) {
+        error = "only 8 bit, non-interlaced PNGs are supported";
+        return false;
+      }
+    } else if (!memcmp(type, "PLTE", 4)) {
+      for (uint32_t i = 0; i + 2 < len; i += 3) {
+        palette.push_back(0xFF000000u | (body[i] << 16) | (body[i + 1] << 8) |
+                          body[i + 2]);
+      }
+    } else if (!memcmp(type, "tRNS", 4) && colorType == 3) {
+      for (uint32_t i = 0; i < len && i < palette.size(); i++) {
+        palette[i] = (palette[i] & 0xFFFFFF) | ((uint32_t)body[i] << 24);
+      }
+    } else if (!memcmp(type, "IDAT", 4)) {
+      idat.insert(idat.end(), body, body + len);
+    } else if (!memcmp(type, "IEND", 4)) {
+      break;
+    }
+    pos += 12 + len;
+  }
+
+  int channels = colorType == 0   ? 1
+                 : colorType == 2 ? 3
+                 : colorType == 3 ? 1
+                 : colorType == 4 ? 2
+                 : colorType == 6 ? 4
+                                  : 0;
+  if (channels == 0 || image.width <= 0 || image.height <= 0) {
+    error = "unsupported PNG color type";
+    return false;
+  }
+
+  std::vector<uint8_t> raw;
+  size_t stride = (size_t)image.width * channels;
+  if (!inflateZlib(idat, raw) || raw.size() < (stride + 1) * image.height) {
+    error = "corrupt image data";
+    return false;
+  }
+
+  // Undo the per-row filters in place
+  std::vector<uint8_t> prev(stride), cur(stride);
+  image.pixels.resize((size_t)image.width * image.height);
+  for (int y = 0; y < image.height; y++) {
+    const uint8_t *row = &raw[y * (stride + 1)];
+    int filter = row[0];
+    for (size_t i = 0; i < stride; i++) {
+      int a = i >= (size_t)channels ? cur[i - channels] : 0;
+      int b = prev[i];
+      int c = i >= (size_t)channels ? prev[i - channels] : 0;
+      int x = row[1 + i];
+      switch (filter) {
+      case 1: x += a; break;
+      case 2: x += b; break;
+      case 3: x += (a + b) >> 1; break;
+      case 4: x += paeth(a, b, c); break;
+      }
+      cur[i] = x;
+    }
+
+    for (int x = 0; x < image.width; x++) {
+      const uint8_t *p = &cur[x * channels];
+      uint32_t pixel;
+      switch (colorType) {
+      case 0: pixel = 0xFF000000u | (p[0] << 16) | (p[0] << 8) | p[0]; break;
+      case 2: pixel = 0xFF000000u | (p[0] << 16) | (p[1] << 8) | p[2]; break;
+      case 3: pixel = p[0] < palette.size() ? palette[p[0]] : 0; break;
+      case 4:
+        pixel = ((uint32_t)p[1] << 24) | (p[0] << 16) | (p[0] << 8) | p[0];
+        break;
+      default:
+        pixel = ((uint32_t)p[3] << 24) | (p[0] << 16) | (p[1] << 8) | p[2];
+        break;
+      }
+      image.pixels[y * image.width + x] = pixel;
+    }
+    std::swap(prev, cur);
+  }
+
+  return true;
+}
@@ -0,0 +1,42 @@
+#ifndef ASSETC_PNG_H
+#define ASSETC_PNG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief A decoded image, one 0xAARRGGBB pixel per entry, row by row
+ */
+struct Image {
+  int width = 0;
+  int height = 0;
+  std::vector<uint32_t> pixels;
+
+  uint32_t at(int x, int y) const { return pixels[y * width + x]; }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Decodes a PNG. Handles 8 bit greyscale, RGB, palette and RGBA
+ *        images without interlacing, which covers everything the art
+ *        tools here export.
+ * @param data The whole file
+ * @param error Why it failed, if it did
+ * @return False if the file isn't a PNG this can read
+ */
+bool decodePng(const std::vector<uint8_t> &data, Image &image,
+               std::string &error);
+
+#endif // ASSETC_PNG_H
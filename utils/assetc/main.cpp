@@ -0,0 +1,391 @@
+/*---------------------------------------------------------------------------------
+
+main.cpp
+Camdyn Rasque
+
+The stage asset compiler, run by the Makefile on the host:
+
+  assetc -o <output dir> [-j threads] [-t tolerance] <stage png>...
+  assetc -a <sprite manifest.json> <output base>
+
+stage-N_barriers.png becomes stage-N_barriers.bin (2 bits a pixel, row by
+row, Terrain chunks it on load) and stage-N_walls.bin (the faces bullets
+bounce off). Either image can be any arena size up to 1024x1024.
+The stage-N_bg.png images are converted together: bg_pal.bin is the
+palette they share, bg_tiles.bin the tiles more than one of them uses,
+and each stage gets stage-N_bg_tiles.bin with only its own tiles and its
+stage-N_bg_map.bin, the whole arena's map. The Makefile links them in with bin2o.
+
+Inputs are converted in parallel. Each input's content hash is kept in
+<output dir>/assetc.cache, so unchanged inputs are skipped (the
+backgrounds only all together), and outputs are only rewritten when their
+bytes change, so make only relinks what really changed.
+
+With -a it packs a sprite sheet into <output base>.c and .h instead, see
+Atlas.h.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Atlas.h"
+#include "Background.h"
+#include "Barriers.h"
+#include "Png.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Bump when the output format changes so every input is converted again
+static const char *ASSETC_VERSION = "assetc 4";
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+struct Job {
+  std::string input;     // Path to the PNG
+  std::string name;      // File name without .png
+  bool background = false; // A _bg.png, converted with the others
+  std::vector<uint8_t> data; // The file's bytes
+  Image image;               // Backgrounds are decoded ahead of converting
+  uint64_t hash = 0;         // Of the tool version and the file's bytes
+  bool skipped = false;  // The cache said nothing changed
+  bool failed = false;
+  std::string error;
+  double milliseconds = 0;
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * @brief 64 bit FNV-1a, plenty to tell edited art apart
+ */
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &data) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  data.assign(std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>());
+  return true;
+}
+
+/**
+ * @brief Writes a file unless it already holds exactly these bytes, so its
+ *        timestamp (and everything make builds from it) is left alone
+ */
+static bool writeIfChanged(const std::string &path, const void *data,
+                           size_t size) {
+  std::vector<uint8_t> existing;
+  if (readFile(path, existing) && existing.size() == size &&
+      memcmp(existing.data(), data, size) == 0) {
+    return true;
+  }
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write((const char *)data, size);
+  return (bool)file;
+}
+
+static bool endsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * @brief The files an input converts to
+ */
+static std::vector<std::string> outputsFor(const Job &job,
+                                           const std::string &outDir) {
+  std::string base = outDir + "/" + job.name;
+  if (endsWith(job.name, "_barriers")) {
+    std::string stage = job.name.substr(0, job.name.size() - 9);
+    return {base + ".bin", outDir + "/" + stage + "_walls.bin"};
+  }
+  if (job.background) {
+    return {base + "_tiles.bin", base + "_map.bin", outDir + "/bg_tiles.bin",
+            outDir + "/bg_pal.bin"};
+  }
+  return {};
+}
+
+/**
+ * @brief Converts one barrier image, or decodes one background for
+ *        convertAllBackgrounds
+ */
+static void convert(Job &job, const std::string &outDir) {
+  if (!decodePng(job.data, job.image, job.error)) {
+    job.failed = true;
+    return;
+  }
+  if (job.background) return;
+
+  std::vector<std::string> outputs = outputsFor(job, outDir);
+  if (endsWith(job.name, "_barriers")) {
+    BarrierGrid grid;
+    if (!readBarriers(job.image, grid, job.error)) {
+      job.failed = true;
+      return;
+    }
+    std::vector<uint8_t> barriers = packBarriers(grid);
+    std::vector<uint8_t> walls = packWalls(grid);
+    job.failed =
+        !writeIfChanged(outputs[0], barriers.data(), barriers.size()) ||
+        !writeIfChanged(outputs[1], walls.data(), walls.size());
+  } else {
+    job.error = "not a _barriers.png or _bg.png";
+    job.failed = true;
+    return;
+  }
+  if (job.failed) job.error = "couldn't write the outputs";
+}
+
+/**
+ * @brief Converts the decoded backgrounds into one shared tile set and
+ *        palette, failing every job if a stage's tiles won't fit in VRAM
+ */
+static void convertAllBackgrounds(std::vector<Job *> &backgrounds,
+                                  const std::string &outDir, int tolerance) {
+  std::vector<const Image *> images;
+  for (Job *job : backgrounds) images.push_back(&job->image);
+  SharedBackgrounds shared = convertBackgrounds(images, tolerance);
+
+  int numShared = shared.tiles.size() / BG_TILE_BYTES;
+  bool wrote = writeIfChanged(outDir + "/bg_tiles.bin", shared.tiles.data(),
+                              shared.tiles.size()) &&
+               writeIfChanged(outDir + "/bg_pal.bin", shared.palette,
+                              sizeof(shared.palette));
+
+  for (size_t i = 0; i < backgrounds.size(); i++) {
+    Job &job = *backgrounds[i];
+    StageBackground &stage = shared.stages[i];
+    int numTiles = numShared + stage.tiles.size() / BG_TILE_BYTES;
+    if (numTiles > BG_MAX_TILES) {
+      job.error = "needs " + std::to_string(numTiles) + " tiles (" +
+                  std::to_string(numShared) + " shared), there's room for " +
+                  std::to_string(BG_MAX_TILES);
+      job.failed = true;
+      continue;
+    }
+
+    std::vector<std::string> outputs = outputsFor(job, outDir);
+    job.failed = !wrote ||
+                 !writeIfChanged(outputs[0], stage.tiles.data(),
+                                 stage.tiles.size()) ||
+                 !writeIfChanged(outputs[1], stage.map.data(),
+                                 stage.map.size() * sizeof(uint16_t));
+    if (job.failed) job.error = "couldn't write the outputs";
+  }
+  printf("assetc: %d shared background tiles\n", numShared);
+}
+
+/**
+ * @brief Runs work(i) for every i below count on a pool of threads
+ */
+template <typename Work>
+static void runParallel(int threads, size_t count, Work work) {
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) work(i);
+  };
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads; i++) pool.emplace_back(worker);
+  worker();
+  for (std::thread &thread : pool) thread.join();
+}
+
+static std::map<std::string, uint64_t> readCache(const std::string &path) {
+  std::map<std::string, uint64_t> cache;
+  std::ifstream file(path);
+  std::string name;
+  uint64_t hash;
+  while (file >> name >> std::hex >> hash) cache[name] = hash;
+  return cache;
+}
+
+//---------------------------------------------------------------------------------
+//
+// MAIN
+//
+//---------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  auto start = std::chrono::steady_clock::now();
+  std::string outDir = ".";
+  int threads = std::thread::hardware_concurrency();
+  int tolerance = 0; // See convertBackgrounds
+  std::vector<Job> jobs;
+  std::string atlasManifest, atlasBase;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-a") && i + 2 < argc) {
+      atlasManifest = argv[++i];
+      atlasBase = argv[++i];
+    } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      outDir = argv[++i];
+    } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+      tolerance = atoi(argv[++i]);
+    } else {
+      Job job;
+      job.input = argv[i];
+      std::string file = job.input.substr(job.input.find_last_of('/') + 1);
+      job.name = file.substr(0, file.rfind(".png"));
+      job.background = endsWith(job.name, "_bg");
+      jobs.push_back(job);
+    }
+  }
+  if (!atlasManifest.empty()) {
+    std::string summary, error;
+    if (!packAtlas(atlasManifest, atlasBase, summary, error)) {
+      fprintf(stderr, "assetc: %s: %s\n", atlasManifest.c_str(),
+              error.c_str());
+      return 1;
+    }
+    printf("assetc: %s (%.1f ms)\n", summary.c_str(),
+           millisecondsSince(start));
+    if (jobs.empty()) return 0;
+  }
+  if (jobs.empty()) {
+    fprintf(stderr, "Usage: assetc -o <output dir> [-j threads] [-t tolerance] "
+                    "<png>...\n"
+                    "       assetc -a <sprite manifest.json> <output base>\n");
+    return 1;
+  }
+  if (threads < 1) threads = 1;
+  if (threads > (int)jobs.size()) threads = jobs.size();
+
+  std::string cachePath = outDir + "/assetc.cache";
+  std::map<std::string, uint64_t> cache = readCache(cachePath);
+
+  // Hash everything first, skipping what hasn't changed and still has its
+  // outputs
+  runParallel(threads, jobs.size(), [&](size_t i) {
+    Job &job = jobs[i];
+    auto jobStart = std::chrono::steady_clock::now();
+    if (!readFile(job.input, job.data)) {
+      job.failed = true;
+      job.error = "couldn't read it";
+      return;
+    }
+    job.hash = hashBytes(0xCBF29CE484222325ull, ASSETC_VERSION,
+                         strlen(ASSETC_VERSION));
+    job.hash = hashBytes(job.hash, job.data.data(), job.data.size());
+
+    auto cached = cache.find(job.name);
+    job.skipped = cached != cache.end() && cached->second == job.hash;
+    for (const std::string &output : outputsFor(job, outDir)) {
+      if (!std::ifstream(output)) job.skipped = false;
+    }
+    job.milliseconds = millisecondsSince(jobStart);
+  });
+
+  // The backgrounds share their tiles, so if one changed (or one was added
+  // or removed) they're all converted again
+  std::vector<Job *> backgrounds;
+  uint64_t backgroundsHash =
+      hashBytes(0xCBF29CE484222325ull, &tolerance, sizeof(tolerance));
+  bool backgroundsChanged = false;
+  for (Job &job : jobs) {
+    if (!job.background) continue;
+    backgrounds.push_back(&job);
+    backgroundsHash = hashBytes(backgroundsHash, job.name.data(),
+                                job.name.size());
+    backgroundsHash = hashBytes(backgroundsHash, &job.hash, sizeof(job.hash));
+    backgroundsChanged |= !job.skipped;
+  }
+  auto cached = cache.find("backgrounds");
+  if (cached == cache.end() || cached->second != backgroundsHash) {
+    backgroundsChanged = true;
+  }
+  for (Job *job : backgrounds) job->skipped = !backgroundsChanged;
+
+  runParallel(threads, jobs.size(), [&](size_t i) {
+    Job &job = jobs[i];
+    if (job.failed || job.skipped) return;
+    auto jobStart = std::chrono::steady_clock::now();
+    convert(job, outDir);
+    job.milliseconds += millisecondsSince(jobStart);
+  });
+
+  if (backgroundsChanged && !backgrounds.empty()) {
+    bool decoded = true;
+    for (Job *job : backgrounds) decoded &= !job->failed;
+    if (decoded) {
+      auto sharedStart = std::chrono::steady_clock::now();
+      convertAllBackgrounds(backgrounds, outDir, tolerance);
+      double sharedTime = millisecondsSince(sharedStart);
+      for (Job *job : backgrounds) job->milliseconds += sharedTime;
+    }
+  }
+
+  // Report, and remember what converted cleanly
+  int converted = 0, skipped = 0, failed = 0;
+  for (Job &job : jobs) {
+    if (job.failed) {
+      fprintf(stderr, "assetc: %s: %s\n", job.input.c_str(),
+              job.error.c_str());
+      cache.erase(job.name);
+      failed++;
+    } else if (job.skipped) {
+      skipped++;
+    } else {
+      printf("assetc: %s (%.1f ms)\n", job.name.c_str(), job.milliseconds);
+      cache[job.name] = job.hash;
+      converted++;
+    }
+  }
+  bool backgroundsFailed = false;
+  for (Job *job : backgrounds) backgroundsFailed |= job->failed;
+  if (backgroundsFailed) cache.erase("backgrounds");
+  else if (!backgrounds.empty()) cache["backgrounds"] = backgroundsHash;
+
+  std::ostringstream out;
+  for (auto &entry : cache) {
+    out << entry.first << " " << std::hex << entry.second << "\n";
+  }
+  std::string text = out.str();
+  writeIfChanged(cachePath, text.data(), text.size());
+
+  printf("assetc: %d converted, %d up to date, %d failed in %.1f ms on %d "
+         "threads\n",
+         converted, skipped, failed, millisecondsSince(start), threads);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,370 @@
+/*---------------------------------------------------------------------------------
+
+main.cpp
+Camdyn Rasque
+
+The bullet collision fuzz test, run on the host:
+
+  collisionfuzz [-n shots] [-a arenas] [-f frames] [-s seed]
+
+Fires -n random shots through sweepBoxes, bullets past bullets and tanks
+(and boxes of any size) moving up to BULLET_MAX_SWEEP a frame, and checks
+each against a brute force answer: the boxes stepped through the frame
+finely enough that no overlap can fall between two steps. Then plays -a
+generated arenas for -f frames each with every tank firing fast bullets
+at random, and after each stepSimulation checks no bullet still in
+flight swept through a tank or another bullet without popping. Fails on
+any miss, any false hit and any time of impact that isn't when the
+boxes first meet.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Arena.h"
+#include "Bullet.h"
+#include "Simulation.h"
+#include "Stage.h"
+#include "Tank.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int FUZZ_ARENA_WIDTH = 384; // Room for every tank to get a shot off
+const int FUZZ_ARENA_HEIGHT = 288;
+const int FUZZ_ENEMIES = 7;
+const int FUZZ_BULLET_SIZE = 6; // See Bullet::width
+const int FUZZ_MAX_BOX = 32;    // Largest box the any-size shots use
+const int FUZZ_FIRE_CHANCE = 8; // A tank fires about once in this many frames
+
+// Shifts every burst down to nothing, the particles are only for show
+const int NO_PARTICLES = 16;
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief What the command line asked for
+ */
+struct FuzzOptions {
+  long shots = 4000000;
+  int arenas = 200;
+  int frames = 1800;
+  uint32_t seed = 1;
+};
+
+/**
+ * @brief What went wrong, and how often
+ */
+struct FuzzFailures {
+  long missed = 0;    // Met, but sweepBoxes said they didn't
+  long phantom = 0;   // sweepBoxes said they met, but they never did
+  long toi_off = 0;   // The time of impact isn't when they first overlap
+  long tunnelled = 0; // A bullet still flying through what it swept over
+
+  long total() const { return missed + phantom + toi_off + tunnelled; }
+};
+
+/**
+ * @brief xorshift32, the same every run for a seed
+ */
+struct FuzzRandom {
+  uint32_t state;
+
+  FuzzRandom(uint32_t seed) : state(seed * 2654435761u | 1) {}
+
+  int next(int range) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (int)(state % (uint32_t)range);
+  }
+
+  int between(int lo, int hi) { return lo + next(hi - lo + 1); }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Brute force answer to sweepBoxes. Steps the frame in 1 / steps,
+ *        where steps is twice the product of the relative speeds: every
+ *        time an axis starts or stops overlapping is a multiple of two
+ *        steps, so any overlap spans at least one step.
+ * @param first Set to the first step they overlap at, if they do
+ * @param steps Set to the steps in the frame
+ * @return True if the boxes overlap at any point during the frame
+ */
+static bool overlapsDuring(const CollisionBox &a, int adx, int ady,
+                           const CollisionBox &b, int bdx, int bdy,
+                           long &first, long &steps) {
+  long vx = adx - bdx, vy = ady - bdy;
+  steps = 2 * (vx ? labs(vx) : 1) * (vy ? labs(vy) : 1);
+
+  // a relative to b, everything scaled up by steps
+  long x = (long)(a.x - b.x) * steps, y = (long)(a.y - b.y) * steps;
+  long xlo = -(long)a.w * steps, xhi = (long)b.w * steps;
+  long ylo = -(long)a.h * steps, yhi = (long)b.h * steps;
+  for (long k = 0; k <= steps; k++, x += vx, y += vy) {
+    if (x > xlo && x < xhi && y > ylo && y < yhi) {
+      first = k;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Checks sweepBoxes against overlapsDuring for one pair
+ */
+static void checkSweep(const CollisionBox &a, int adx, int ady,
+                       const CollisionBox &b, int bdx, int bdy,
+                       FuzzFailures &failures, long &hits) {
+  int toi = -1;
+  bool swept = sweepBoxes(a, adx, ady, b, bdx, bdy, toi);
+  long first = 0, steps = 1;
+  bool met = overlapsDuring(a, adx, ady, b, bdx, bdy, first, steps);
+
+  const char *wrong = nullptr;
+  if (met && !swept) {
+    failures.missed++;
+    wrong = "missed";
+  } else if (swept && !met) {
+    failures.phantom++;
+    wrong = "phantom";
+  } else if (met) {
+    hits++;
+    // They first meet between steps first - 1 and first, toi is rounded
+    // down from that
+    bool late = (long)toi * steps > first * TOI_ONE;
+    bool early = first == 0 ? toi != 0
+                            : (long)(toi + 1) * steps <= (first - 1) * TOI_ONE;
+    if (toi < 0 || toi > TOI_ONE || late || early) {
+      failures.toi_off++;
+      wrong = "toi off";
+    }
+  }
+
+  if (wrong != nullptr && failures.total() <= 10) {
+    fprintf(stderr,
+            "collisionfuzz: %s, {%d,%d,%d,%d} +(%d,%d) vs {%d,%d,%d,%d} "
+            "+(%d,%d), toi %d, first overlap %ld/%ld\n",
+            wrong, a.x, a.y, a.w, a.h, adx, ady, b.x, b.y, b.w, b.h, bdx, bdy,
+            toi, first, steps);
+  }
+}
+
+/**
+ * @brief Random shots straight through sweepBoxes
+ */
+static long fuzzSweeps(const FuzzOptions &options, FuzzFailures &failures) {
+  FuzzRandom random(options.seed);
+  long hits = 0;
+
+  for (long shot = 0; shot < options.shots; shot++) {
+    int kind = shot % 3;
+    int reach = BULLET_MAX_SWEEP;
+    CollisionBox a = {0, 0, FUZZ_BULLET_SIZE, FUZZ_BULLET_SIZE};
+    CollisionBox b = {0, 0, FUZZ_BULLET_SIZE, FUZZ_BULLET_SIZE};
+    if (kind == 1) b.w = b.h = TANK_SIZE;
+    if (kind == 2) {
+      a.w = random.between(1, FUZZ_MAX_BOX);
+      a.h = random.between(1, FUZZ_MAX_BOX);
+      b.w = random.between(1, FUZZ_MAX_BOX);
+      b.h = random.between(1, FUZZ_MAX_BOX);
+    }
+
+    // Close enough that most shots could hit, from every side
+    int spread = a.w + b.w + 2 * reach;
+    a.x = random.between(-spread, spread);
+    a.y = random.between(-spread, spread);
+    int adx = random.between(-reach, reach);
+    int ady = random.between(-reach, reach);
+    // Tanks barely move in a frame, the sweep treats them as still
+    int bdx = kind == 1 ? 0 : random.between(-reach, reach);
+    int bdy = kind == 1 ? 0 : random.between(-reach, reach);
+    // Straight along an axis is the usual shot, make sure plenty are
+    if (random.next(4) == 0) (random.next(2) ? adx : ady) = 0;
+
+    checkSweep(a, adx, ady, b, bdx, bdy, failures, hits);
+  }
+  return hits;
+}
+
+/**
+ * @brief Where a bullet's box went this frame, in a straight line
+ */
+static void bulletSweep(Bullet *bullet, CollisionBox &box, int &dx, int &dy) {
+  box = {bullet->swept_from.x, bullet->swept_from.y, bullet->width,
+         bullet->height};
+  dx = bullet->pos.x - bullet->swept_from.x;
+  dy = bullet->pos.y - bullet->swept_from.y;
+}
+
+/**
+ * @brief Every bullet still flying after a frame, against every tank and
+ *        bullet still there. Checks all of them rather than the grid's
+ *        neighbours, so a pair the broadphase dropped shows up too.
+ */
+static void checkFrame(Stage *stage, FuzzFailures &failures) {
+  for (Bullet *bullet : stage->live_bullets) {
+    if (bullet->has_exploded) continue;
+    CollisionBox box;
+    int dx, dy;
+    bulletSweep(bullet, box, dx, dy);
+    long first, steps;
+
+    for (Tank *tank : stage->active_tanks) {
+      if (bullet->getOwner() == tank && bullet->num_ricochets == 0) continue;
+      Position tankPos = tank->getOffsetPosition();
+      CollisionBox tankBox = {tankPos.x, tankPos.y, tank->width,
+                              tank->height};
+      if (overlapsDuring(box, dx, dy, tankBox, 0, 0, first, steps)) {
+        failures.tunnelled++;
+      }
+    }
+
+    for (Bullet *other : stage->live_bullets) {
+      if (other->live_index <= bullet->live_index || other->has_exploded) {
+        continue;
+      }
+      CollisionBox otherBox;
+      int otherDx, otherDy;
+      bulletSweep(other, otherBox, otherDx, otherDy);
+      if (overlapsDuring(box, dx, dy, otherBox, otherDx, otherDy, first,
+                         steps)) {
+        failures.tunnelled++;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Plays generated arenas with every tank firing at random
+ * @param shots Bullets fired, counted as they leave the turret
+ */
+static void fuzzStages(const FuzzOptions &options, FuzzFailures &failures,
+                       long &shots, long &frames) {
+  Stage::sprite_gfx.loadAtlas();
+  Stage::particles.burst_shift = NO_PARTICLES;
+
+  for (int i = 0; i < options.arenas; i++) {
+    uint32_t seed = options.seed + i;
+    Arena arena;
+    if (!generateArena(FUZZ_ARENA_WIDTH, FUZZ_ARENA_HEIGHT, FUZZ_ENEMIES,
+                       T_COLOR_BLACK, seed, arena)) {
+      continue;
+    }
+    FuzzRandom random(seed);
+    Stage::frame_counter = 0;
+    Stage::timers.rewind();
+
+    // Every tank as its color, but with all the fast bullets it can have
+    std::vector<TankSpawn> spawns;
+    std::vector<TankArchetype> archetypes;
+    for (const ArenaSpawn &spawn : arena.spawns) {
+      spawns.push_back(
+          {spawn.x, spawn.y, spawn.color, (TankDirection)spawn.direction});
+      TankArchetype archetype = getTankArchetype(spawn.color);
+      archetype.bullet_speed = B_SPEED_FAST;
+      archetype.fire_rate_cooldown = T_COOLDOWN_FAST;
+      archetype.max_bullets = MAX_TANK_BULLETS;
+      archetype.max_bullet_ricochets = random.between(0, 3);
+      archetypes.push_back(archetype);
+    }
+    StageLayout layout = {arena.width,
+                          arena.height,
+                          arena.barriers.data(),
+                          nullptr,
+                          (const short *)arena.walls.data(),
+                          spawns.data(),
+                          (int)spawns.size(),
+                          archetypes.data()};
+    Stage *stage = new Stage(layout);
+
+    for (int frame = 0; frame < options.frames; frame++) {
+      // Turn every turret somewhere on the stage and maybe fire, on top of
+      // what the AI does
+      int before = stage->live_bullets.size();
+      for (Tank *tank : stage->active_tanks) {
+        tank->rotateTurret({random.next(arena.width),
+                            random.next(arena.height)});
+        if (random.next(FUZZ_FIRE_CHANCE) == 0) tank->fire();
+      }
+      shots += stage->live_bullets.size() - before;
+
+      stepSimulation(stage);
+      Stage::renderer.discard();
+      checkFrame(stage, failures);
+      frames++;
+
+      if (stage->active_tanks.size() <= 1) break;
+    }
+    delete stage;
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// MAIN
+//
+//---------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  FuzzOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      options.shots = atol(argv[++i]);
+    } else if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+      options.arenas = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      options.frames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      options.seed = strtoul(argv[++i], nullptr, 10);
+    } else {
+      fprintf(stderr, "Usage: collisionfuzz [-n shots] [-a arenas] "
+                      "[-f frames] [-s seed]\n");
+      return 1;
+    }
+  }
+  if (options.shots < 0 || options.arenas < 0 || options.frames < 1) {
+    fprintf(stderr, "collisionfuzz: needs 0 or more shots and arenas, and "
+                    "a frame or more\n");
+    return 1;
+  }
+
+  FuzzFailures failures;
+  long hits = fuzzSweeps(options, failures);
+  printf("sweeps   %ld shots, %ld hit: %ld missed, %ld phantom, %ld toi "
+         "off\n",
+         options.shots, hits, failures.missed, failures.phantom,
+         failures.toi_off);
+
+  long shots = 0, frames = 0;
+  fuzzStages(options, failures, shots, frames);
+  printf("stages   %d arenas, %ld frames, %ld shots: %ld tunnelled\n",
+         options.arenas, frames, shots, failures.tunnelled);
+
+  if (failures.total() != 0) {
+    fprintf(stderr, "collisionfuzz: FAILED, %ld failures\n",
+            failures.total());
+    return 1;
+  }
+  return 0;
+}
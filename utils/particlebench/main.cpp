@@ -0,0 +1,192 @@
+/*---------------------------------------------------------------------------------
+
+main.cpp
+Camdyn Rasque
+
+The particle system benchmark, run on the host:
+
+  particlebench [-p particles] [-f frames] [-w warm-up frames]
+
+Keeps the pool topped up to -p live particles with bursts from every
+emitter the game has, then times ParticleSystem::update and drawing the
+particles through the draw list (queue, sort and flush) each frame. Fails
+if any frame after the warm-up allocates, or ran with fewer than -p
+particles, so it doubles as a check that the pool stays allocation free.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Stage.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Every emitter, thrown out in turn
+static const ParticleBurst *BURSTS[] = {
+    &PARTICLES_MUZZLE_FLASH, &PARTICLES_BULLET_TRAIL, &PARTICLES_RICOCHET,
+    &PARTICLES_BULLET_POP,   &PARTICLES_TANK_DEBRIS,  &PARTICLES_TANK_SMOKE,
+    &PARTICLES_MINE_BLAST,
+};
+static const int NUM_BURSTS = sizeof(BURSTS) / sizeof(BURSTS[0]);
+
+static long allocations = 0; // Every operator new, ever
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief What the command line asked for
+ */
+struct BenchOptions {
+  int particles = 1000;
+  int frames = 6000;
+  int warm_up = 120;
+};
+
+/**
+ * @brief Microseconds spent on one part of the frame
+ */
+struct BenchTiming {
+  double total = 0;
+  double worst = 0;
+
+  void add(double us) {
+    total += us;
+    if (us > worst) worst = us;
+  }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+void *operator new(size_t size) {
+  allocations++;
+  void *memory = malloc(size ? size : 1);
+  if (memory == nullptr) abort();
+  return memory;
+}
+
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+
+/**
+ * @brief Microseconds since some fixed point
+ */
+static double nowMicros() {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+//---------------------------------------------------------------------------------
+//
+// MAIN
+//
+//---------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+      options.particles = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      options.frames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+      options.warm_up = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: particlebench [-p particles] [-f frames] "
+                      "[-w warm-up frames]\n");
+      return 1;
+    }
+  }
+  if (options.particles < 1 || options.particles > PARTICLE_CAPACITY ||
+      options.frames < 1 || options.warm_up < 0) {
+    fprintf(stderr, "particlebench: needs 1 to %d particles and a frame or "
+                    "more\n",
+            PARTICLE_CAPACITY);
+    return 1;
+  }
+
+  ParticleSystem &particles = Stage::particles;
+  DrawList &list = Stage::draw_list;
+  BenchTiming update;
+  BenchTiming draw;
+  long live = 0;
+  int starved = 0; // Frames run with fewer than asked for
+  int switches = 0;
+  long allocated = 0;
+  long startup = allocations; // The draw list's reserve, and the like
+  int next = 0;
+
+  for (int frame = 0; frame < options.warm_up + options.frames; frame++) {
+    bool counted = frame >= options.warm_up;
+    long before = allocations;
+
+    // Top the pool up, spread over the screen like a busy stage would be
+    for (int tries = 0;
+         particles.liveCount() < options.particles && tries < 64; tries++) {
+      const ParticleBurst &burst = *BURSTS[next % NUM_BURSTS];
+      particles.emit(burst, 16 + next * 37 % (SCREEN_WIDTH - 32),
+                     16 + next * 53 % (SCREEN_HEIGHT - 32), next * 4099);
+      next++;
+    }
+
+    if (counted) {
+      live += particles.liveCount();
+      if (particles.liveCount() < options.particles) starved++;
+    }
+
+    double start = nowMicros();
+    particles.update();
+    double updated = nowMicros();
+    particles.draw(list);
+    list.flush();
+    double drawn = nowMicros();
+
+    if (counted) {
+      update.add(updated - start);
+      draw.add(drawn - updated);
+      switches += list.state_switches;
+      allocated += allocations - before;
+    }
+  }
+
+  printf("particlebench: %d frames at %d+ particles (%d warm-up)\n\n",
+         options.frames, options.particles, options.warm_up);
+  printf("live          %.1f a frame, %d dropped\n",
+         (double)live / options.frames, particles.dropped);
+  printf("update        mean %.2f us  worst %.2f us\n",
+         update.total / options.frames, update.worst);
+  printf("draw + flush  mean %.2f us  worst %.2f us, %.1f state switches\n",
+         draw.total / options.frames, draw.worst,
+         (double)switches / options.frames);
+  printf("allocations   %ld after warm-up, %ld before\n", allocated,
+         startup);
+
+  if (allocated != 0 || starved != 0) {
+    fprintf(stderr,
+            "particlebench: FAILED, %ld allocations, %d frames short of %d "
+            "particles\n",
+            allocated, starved, options.particles);
+    return 1;
+  }
+  return 0;
+}
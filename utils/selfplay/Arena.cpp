@@ -0,0 +1,46 @@
+/*---------------------------------------------------------------------------------
+
+Arena.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Arena.h"
+#include "Barriers.h"
+#include "StageGenerator.h"
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool generateArena(int width, int height, int enemies, TankColor hardest,
+                   uint32_t seed, Arena &arena) {
+  StageOptions options;
+  options.width = width;
+  options.height = height;
+  options.enemies = enemies;
+  options.hardest = hardest;
+
+  GeneratedStage stage;
+  bool generated = generateStage(options, seed, stage);
+  arena.attempts = stage.attempts;
+  if (!generated) return false;
+
+  BarrierGrid grid = toBarrierGrid(stage);
+  arena.width = stage.width;
+  arena.height = stage.height;
+  arena.barriers = packBarriers(grid);
+  arena.walls = packWalls(grid);
+  arena.spawns.clear();
+  for (const GeneratedSpawn &spawn : stage.spawns) {
+    arena.spawns.push_back({spawn.x, spawn.y, spawn.color, spawn.direction});
+  }
+  return true;
+}
@@ -0,0 +1,53 @@
+#ifndef SELFPLAY_ARENA_H
+#define SELFPLAY_ARENA_H
+
+#include "TankArchetype.h"
+#include <cstdint>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief A tank's spawn, the same as a TankSpawn in source/Tank.h
+ */
+struct ArenaSpawn {
+  int x; // Top left, in pixels
+  int y;
+  TankColor color;
+  int direction; // A TankDirection
+};
+
+/**
+ * @brief A generated stage packed the way the game loads one. Kept apart
+ *        from utils/stagegen, whose assetc headers share names with the
+ *        game's.
+ */
+struct Arena {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> barriers; // packBarriers, 4 pixels a byte
+  std::vector<uint8_t> walls;    // packWalls, the wall face table
+  std::vector<ArenaSpawn> spawns; // The player first
+  int attempts = 0;               // Layouts stagegen tried
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Generates and packs a stage with utils/stagegen. The same
+ *        arguments always give the same arena.
+ * @param hardest Enemies are brown up to this color
+ * @return False if stagegen found no valid layout for the seed
+ */
+bool generateArena(int width, int height, int enemies, TankColor hardest,
+                   uint32_t seed, Arena &arena);
+
+#endif // SELFPLAY_ARENA_H
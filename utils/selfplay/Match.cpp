@@ -0,0 +1,557 @@
+/*---------------------------------------------------------------------------------
+
+Match.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Match.h"
+#include "Arena.h"
+#include "Rewind.h"
+#include "Simulation.h"
+#include "Stage.h"
+#include "Tank.h"
+#include <sstream>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int BOT_REACTION_FRAMES = 20; // Least frames between the bot's shots
+const int BOT_REACTION_JITTER = 20; // Up to this many more, from the seed
+const int BOT_REPLAN_FRAMES = 30;   // Frames between finding a new route
+const int BOT_STUCK_FRAMES = 20;    // Not moving this long, it wanders
+const int BOT_WANDER_FRAMES = 30;
+const int BOT_SHOT_HALF_WIDTH = 3;  // Half a bullet, see Bullet::width
+
+// Shifts every burst down to nothing, the particles are only for show
+const int NO_PARTICLES = 16;
+
+// FNV-1a, to compare a restored state with the live one without keeping it
+const uint64_t STATE_HASH_BASIS = 14695981039346656037ull;
+const uint64_t STATE_HASH_PRIME = 1099511628211ull;
+
+// Compass directions by the sign of a step, [dy + 1][dx + 1]
+static const TankDirection STEP_DIRECTIONS[3][3] = {
+    {T_DIR_NW, T_DIR_N, T_DIR_NE},
+    {T_DIR_W, T_DIR_N, T_DIR_E},
+    {T_DIR_SW, T_DIR_S, T_DIR_SE},
+};
+
+/**
+ * @brief A variant field's names for its values, or none for a number
+ */
+struct VariantField {
+  const char *field;
+  int ArchetypeVariant::*member;
+  std::vector<const char *> names; // Indexed by value
+};
+
+static const VariantField VARIANT_FIELDS[] = {
+    {"movement",
+     &ArchetypeVariant::movement,
+     {"normal", "stationary", "slow", "fast"}},
+    {"speed", &ArchetypeVariant::bullet_speed, {"", "", "normal", "fast"}},
+    {"cooldown",
+     &ArchetypeVariant::fire_rate_cooldown,
+     {"", "slow", "fast"}},
+    {"ricochets", &ArchetypeVariant::max_bullet_ricochets, {}},
+    {"bullets", &ArchetypeVariant::max_bullets, {}},
+    {"behavior",
+     &ArchetypeVariant::behavior,
+     {"", "passive", "defensive", "incautious", "offensive", "active",
+      "dynamic"}},
+    {"mines", &ArchetypeVariant::max_mines, {}},
+};
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * Plays the player's tank the way someone holding the DS might: shoot at
+ * the nearest enemy it can see, otherwise drive there cell by cell along
+ * the shortest route the barriers leave. How quickly it shoots again is
+ * jittered from the match's seed, so matches on the same stage still
+ * differ.
+ */
+class PlayerBot {
+private:
+  Stage *stage;
+  Tank *player;
+  uint32_t random_state;
+  std::vector<int> distance; // Cells from the target, -1 where tanks can't
+  Tank *route_target = nullptr;
+  int replan_frame = 0;
+  int next_shot = 0;
+  int waypoint_col = -1; // The cell being driven to
+  int waypoint_row = -1;
+  Position last_pos = {-1, -1};
+  int still_frames = 0;
+  int wander_frames = 0;
+  TankDirection wander_direction = T_DIR_N;
+
+  int random(int range) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return (int)(random_state % (uint32_t)range);
+  }
+
+  bool open(int col, int row) {
+    Terrain &terrain = stage->terrain;
+    return col >= 0 && row >= 0 && col < terrain.getCols() &&
+           row < terrain.getRows() &&
+           terrain.cellAt(col, row) == BARRIER_EMPTY;
+  }
+
+  /**
+   * @brief Whether a bullet fits the whole way, not just its center. A
+   *        line grazing a corner is clear, but the bullet clips it.
+   */
+  bool clearShot(Position from, Position to) {
+    for (int dy = -BOT_SHOT_HALF_WIDTH; dy <= BOT_SHOT_HALF_WIDTH;
+         dy += 2 * BOT_SHOT_HALF_WIDTH) {
+      for (int dx = -BOT_SHOT_HALF_WIDTH; dx <= BOT_SHOT_HALF_WIDTH;
+           dx += 2 * BOT_SHOT_HALF_WIDTH) {
+        if (!stage->walls.hasLineOfSight({from.x + dx, from.y + dy},
+                                         {to.x + dx, to.y + dy})) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Breadth first from the target's cell over the open cells
+   */
+  void plan(Tank *target) {
+    Terrain &terrain = stage->terrain;
+    int cols = terrain.getCols();
+    distance.assign(cols * terrain.getRows(), -1);
+    int col = (target->getPosition('x') + TANK_SIZE / 2) / GRID_CELL_SIZE;
+    int row = (target->getPosition('y') + TANK_SIZE / 2) / GRID_CELL_SIZE;
+
+    std::vector<int> queue = {row * cols + col};
+    distance[queue[0]] = 0;
+    for (size_t i = 0; i < queue.size(); i++) {
+      int cell = queue[i];
+      static const int STEPS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+      for (const int *step : STEPS) {
+        int c = cell % cols + step[0], r = cell / cols + step[1];
+        if (!open(c, r) || distance[r * cols + c] >= 0) continue;
+        distance[r * cols + c] = distance[cell] + 1;
+        queue.push_back(r * cols + c);
+      }
+    }
+    route_target = target;
+  }
+
+  /**
+   * @brief The neighbour of the waypoint closer to the target, diagonals
+   *        only where both cells beside them are open too
+   */
+  void nextWaypoint() {
+    int cols = stage->terrain.getCols();
+    int best = distance[waypoint_row * cols + waypoint_col];
+    int bestCol = waypoint_col, bestRow = waypoint_row;
+    for (int dy = -1; dy <= 1; dy++) {
+      for (int dx = -1; dx <= 1; dx++) {
+        int c = waypoint_col + dx, r = waypoint_row + dy;
+        if (!open(c, r) || distance[r * cols + c] < 0) continue;
+        if (dx != 0 && dy != 0 &&
+            (!open(waypoint_col + dx, waypoint_row) ||
+             !open(waypoint_col, waypoint_row + dy))) {
+          continue;
+        }
+        if (best < 0 || distance[r * cols + c] < best) {
+          best = distance[r * cols + c];
+          bestCol = c;
+          bestRow = r;
+        }
+      }
+    }
+    waypoint_col = bestCol;
+    waypoint_row = bestRow;
+  }
+
+  /**
+   * @brief Drives a step along the route to the target
+   */
+  void drive(Tank *target) {
+    Position pos = player->getPosition();
+    if (pos.x == last_pos.x && pos.y == last_pos.y) still_frames++;
+    else still_frames = 0;
+    last_pos = pos;
+
+    // Caught on a corner or another tank, try somewhere else for a bit
+    if (still_frames > BOT_STUCK_FRAMES) {
+      wander_frames = BOT_WANDER_FRAMES;
+      wander_direction = STEP_DIRECTIONS[random(3)][random(3)];
+      still_frames = 0;
+      waypoint_col = -1;
+    }
+    if (wander_frames > 0) {
+      wander_frames--;
+      player->move(wander_direction);
+      return;
+    }
+
+    if (target != route_target || Stage::frame_counter >= replan_frame) {
+      plan(target);
+      replan_frame = Stage::frame_counter + BOT_REPLAN_FRAMES;
+      waypoint_col = -1;
+    }
+    if (waypoint_col < 0) {
+      waypoint_col = (pos.x + TANK_SIZE / 2) / GRID_CELL_SIZE;
+      waypoint_row = (pos.y + TANK_SIZE / 2) / GRID_CELL_SIZE;
+    }
+
+    // On the waypoint's cell exactly, so the next one can be any way
+    int dx = waypoint_col * GRID_CELL_SIZE - pos.x;
+    int dy = waypoint_row * GRID_CELL_SIZE - pos.y;
+    if (dx == 0 && dy == 0) {
+      nextWaypoint();
+      dx = waypoint_col * GRID_CELL_SIZE - pos.x;
+      dy = waypoint_row * GRID_CELL_SIZE - pos.y;
+      if (dx == 0 && dy == 0) return; // There, or nowhere to go
+    }
+    player->move(STEP_DIRECTIONS[(dy > 0) - (dy < 0) + 1]
+                                [(dx > 0) - (dx < 0) + 1]);
+  }
+
+public:
+  int shots = 0;
+
+  PlayerBot(Stage *stage, uint32_t seed)
+      : stage(stage), player(stage->tanks->at(0)),
+        random_state(seed * 2654435761u | 1) {}
+
+  /**
+   * @brief Plays the player's input for a frame
+   */
+  void update() {
+    if (!player->alive) return;
+    Position center = player->getPosition();
+    center.x += TANK_SIZE / 2;
+    center.y += TANK_SIZE / 2;
+
+    // The nearest enemy, and the nearest with a clear shot
+    Tank *nearest = nullptr, *visible = nullptr;
+    int nearestDist = 0, visibleDist = 0;
+    Position visibleCenter = center;
+    for (Tank *tank : stage->active_tanks) {
+      if (tank == player) continue;
+      Position other = tank->getPosition();
+      other.x += TANK_SIZE / 2;
+      other.y += TANK_SIZE / 2;
+      int dx = other.x - center.x, dy = other.y - center.y;
+      int dist = dx * dx + dy * dy;
+      if (nearest == nullptr || dist < nearestDist) {
+        nearest = tank;
+        nearestDist = dist;
+      }
+      if ((visible == nullptr || dist < visibleDist) &&
+          clearShot(center, other)) {
+        visible = tank;
+        visibleDist = dist;
+        visibleCenter = other;
+      }
+    }
+    if (nearest == nullptr) return;
+
+    if (visible != nullptr) {
+      player->rotateTurret(visibleCenter);
+      if (Stage::frame_counter >= next_shot) {
+        int before = stage->live_bullets.size();
+        player->fire();
+        if (stage->live_bullets.size() > before) shots++;
+        next_shot = Stage::frame_counter + BOT_REACTION_FRAMES +
+                    random(BOT_REACTION_JITTER + 1);
+      }
+      return;
+    }
+
+    Position target = nearest->getPosition();
+    player->rotateTurret(
+        {target.x + TANK_SIZE / 2, target.y + TANK_SIZE / 2});
+    drive(nearest);
+  }
+};
+
+/**
+ * @brief The stage stagegen lays out for a match, and the arena and
+ *        archetypes it plays on, which have to outlive it
+ */
+struct MatchStage {
+  Arena arena;
+  std::vector<TankSpawn> spawns;
+  std::vector<TankArchetype> archetypes;
+  Stage *stage = nullptr;
+
+  ~MatchStage() { delete stage; }
+
+  /**
+   * @brief Lays out the seed's arena and puts a stage on it
+   * @return False if stagegen found no layout for the seed
+   */
+  bool start(const MatchSetup &setup) {
+    if (!generateArena(setup.width, setup.height, setup.enemies,
+                       setup.hardest, setup.seed, arena)) {
+      return false;
+    }
+
+    // Once a thread, before its first sprite
+    if (Stage::sprite_gfx.atlasTiles() == nullptr) {
+      Stage::sprite_gfx.loadAtlas();
+    }
+    Stage::particles.burst_shift = NO_PARTICLES;
+    Stage::frame_counter = 0;
+    Stage::timers.rewind();
+
+    // The player plays as its color does, the variant is for the enemies
+    for (const ArenaSpawn &spawn : arena.spawns) {
+      spawns.push_back(
+          {spawn.x, spawn.y, spawn.color, (TankDirection)spawn.direction});
+      const TankArchetype &own = getTankArchetype(spawn.color);
+      archetypes.push_back(spawns.size() == 1 || setup.archetypes == nullptr
+                               ? own
+                               : setup.archetypes->apply(own));
+    }
+    StageLayout layout = {arena.width,
+                          arena.height,
+                          arena.barriers.data(),
+                          nullptr,
+                          (const short *)arena.walls.data(),
+                          spawns.data(),
+                          (int)spawns.size(),
+                          archetypes.data()};
+    stage = new Stage(layout);
+    return true;
+  }
+};
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+TankArchetype ArchetypeVariant::apply(const TankArchetype &archetype) const {
+  TankArchetype changed = archetype;
+  if (movement >= 0) changed.movement = (TankMovement)movement;
+  if (bullet_speed >= 0) changed.bullet_speed = (BulletSpeed)bullet_speed;
+  if (fire_rate_cooldown >= 0) {
+    changed.fire_rate_cooldown = (TankFireRateCooldown)fire_rate_cooldown;
+  }
+  if (max_bullet_ricochets >= 0) {
+    changed.max_bullet_ricochets = max_bullet_ricochets;
+  }
+  if (max_bullets >= 0) changed.max_bullets = max_bullets;
+  if (behavior >= 0) changed.behavior = (TankBehavior)behavior;
+  if (max_mines >= 0) changed.max_mines = max_mines;
+  return changed;
+}
+
+void FrameCosts::add(FrameProfiler &profiler) {
+  uint32_t ticks = profiler.lastTicks(PROFILE_FRAME);
+  uint32_t bucket = ticks / COST_BUCKET_TICKS;
+  buckets[bucket < (uint32_t)COST_BUCKETS ? bucket : COST_BUCKETS]++;
+  frames++;
+  this->ticks += ticks;
+  if (ticks > worst) worst = ticks;
+  for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+    section_ticks[i] += profiler.lastTicks((ProfileSection)i);
+  }
+}
+
+void FrameCosts::merge(const FrameCosts &other) {
+  for (int i = 0; i <= COST_BUCKETS; i++) buckets[i] += other.buckets[i];
+  frames += other.frames;
+  ticks += other.ticks;
+  if (other.worst > worst) worst = other.worst;
+  for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+    section_ticks[i] += other.section_ticks[i];
+  }
+}
+
+uint32_t FrameCosts::percentile(double fraction) const {
+  uint64_t wanted = (uint64_t)(fraction * frames);
+  uint64_t seen = 0;
+  for (int i = 0; i < COST_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen > wanted) return (i + 1) * COST_BUCKET_TICKS;
+  }
+  return worst;
+}
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool parseVariant(const std::string &text, ArchetypeVariant &variant,
+                  std::string &error) {
+  variant = ArchetypeVariant();
+  variant.name = text;
+  if (text == "base") return true; // Every color as it is
+
+  std::stringstream fields(text);
+  std::string field;
+  while (std::getline(fields, field, ',')) {
+    size_t equals = field.find('=');
+    if (equals == std::string::npos) {
+      error = "\"" + field + "\" isn't field=value";
+      return false;
+    }
+    std::string key = field.substr(0, equals);
+    std::string value = field.substr(equals + 1);
+
+    const VariantField *known = nullptr;
+    for (const VariantField &candidate : VARIANT_FIELDS) {
+      if (key == candidate.field) known = &candidate;
+    }
+    if (known == nullptr) {
+      error = "no field \"" + key + "\"";
+      return false;
+    }
+
+    int number = -1;
+    if (known->names.empty()) {
+      char *end;
+      long parsed = strtol(value.c_str(), &end, 10);
+      if (!value.empty() && *end == '\0' && parsed >= 0) number = parsed;
+    } else {
+      for (size_t i = 0; i < known->names.size(); i++) {
+        if (value == known->names[i] && value != "") number = i;
+      }
+    }
+    if (number < 0) {
+      error = "\"" + value + "\" isn't a " + key;
+      return false;
+    }
+    variant.*(known->member) = number;
+  }
+  return true;
+}
+
+void playMatch(const MatchSetup &setup, MatchResult &result,
+               FrameCosts &costs) {
+  result = MatchResult();
+  result.seed = setup.seed;
+  result.variant = setup.variant;
+
+  MatchStage match;
+  if (!match.start(setup)) return;
+  Stage *stage = match.stage;
+  PlayerBot bot(stage, setup.seed);
+  Tank *player = stage->tanks->at(0);
+  result.enemies = stage->num_tanks - 1;
+  result.outcome = MATCH_DRAW;
+
+  for (int frame = 0; frame < setup.max_frames; frame++) {
+    // The same frame as the game's, less the drawing
+    Stage::profiler.beginFrame();
+    Stage::profiler.begin(PROFILE_INPUT);
+    bot.update();
+    Stage::profiler.end(PROFILE_INPUT);
+    stepSimulation(stage);
+    Stage::renderer.discard();
+    Stage::profiler.endFrame();
+
+    costs.add(Stage::profiler);
+    result.ticks += Stage::profiler.lastTicks(PROFILE_FRAME);
+    result.frames++;
+
+    int alive = stage->active_tanks.size();
+    if (!player->alive) {
+      result.outcome = MATCH_ENEMIES_WON;
+      break;
+    }
+    if (alive == 1) {
+      result.outcome = MATCH_PLAYER_WON;
+      break;
+    }
+  }
+
+  result.enemies_left = stage->active_tanks.size() - (player->alive ? 1 : 0);
+  result.player_shots = bot.shots;
+}
+
+void replayMatch(const MatchSetup &setup, int frame, ReplayResult &result) {
+  result = ReplayResult();
+  MatchStage match;
+  if (!match.start(setup)) return;
+  Stage *stage = match.stage;
+  PlayerBot bot(stage, setup.seed);
+  Tank *player = stage->tanks->at(0);
+  Rewind rewind(stage);
+  result.outcome = MATCH_DRAW;
+
+  // Recorded as main.cpp's debug loop does, after the frame has settled
+  std::vector<u8> state(stage->stateSize());
+  std::vector<uint64_t> live; // By frame counter
+  auto hashState = [&]() {
+    stage->saveState(state.data());
+    uint64_t hash = STATE_HASH_BASIS;
+    for (u8 byte : state) hash = (hash ^ byte) * STATE_HASH_PRIME;
+    return hash;
+  };
+
+  int stop = frame + REWIND_MAX_FRAMES / 2;
+  if (stop > setup.max_frames) stop = setup.max_frames;
+  while (result.frames < stop) {
+    bot.update();
+    stepSimulation(stage);
+    Stage::renderer.discard();
+    rewind.record();
+    live.resize(Stage::frame_counter + 1);
+    live[Stage::frame_counter] = hashState();
+    result.frames++;
+
+    if (!player->alive) {
+      result.outcome = MATCH_ENEMIES_WON;
+      break;
+    }
+    if (stage->active_tanks.size() == 1) {
+      result.outcome = MATCH_PLAYER_WON;
+      break;
+    }
+  }
+  result.oldest = rewind.oldestFrame();
+  result.newest = rewind.newestFrame();
+  result.bytes = rewind.bytesUsed();
+
+  // Every frame held, back then forward, against what was played
+  auto check = [&]() {
+    result.restored++;
+    int restored = rewind.currentFrame();
+    if (hashState() == live[restored]) return;
+    if (result.mismatches++ == 0) result.first_mismatch = restored;
+  };
+  rewind.seek(result.newest);
+  check();
+  while (rewind.stepBack()) check();
+  while (rewind.stepForward()) check();
+
+  if (!rewind.seek(frame)) return;
+  check();
+  result.shown = frame;
+  for (int i = 0; i < stage->num_tanks; i++) {
+    Tank *tank = stage->tanks->at(i);
+    Position pos = tank->getPosition();
+    result.tanks.push_back({tank->color, pos.x, pos.y, tank->alive});
+  }
+  result.bullets = stage->live_bullets.size();
+}
@@ -0,0 +1,172 @@
+#ifndef SELFPLAY_MATCH_H
+#define SELFPLAY_MATCH_H
+
+#include "FrameProfiler.h"
+#include "TankArchetype.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int MATCH_MAX_FRAMES = 60 * 120; // Two minutes, then it's a draw
+const int COST_BUCKET_TICKS = 8;       // Histogram resolution, about 0.25 us
+const int COST_BUCKETS = 8192;         // Up to about 2 ms, then one bucket
+
+enum MatchOutcome {
+  MATCH_PLAYER_WON,  // Every enemy destroyed
+  MATCH_ENEMIES_WON, // The player destroyed
+  MATCH_DRAW,        // Both still there at the frame limit
+  MATCH_NO_STAGE,    // stagegen found no layout for the seed
+  MATCH_OUTCOME_COUNT
+};
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Changes to play every enemy's archetype with, eg. "ricochets=2,
+ *        cooldown=fast". Fields not given keep the color's own.
+ */
+struct ArchetypeVariant {
+  std::string name; // As given, for the report
+  int movement = -1;
+  int bullet_speed = -1;
+  int fire_rate_cooldown = -1;
+  int max_bullet_ricochets = -1;
+  int max_bullets = -1;
+  int behavior = -1;
+  int max_mines = -1;
+
+  /**
+   * @brief An archetype with this variant's fields swapped in
+   */
+  TankArchetype apply(const TankArchetype &archetype) const;
+};
+
+/**
+ * @brief One match to play. The seed picks the stage, and jitters the
+ *        player bot's reactions.
+ */
+struct MatchSetup {
+  uint32_t seed;
+  int variant; // Index into the batch's variants
+  int width;   // The arena stagegen lays out
+  int height;
+  int enemies;
+  TankColor hardest;
+  const ArchetypeVariant *archetypes; // Applied to every enemy
+  int max_frames = MATCH_MAX_FRAMES;
+};
+
+/**
+ * @brief How a match went
+ */
+struct MatchResult {
+  uint32_t seed = 0;
+  int variant = 0;
+  MatchOutcome outcome = MATCH_NO_STAGE;
+  int frames = 0;        // Simulated until it was decided
+  int enemies = 0;       // On the stage at the start
+  int enemies_left = 0;  // Still alive at the end
+  int player_shots = 0;  // Bullets the bot fired
+  uint64_t ticks = 0;    // Simulating it, in FrameProfiler ticks
+};
+
+/**
+ * @brief A tank as the replayed frame has it
+ */
+struct ReplayTank {
+  TankColor color;
+  int x;
+  int y;
+  bool alive;
+};
+
+/**
+ * @brief What scrubbing a recorded match found
+ */
+struct ReplayResult {
+  MatchOutcome outcome = MATCH_NO_STAGE;
+  int frames = 0;          // Played before scrubbing
+  int oldest = 0;          // The frames the rewind buffer still held
+  int newest = 0;
+  int bytes = 0;           // Of its byte ring in use
+  int shown = -1;          // The frame seeked to, -1 if it wasn't held
+  int restored = 0;        // Frames restored stepping back and forward
+  int mismatches = 0;      // Restored unlike the live frame
+  int first_mismatch = -1; // The frame counter of the first
+  std::vector<ReplayTank> tanks; // On the frame seeked to
+  int bullets = 0;
+};
+
+/**
+ * @brief Every frame's cost, as a histogram so the percentiles can be
+ *        merged across workers, and each profiled section's total
+ */
+struct FrameCosts {
+  std::vector<uint32_t> buckets = std::vector<uint32_t>(COST_BUCKETS + 1);
+  uint64_t frames = 0;
+  uint64_t ticks = 0;
+  uint32_t worst = 0;
+  uint64_t section_ticks[PROFILE_SECTION_COUNT] = {};
+
+  /**
+   * @brief Counts the frame FrameProfiler just ended
+   */
+  void add(FrameProfiler &profiler);
+
+  void merge(const FrameCosts &other);
+
+  /**
+   * @brief The frame cost a fraction (0 to 1) of frames came in under, in
+   *        FrameProfiler ticks
+   */
+  uint32_t percentile(double fraction) const;
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Reads a variant from "field=value,...". Fields are movement
+ *        (normal, stationary, slow, fast), speed (normal, fast), cooldown
+ *        (slow, fast), ricochets, bullets, behavior (passive, defensive,
+ *        incautious, offensive, active, dynamic) and mines. "base"
+ *        changes nothing, to compare the others against.
+ * @param error Set to what's wrong if it returns false
+ */
+bool parseVariant(const std::string &text, ArchetypeVariant &variant,
+                  std::string &error);
+
+/**
+ * @brief Plays a match to the end on the calling thread, with a bot for the
+ *        player. The game's statics are the thread's own (see
+ *        source/PerThread.h), so matches on other threads don't interfere.
+ * @param costs The thread's frame costs, added to
+ */
+void playMatch(const MatchSetup &setup, MatchResult &result,
+               FrameCosts &costs);
+
+/**
+ * @brief Plays a match as playMatch does, recording every frame into a
+ *        Rewind like the DS debug build, until the frame asked for is in
+ *        the middle of what it holds (or the match is decided). Then seeks
+ *        to that frame, and steps back to the oldest frame held and forward
+ *        to the newest, checking each state restored against the state the
+ *        live match had on that frame. Ends back on the frame asked for.
+ * @param frame The Stage::frame_counter value to scrub to
+ */
+void replayMatch(const MatchSetup &setup, int frame, ReplayResult &result);
+
+#endif // SELFPLAY_MATCH_H
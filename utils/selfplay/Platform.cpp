@@ -0,0 +1,233 @@
+/*---------------------------------------------------------------------------------
+
+Platform.cpp
+Camdyn Rasque
+
+The libnds calls the game's simulation makes, for the host (see
+platform/nds.h). Every match runs on a worker thread of its own, so like the
+game's statics the VRAM, OAM and palettes here are one copy per thread.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include <chrono>
+#include <gl2d.h>
+#include <nds.h>
+#include <string.h>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+static const int BG_LAYERS = 8;              // Main 0 to 3, sub 4 to 7
+static const int BG_MAP_ENTRIES = 64 * 64;   // The biggest text map
+static const int BG_GFX_BYTES = 128 * 1024;  // A whole bank
+static const u32 LZ77_TYPE = 0x10;           // The BIOS's header byte
+
+thread_local OamState oamMain;
+thread_local OamState oamSub;
+thread_local u16 BG_PALETTE[256];
+thread_local u16 BG_PALETTE_SUB[256];
+thread_local u16 SPRITE_PALETTE[256];
+thread_local u16 SPRITE_PALETTE_SUB[256];
+thread_local vu16 REG_BG0CNT;
+
+// Made the first time a layer is asked for, most matches never draw one
+static thread_local std::vector<u16> bg_maps[BG_LAYERS];
+static thread_local std::vector<u16> bg_gfx[BG_LAYERS];
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief The bytes of a sprite's tiles
+ */
+static int spriteBytes(SpriteSize size, SpriteColorFormat format) {
+  static const int PIXELS[] = {64,  256, 1024, 4096, 128, 256,
+                               512, 2048, 128,  256,  512, 2048};
+  int pixels = PIXELS[size];
+  return format == SpriteColorFormat_16Color ? pixels / 2
+         : format == SpriteColorFormat_Bmp   ? pixels * 2
+                                             : pixels;
+}
+
+//---------------------------------------------------------------------------------
+//
+// SPRITES
+//
+//---------------------------------------------------------------------------------
+
+void oamInit(OamState *, SpriteMapping, bool) {}
+
+u16 *oamAllocateGfx(OamState *, SpriteSize size, SpriteColorFormat format) {
+  return (u16 *)calloc(1, spriteBytes(size, format));
+}
+
+void oamFreeGfx(OamState *, const void *gfx) { free((void *)gfx); }
+
+void oamSet(OamState *, int, int, int, int, int, SpriteSize,
+            SpriteColorFormat, const void *, int, bool, bool, bool, bool,
+            bool) {}
+
+void oamRotateScale(OamState *, int, int, int, int) {}
+void oamSetHidden(OamState *, int, bool) {}
+void oamClearSprite(OamState *, int) {}
+void oamClear(OamState *, int, int) {}
+void oamUpdate(OamState *) {}
+
+//---------------------------------------------------------------------------------
+//
+// BACKGROUNDS
+//
+//---------------------------------------------------------------------------------
+
+int bgInit(int layer, BgType, BgSize, int, int) { return layer; }
+int bgInitSub(int layer, BgType, BgSize, int, int) { return layer + 4; }
+void bgSetPriority(int, int) {}
+void bgSetScroll(int, int, int) {}
+void bgUpdate() {}
+
+u16 *bgGetGfxPtr(int id) {
+  std::vector<u16> &gfx = bg_gfx[id];
+  if (gfx.empty()) gfx.resize(BG_GFX_BYTES / 2);
+  return gfx.data();
+}
+
+u16 *bgGetMapPtr(int id) {
+  std::vector<u16> &map = bg_maps[id];
+  if (map.empty()) map.resize(BG_MAP_ENTRIES);
+  return map.data();
+}
+
+//---------------------------------------------------------------------------------
+//
+// VIDEO AND MEMORY
+//
+//---------------------------------------------------------------------------------
+
+void videoSetMode(u32) {}
+void videoSetModeSub(u32) {}
+void vramSetBankA(int) {}
+void vramSetBankB(int) {}
+void vramSetBankC(int) {}
+void vramSetBankD(int) {}
+void vramSetBankE(int) {}
+void vramSetBankI(int) {}
+
+void dmaCopy(const void *source, void *dest, u32 size) {
+  memcpy(dest, source, size);
+}
+
+void dmaFillHalfWords(u16 value, void *dest, u32 size) {
+  u16 *halfwords = (u16 *)dest;
+  for (u32 i = 0; i < size / 2; i++) halfwords[i] = value;
+}
+
+void DC_FlushRange(const void *, u32) {}
+
+void decompress(const void *data, void *dst, int) {
+  // The BIOS's LZ77: a flag byte then 8 blocks, each a literal byte or a
+  // 12 bit distance back and 4 bit length copied from what's unpacked
+  const u8 *in = (const u8 *)data;
+  u8 *out = (u8 *)dst;
+  u32 header = in[0] | in[1] << 8 | in[2] << 16 | (u32)in[3] << 24;
+  sassert((header & 0xff) == LZ77_TYPE, "Only LZ77 is unpacked");
+  u32 size = header >> 8, written = 0;
+  in += 4;
+
+  while (written < size) {
+    u8 flags = *in++;
+    for (int block = 0; block < 8 && written < size; block++, flags <<= 1) {
+      if (!(flags & 0x80)) {
+        out[written++] = *in++;
+        continue;
+      }
+      int length = (in[0] >> 4) + 3;
+      int distance = ((in[0] & 0xf) << 8 | in[1]) + 1;
+      in += 2;
+      for (int i = 0; i < length && written < size; i++, written++) {
+        out[written] = out[written - distance];
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// TIMING
+//
+//---------------------------------------------------------------------------------
+
+void cpuStartTiming(int) {}
+
+u32 cpuGetTiming() {
+  // The host's clock counted in the DS's bus cycles, so FrameProfiler's
+  // numbers read the same
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  long long ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+  return (u32)(u64)(ns * (BUS_CLOCK / 1e9));
+}
+
+void swiWaitForVBlank() {}
+bool pmMainLoop() { return true; }
+
+//---------------------------------------------------------------------------------
+//
+// INPUT AND CONSOLE
+//
+//---------------------------------------------------------------------------------
+
+void scanKeys() {}
+u32 keysHeld() { return 0; }
+u32 keysDown() { return 0; }
+u32 keysUp() { return 0; }
+void touchRead(touchPosition *touch) { memset(touch, 0, sizeof(*touch)); }
+
+PrintConsole *consoleInit(PrintConsole *, int, BgType, BgSize, int, int, bool,
+                          bool) {
+  return nullptr;
+}
+void consoleDemoInit() {}
+void consoleClear() {}
+
+//---------------------------------------------------------------------------------
+//
+// GL2D
+//
+//---------------------------------------------------------------------------------
+
+int glLoadSpriteSet(glImage *, unsigned int, const unsigned int *,
+                    GL_TEXTURE_TYPE_ENUM, int, int, int, int, const u16 *,
+                    const u8 *) {
+  return 0;
+}
+
+int glLoadTileSet(glImage *, int, int, int, int, GL_TEXTURE_TYPE_ENUM, int,
+                  int, int, int, const u16 *, const u8 *) {
+  return 0;
+}
+
+void glScreen2D() {}
+void glBegin2D() {}
+void glEnd2D() {}
+void glSprite(int, int, int, const glImage *) {}
+void glSpriteRotateScale(int, int, int, int, int, const glImage *) {}
+void glLine(int, int, int, int, int) {}
+void glBoxFilled(int, int, int, int, int) {}
+void glPolyFmt(u32) {}
+void glColor(u16) {}
+void glClearColor(u8, u8, u8, u8) {}
+void glClearPolyID(u8) {}
+void glFlush(u32) {}
+void glGetInt(int, int *i) { *i = 0; }
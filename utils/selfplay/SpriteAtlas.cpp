@@ -0,0 +1,74 @@
+/*---------------------------------------------------------------------------------
+
+SpriteAtlas.cpp
+Camdyn Rasque
+
+The blank sprite atlas the host builds against instead of the packed one
+(see platform/sprite-atlas.h), so the runner needs neither assetc nor the
+sprite sheet.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "sprite-atlas.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// Every frame shares the one tile
+#define BLANK_FRAME {0, SpriteSize_8x8, 8, 8, 0, 0, 0, 0, 0}
+
+// 64 zero bytes in the BIOS's LZ77: the header, then 8 blocks of literals
+const unsigned int sprite_atlasTiles[19] = {64 << 8 | 0x10};
+
+const unsigned short sprite_atlasPal[256] = {};
+
+const SpriteAtlasFrame sprite_atlasFrames[sprite_atlasFrameCount] = {
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+    BLANK_FRAME, BLANK_FRAME, BLANK_FRAME,
+};
+
+const SpriteAtlasAnim sprite_atlasAnims[SPRITE_ANIM_COUNT] = {
+    {0, 3}, // tank_body_blue
+    {3, 3}, // tank_body_red
+    {6, 3}, // tank_body_brown
+    {9, 3}, // tank_body_ash
+    {12, 3}, // tank_body_marine
+    {15, 3}, // tank_body_yellow
+    {18, 3}, // tank_body_pink
+    {21, 3}, // tank_body_green
+    {24, 3}, // tank_body_violet
+    {27, 3}, // tank_body_white
+    {30, 3}, // tank_body_black
+    {33, 1}, // tank_turret_blue
+    {34, 1}, // tank_turret_red
+    {35, 1}, // tank_turret_brown
+    {36, 1}, // tank_turret_ash
+    {37, 1}, // tank_turret_marine
+    {38, 1}, // tank_turret_yellow
+    {39, 1}, // tank_turret_pink
+    {40, 1}, // tank_turret_green
+    {41, 1}, // tank_turret_violet
+    {42, 1}, // tank_turret_white
+    {43, 1}, // tank_turret_black
+    {44, 1}, // cursor
+    {45, 1}, // cursor_tail
+    {46, 1}, // bullet
+};
@@ -0,0 +1,141 @@
+/*---------------------------------------------------------------------------------
+
+WorkStealingPool.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "WorkStealingPool.h"
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+static thread_local int current_worker = -1;
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief The workers to start for a thread count, 0 for the hardware's
+ */
+static int workerCount(int threads) {
+  if (threads > 0) return threads;
+  int hardware = (int)std::thread::hardware_concurrency();
+  return hardware > 0 ? hardware : 1;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PRIVATE STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool WorkStealingPool::take(int index, std::function<void()> &job) {
+  {
+    Worker &own = workers[index];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (!own.jobs.empty()) {
+      job = std::move(own.jobs.back());
+      own.jobs.pop_back();
+      return true;
+    }
+  }
+
+  // Starting from the next worker along, so thieves spread out
+  int count = (int)workers.size();
+  for (int i = 1; i < count; i++) {
+    Worker &victim = workers[(index + i) % count];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (victim.jobs.empty()) continue;
+    job = std::move(victim.jobs.front());
+    victim.jobs.pop_front();
+    workers[index].stolen++;
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::run(int index) {
+  current_worker = index;
+  std::function<void()> job;
+  while (true) {
+    if (take(index, job)) {
+      job();
+      job = nullptr;
+      workers[index].ran++;
+      if (--pending == 0) {
+        std::lock_guard<std::mutex> guard(idle_lock);
+        done.notify_all();
+      }
+      continue;
+    }
+
+    // Nothing anywhere. Checked again under the lock, so a job queued in
+    // between isn't slept through.
+    std::unique_lock<std::mutex> guard(idle_lock);
+    if (stopping) return;
+    idle.wait(guard, [&] {
+      if (stopping) return true;
+      for (Worker &worker : workers) {
+        std::lock_guard<std::mutex> queueGuard(worker.lock);
+        if (!worker.jobs.empty()) return true;
+      }
+      return false;
+    });
+    if (stopping) return;
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC STRUCT FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+WorkStealingPool::WorkStealingPool(int threads)
+    : workers(workerCount(threads)) {
+  for (int i = 0; i < (int)workers.size(); i++) {
+    this->threads.emplace_back(&WorkStealingPool::run, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  wait();
+  {
+    std::lock_guard<std::mutex> guard(idle_lock);
+    stopping = true;
+    idle.notify_all();
+  }
+  for (std::thread &thread : threads) thread.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> job) {
+  // A worker queuing more keeps them, it's likely to get to them first
+  int index = current_worker >= 0 ? current_worker : next_queue++;
+  Worker &worker = workers[index % workers.size()];
+  pending++;
+  {
+    std::lock_guard<std::mutex> guard(worker.lock);
+    worker.jobs.push_back(std::move(job));
+  }
+  std::lock_guard<std::mutex> guard(idle_lock);
+  idle.notify_one();
+}
+
+void WorkStealingPool::wait() {
+  std::unique_lock<std::mutex> guard(idle_lock);
+  done.wait(guard, [&] { return pending == 0; });
+}
+
+int WorkStealingPool::currentWorker() { return current_worker; }
@@ -0,0 +1,94 @@
+#ifndef SELFPLAY_WORK_STEALING_POOL_H
+#define SELFPLAY_WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * A fixed set of worker threads, each with its own queue of jobs. A worker
+ * takes its newest job first (the one most likely still in its cache), and
+ * when its queue runs dry steals the oldest job of another worker, so a
+ * worker that drew long matches doesn't hold the batch up while the rest
+ * sit idle. Jobs are whole matches, milliseconds each, so a lock a queue is
+ * all the synchronisation it takes.
+ */
+class WorkStealingPool {
+private:
+  /**
+   * @brief A worker's jobs, and what it has done
+   */
+  struct Worker {
+    std::mutex lock;
+    std::deque<std::function<void()>> jobs;
+    long ran = 0;    // Jobs run, its own and stolen
+    long stolen = 0; // Jobs taken from other workers
+  };
+
+  std::vector<Worker> workers;
+  std::vector<std::thread> threads;
+  std::mutex idle_lock;
+  std::condition_variable idle; // Signalled when a job is queued or all end
+  std::condition_variable done; // Signalled when the last job has run
+  std::atomic<long> pending{0}; // Queued or running
+  int next_queue = 0;           // Where submit puts the next job
+  bool stopping = false;
+
+  /**
+   * @brief A worker's loop: its own jobs, then other workers', then sleep
+   */
+  void run(int index);
+
+  /**
+   * @brief Takes a job, newest first from the worker's own queue, else the
+   *        oldest from the others' in turn
+   * @return False if every queue is empty
+   */
+  bool take(int index, std::function<void()> &job);
+
+public:
+  /**
+   * @param threads Workers to start, 0 for one a hardware thread
+   */
+  explicit WorkStealingPool(int threads);
+
+  /**
+   * @brief Waits for the jobs queued to run and stops the workers
+   */
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  /**
+   * @brief Queues a job, the workers' queues in turn. It may be run by any
+   *        worker, and may queue more.
+   */
+  void submit(std::function<void()> job);
+
+  /**
+   * @brief Blocks until every job queued has run
+   */
+  void wait();
+
+  int size() const { return (int)workers.size(); }
+  long ran(int worker) const { return workers[worker].ran; }
+  long stolen(int worker) const { return workers[worker].stolen; }
+
+  /**
+   * @brief The worker running the calling thread, -1 if it isn't one
+   */
+  static int currentWorker();
+};
+
+#endif // SELFPLAY_WORK_STEALING_POOL_H
@@ -0,0 +1,418 @@
+/*---------------------------------------------------------------------------------
+
+main.cpp
+Camdyn Rasque
+
+The headless self-play batch runner, run on the host:
+
+  selfplay [-n seeds] [-j threads] [-s first seed] [-w width] [-h height]
+           [-e enemies] [-c hardest color] [-f max frames]
+           [-v variant]... [-o results.csv] [-S] [-r frame]
+
+Plays every seed once under each variant (the enemies' archetypes changed,
+eg. -v ricochets=2,cooldown=fast, see parseVariant), on a stage stagegen
+lays out from the seed, with a bot for the player. Matches run on a
+work-stealing pool, one a worker at a time, through the game's own
+simulation (source/Simulation.cpp). Reports the win rates and match lengths
+for each variant, and what a frame cost. -o writes a line a match, -S plays
+the batch again on 1, 2, 4... threads up to -j to show how it scales.
+
+-r scrubs one match instead, the -s seed under the first variant. It plays
+recording into the game's Rewind buffer as the DS debug build does, then
+steps back and forward through every frame held checking each against the
+live match, and shows the tanks on the frame asked for.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Match.h"
+#include "Tank.h"
+#include "Terrain.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+static const char *OUTCOME_NAMES[MATCH_OUTCOME_COUNT] = {"player", "enemies",
+                                                         "draw", "no stage"};
+
+// The sections a headless frame has, the player bot standing in for input
+static const ProfileSection REPORTED_SECTIONS[] = {
+    PROFILE_INPUT, PROFILE_AI, PROFILE_BULLETS, PROFILE_COLLISION,
+    PROFILE_SPRITES};
+static const char *REPORTED_NAMES[] = {"bot", "ai", "bullets", "collision",
+                                       "sprites"};
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Everything the command line sets
+ */
+struct BatchOptions {
+  int seeds = 1000;
+  int threads = 0; // 0 for every hardware thread
+  uint32_t first_seed = 1;
+  int width = 256;
+  int height = 192;
+  int enemies = 3;
+  TankColor hardest = T_COLOR_BLACK;
+  int max_frames = MATCH_MAX_FRAMES;
+  std::vector<ArchetypeVariant> variants;
+  std::string csv;
+  bool scaling = false;
+  int replay_frame = -1; // Scrub to this frame of one match, -1 to batch
+};
+
+/**
+ * @brief What running the batch once gave
+ */
+struct BatchRun {
+  std::vector<MatchResult> results;
+  FrameCosts costs;
+  double seconds = 0;
+  int threads = 0;
+  std::vector<long> ran; // A worker
+  std::vector<long> stolen;
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+static double ticksToMicros(double ticks) {
+  return ticks * 1000 / PROFILE_TICKS_PER_MS;
+}
+
+/**
+ * @brief Plays every seed under every variant on a pool of threads
+ */
+static BatchRun runBatch(const BatchOptions &options, int threads) {
+  BatchRun run;
+  int numVariants = options.variants.size();
+  run.results.resize((size_t)options.seeds * numVariants);
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    WorkStealingPool pool(threads);
+    run.threads = pool.size();
+    std::vector<FrameCosts> workerCosts(pool.size());
+
+    // Queued seed by seed, so neighbouring workers play the same stage
+    for (int i = 0; i < (int)run.results.size(); i++) {
+      MatchSetup setup;
+      setup.seed = options.first_seed + i / numVariants;
+      setup.variant = i % numVariants;
+      setup.width = options.width;
+      setup.height = options.height;
+      setup.enemies = options.enemies;
+      setup.hardest = options.hardest;
+      setup.archetypes = &options.variants[setup.variant];
+      setup.max_frames = options.max_frames;
+      MatchResult *result = &run.results[i];
+      pool.submit([setup, result, &workerCosts] {
+        playMatch(setup, *result,
+                  workerCosts[WorkStealingPool::currentWorker()]);
+      });
+    }
+    pool.wait();
+
+    for (const FrameCosts &costs : workerCosts) run.costs.merge(costs);
+    for (int i = 0; i < pool.size(); i++) {
+      run.ran.push_back(pool.ran(i));
+      run.stolen.push_back(pool.stolen(i));
+    }
+  }
+  run.seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  return run;
+}
+
+/**
+ * @brief The win rates and match lengths of each variant
+ */
+static void printOutcomes(const BatchOptions &options, const BatchRun &run) {
+  printf("%-28s %7s %8s %8s %7s %6s %7s %6s %6s %6s\n", "variant", "matches",
+         "player", "enemies", "draws", "none", "frames", "p50", "p90",
+         "kills");
+  for (int v = 0; v < (int)options.variants.size(); v++) {
+    int outcomes[MATCH_OUTCOME_COUNT] = {};
+    std::vector<int> lengths;
+    long kills = 0, played = 0;
+    for (const MatchResult &result : run.results) {
+      if (result.variant != v) continue;
+      outcomes[result.outcome]++;
+      if (result.outcome == MATCH_NO_STAGE) continue;
+      played++;
+      kills += result.enemies - result.enemies_left;
+      lengths.push_back(result.frames);
+    }
+    std::sort(lengths.begin(), lengths.end());
+
+    double mean = 0;
+    for (int length : lengths) mean += length;
+    if (!lengths.empty()) mean /= lengths.size();
+    auto share = [&](MatchOutcome outcome) {
+      return played > 0 ? 100.0 * outcomes[outcome] / played : 0.0;
+    };
+    auto at = [&](double fraction) {
+      if (lengths.empty()) return 0;
+      return lengths[(size_t)(fraction * (lengths.size() - 1))];
+    };
+
+    std::string name = options.variants[v].name;
+    if (name.size() > 28) name = name.substr(0, 25) + "...";
+    printf("%-28s %7ld %7.1f%% %7.1f%% %6.1f%% %6d %7.0f %6d %6d %6.2f\n",
+           name.c_str(), played, share(MATCH_PLAYER_WON),
+           share(MATCH_ENEMIES_WON), share(MATCH_DRAW),
+           outcomes[MATCH_NO_STAGE], mean, at(0.5), at(0.9),
+           played > 0 ? (double)kills / played : 0.0);
+  }
+}
+
+/**
+ * @brief What a frame cost, and how fast the batch went
+ */
+static void printCosts(const BatchRun &run) {
+  const FrameCosts &costs = run.costs;
+  if (costs.frames == 0) return;
+  printf("\nframe cost (us): mean %.2f  p50 %.2f  p99 %.2f  worst %.1f\n",
+         ticksToMicros((double)costs.ticks / costs.frames),
+         ticksToMicros(costs.percentile(0.5)),
+         ticksToMicros(costs.percentile(0.99)), ticksToMicros(costs.worst));
+  printf("  ");
+  for (int i = 0; i < (int)(sizeof(REPORTED_SECTIONS) /
+                            sizeof(REPORTED_SECTIONS[0]));
+       i++) {
+    printf("%s %.2f  ", REPORTED_NAMES[i],
+           ticksToMicros((double)costs.section_ticks[REPORTED_SECTIONS[i]] /
+                         costs.frames));
+  }
+  printf("\n");
+
+  printf("throughput: %zu matches in %.2f s on %d threads, %.0f a second, "
+         "%.2fM frames a second (%.0fx real time)\n",
+         run.results.size(), run.seconds, run.threads,
+         run.results.size() / run.seconds, costs.frames / run.seconds / 1e6,
+         costs.frames / run.seconds / 60);
+
+  long stolen = 0, least = run.ran[0], most = run.ran[0];
+  for (int i = 0; i < run.threads; i++) {
+    stolen += run.stolen[i];
+    least = std::min(least, run.ran[i]);
+    most = std::max(most, run.ran[i]);
+  }
+  printf("workers: %ld to %ld matches each, %ld stolen\n", least, most,
+         stolen);
+}
+
+static bool writeCsv(const std::string &path, const BatchOptions &options,
+                     const BatchRun &run) {
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == nullptr) return false;
+  fprintf(file, "seed,variant,outcome,frames,enemies,enemies_left,"
+                "player_shots,mean_frame_us\n");
+  for (const MatchResult &result : run.results) {
+    fprintf(file, "%u,\"%s\",%s,%d,%d,%d,%d,%.3f\n", result.seed,
+            options.variants[result.variant].name.c_str(),
+            OUTCOME_NAMES[result.outcome], result.frames, result.enemies,
+            result.enemies_left, result.player_shots,
+            result.frames > 0 ? ticksToMicros((double)result.ticks /
+                                              result.frames)
+                              : 0.0);
+  }
+  return fclose(file) == 0;
+}
+
+/**
+ * @brief Whether a run played every match the same way as another
+ */
+static bool sameResults(const BatchRun &a, const BatchRun &b) {
+  for (size_t i = 0; i < a.results.size(); i++) {
+    const MatchResult &x = a.results[i], &y = b.results[i];
+    if (x.outcome != y.outcome || x.frames != y.frames ||
+        x.enemies_left != y.enemies_left || x.player_shots != y.player_shots) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Plays the batch again on 1, 2, 4... threads, up to the full run's,
+ *        checking each plays every match the same way
+ */
+static void printScaling(const BatchOptions &options, const BatchRun &full) {
+  printf("\nscaling (matches a second):\n");
+  double single = 0;
+  auto row = [&](const BatchRun &run) {
+    double rate = run.results.size() / run.seconds;
+    if (single == 0) single = rate;
+    printf("  %3d threads %9.0f  %5.2fx  %5.1f%% efficient%s\n", run.threads,
+           rate, rate / single, 100 * rate / single / run.threads,
+           sameResults(run, full) ? "" : "  (results differ)");
+  };
+  for (int threads = 1; threads < full.threads; threads *= 2) {
+    row(runBatch(options, threads));
+  }
+  row(full);
+}
+
+/**
+ * @brief Scrubs the first seed's match, see replayMatch
+ * @return False if scrubbing found a frame unlike the one played
+ */
+static bool replay(const BatchOptions &options) {
+  MatchSetup setup;
+  setup.seed = options.first_seed;
+  setup.variant = 0;
+  setup.width = options.width;
+  setup.height = options.height;
+  setup.enemies = options.enemies;
+  setup.hardest = options.hardest;
+  setup.archetypes = &options.variants[0];
+  setup.max_frames = options.max_frames;
+  ReplayResult result;
+  replayMatch(setup, options.replay_frame, result);
+
+  printf("selfplay: replaying seed %u, %s\n\n", setup.seed,
+         options.variants[0].name.c_str());
+  if (result.outcome == MATCH_NO_STAGE) {
+    printf("no stage for the seed\n");
+    return true;
+  }
+  // Stopped once the frame was mid-buffer, a draw only at the frame limit
+  bool decided = result.outcome != MATCH_DRAW ||
+                 result.frames >= options.max_frames;
+  printf("played %d frames (%s), holding %d to %d in %d KB\n",
+         result.frames, decided ? OUTCOME_NAMES[result.outcome] : "playing",
+         result.oldest, result.newest, result.bytes / 1024);
+  printf("restored %d frames back and forward, %d unlike the live match",
+         result.restored, result.mismatches);
+  if (result.mismatches > 0) printf(", first %d", result.first_mismatch);
+  printf("\n\n");
+
+  if (result.shown < 0) {
+    printf("frame %d isn't held\n", options.replay_frame);
+  } else {
+    printf("frame %d, %d bullets live\n", result.shown, result.bullets);
+    for (const ReplayTank &tank : result.tanks) {
+      printf("  color %d at %4d, %4d%s\n", tank.color, tank.x, tank.y,
+             tank.alive ? "" : "  destroyed");
+    }
+  }
+  return result.mismatches == 0;
+}
+
+//---------------------------------------------------------------------------------
+//
+// MAIN
+//
+//---------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  BatchOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string error;
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      options.seeds = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+      options.threads = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      options.first_seed = strtoul(argv[++i], nullptr, 0);
+    } else if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+      options.width = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-h") && i + 1 < argc) {
+      options.height = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-e") && i + 1 < argc) {
+      options.enemies = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+      options.hardest = (TankColor)atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      options.max_frames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-v") && i + 1 < argc) {
+      ArchetypeVariant variant;
+      if (!parseVariant(argv[++i], variant, error)) {
+        fprintf(stderr, "selfplay: %s\n", error.c_str());
+        return 1;
+      }
+      options.variants.push_back(variant);
+    } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      options.csv = argv[++i];
+    } else if (!strcmp(argv[i], "-S")) {
+      options.scaling = true;
+    } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+      options.replay_frame = atoi(argv[++i]);
+    } else {
+      fprintf(stderr,
+              "Usage: selfplay [-n seeds] [-j threads] [-s first seed] "
+              "[-w width] [-h height] [-e enemies] [-c hardest color] "
+              "[-f max frames] [-v variant]... [-o results.csv] [-S] "
+              "[-r frame]\n");
+      return 1;
+    }
+  }
+
+  if (options.width % TERRAIN_CHUNK_SIZE != 0 ||
+      options.height % TERRAIN_CHUNK_SIZE != 0 ||
+      options.width < SCREEN_WIDTH || options.height < SCREEN_HEIGHT ||
+      options.width > ARENA_MAX_WIDTH || options.height > ARENA_MAX_HEIGHT) {
+    fprintf(stderr, "selfplay: %dx%d isn't an arena size\n", options.width,
+            options.height);
+    return 1;
+  }
+  if (options.seeds < 1 || options.max_frames < 1 || options.enemies < 1 ||
+      options.enemies >= MAX_STAGE_TANKS || options.hardest < T_COLOR_BROWN ||
+      options.hardest >= T_COLOR_COUNT) {
+    fprintf(stderr, "selfplay: needs a seed and a frame or more, 1 to %d "
+                    "enemies, colors %d to %d\n",
+            MAX_STAGE_TANKS - 1, T_COLOR_BROWN, T_COLOR_COUNT - 1);
+    return 1;
+  }
+  if (options.variants.empty()) {
+    options.variants.push_back(ArchetypeVariant());
+    options.variants[0].name = "base";
+  }
+
+  if (options.replay_frame >= 0) {
+    if (replay(options)) return 0;
+    fprintf(stderr,
+            "selfplay: FAILED, a restored frame isn't the one played\n");
+    return 1;
+  }
+
+  BatchRun run = runBatch(options, options.threads);
+  printf("selfplay: seeds %u to %u, %dx%d, %d enemies up to color %d\n\n",
+         options.first_seed, options.first_seed + options.seeds - 1,
+         options.width, options.height, options.enemies, options.hardest);
+  printOutcomes(options, run);
+  printCosts(run);
+  if (options.scaling) printScaling(options, run);
+
+  if (!options.csv.empty() && !writeCsv(options.csv, options, run)) {
+    fprintf(stderr, "selfplay: couldn't write %s\n", options.csv.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+#ifndef SELFPLAY_GL2D_H
+#define SELFPLAY_GL2D_H
+
+/*
+ * gl2d for the host, where nothing is drawn. See Platform.cpp.
+ */
+
+#include <nds.h>
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+typedef struct {
+  int width;
+  int height;
+  int u_off;
+  int v_off;
+  int textureID;
+} glImage;
+
+typedef enum {
+  GL_RGBA = 1,
+  GL_RGB4 = 2,
+  GL_RGB16 = 3,
+  GL_RGB256 = 4
+} GL_TEXTURE_TYPE_ENUM;
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+#define TEXTURE_SIZE_8 0
+#define TEXTURE_SIZE_16 1
+#define TEXTURE_SIZE_32 2
+#define TEXTURE_SIZE_64 3
+#define TEXTURE_SIZE_128 4
+#define TEXTURE_SIZE_256 5
+#define TEXTURE_SIZE_512 6
+#define GL_TEXTURE_WRAP_S 1
+#define GL_TEXTURE_WRAP_T 2
+#define GL_TEXTURE_COLOR0_TRANSPARENT 8
+#define TEXGEN_OFF 0
+#define GL_FLIP_NONE 0
+#define GL_GET_POLYGON_RAM_COUNT 1
+#define GL_GET_VERTEX_RAM_COUNT 2
+
+#define POLY_ALPHA(n) ((n) << 16)
+#define POLY_CULL_NONE 0xc0
+#define POLY_ID(n) ((n) << 24)
+#define POLY_FORMAT_LIGHT0 1
+#define POLY_MODULATION 0
+
+//---------------------------------------------------------------------------------
+//
+// FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+int glLoadSpriteSet(glImage *sprite, unsigned int numframes,
+                    const unsigned int *texcoords, GL_TEXTURE_TYPE_ENUM type,
+                    int sizeX, int sizeY, int param, int palette_width,
+                    const u16 *palette, const u8 *texture);
+int glLoadTileSet(glImage *sprite, int tile_wid, int tile_hei, int bmp_wid,
+                  int bmp_hei, GL_TEXTURE_TYPE_ENUM type, int sizeX,
+                  int sizeY, int param, int palette_width, const u16 *palette,
+                  const u8 *texture);
+void glScreen2D();
+void glBegin2D();
+void glEnd2D();
+void glSprite(int x, int y, int flipmode, const glImage *spr);
+void glSpriteRotateScale(int x, int y, int angle, int scale, int flipmode,
+                         const glImage *spr);
+void glLine(int x1, int y1, int x2, int y2, int color);
+void glBoxFilled(int x1, int y1, int x2, int y2, int color);
+void glPolyFmt(u32 params);
+void glColor(u16 color);
+void glClearColor(u8 red, u8 green, u8 blue, u8 alpha);
+void glClearPolyID(u8 id);
+void glFlush(u32 mode);
+void glGetInt(int param, int *i);
+
+#endif // SELFPLAY_GL2D_H
@@ -0,0 +1,213 @@
+#ifndef SELFPLAY_NDS_H
+#define SELFPLAY_NDS_H
+
+/*
+ * The parts of libnds the game's simulation is built against, for the host.
+ * Nothing is shown: VRAM, OAM and the palettes are plain memory (one copy
+ * per thread, like the game's own statics), drawing does nothing and the
+ * CPU timers count the host's clock. See Platform.cpp.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+typedef int32_t f32;
+
+typedef enum {
+  SpriteSize_8x8,
+  SpriteSize_16x16,
+  SpriteSize_32x32,
+  SpriteSize_64x64,
+  SpriteSize_16x8,
+  SpriteSize_32x8,
+  SpriteSize_32x16,
+  SpriteSize_64x32,
+  SpriteSize_8x16,
+  SpriteSize_8x32,
+  SpriteSize_16x32,
+  SpriteSize_32x64
+} SpriteSize;
+
+typedef enum {
+  SpriteColorFormat_16Color,
+  SpriteColorFormat_256Color,
+  SpriteColorFormat_Bmp
+} SpriteColorFormat;
+
+typedef enum { SpriteMapping_1D_32, SpriteMapping_1D_128 } SpriteMapping;
+
+typedef enum {
+  BgType_Text8bpp,
+  BgType_Text4bpp,
+  BgType_Bmp8,
+  BgType_Bmp16
+} BgType;
+
+typedef enum {
+  BgSize_T_256x256,
+  BgSize_T_512x256,
+  BgSize_T_512x512,
+  BgSize_B8_256x256,
+  BgSize_B16_256x256
+} BgSize;
+
+typedef struct {
+  int unused;
+} OamState;
+
+typedef struct {
+  u16 rawx, rawy, px, py, z1, z2;
+} touchPosition;
+
+struct PrintConsole;
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+#define SCREEN_WIDTH 256
+#define SCREEN_HEIGHT 192
+#define SPRITE_COUNT 128
+#define MATRIX_COUNT 32
+#define BUS_CLOCK 33513982
+
+#define BIT(n) (1 << (n))
+#define RGB15(r, g, b) ((r) | ((g) << 5) | ((b) << 10))
+#define ARGB16(a, r, g, b) (((a) << 15) | (r) | ((g) << 5) | ((b) << 10))
+#define inttof32(n) ((n) << 12)
+#define DEGREES_IN_CIRCLE (1 << 15)
+#define degreesToAngle(degrees) ((degrees) * DEGREES_IN_CIRCLE / 360)
+
+// Nothing to place on the host
+#define ITCM_CODE
+#define DTCM_DATA
+#define DTCM_BSS
+
+#define sassert(e, msg)                                                        \
+  ((e) ? (void)0                                                               \
+       : (fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg), abort()))
+
+#define KEY_A BIT(0)
+#define KEY_B BIT(1)
+#define KEY_SELECT BIT(2)
+#define KEY_START BIT(3)
+#define KEY_RIGHT BIT(4)
+#define KEY_LEFT BIT(5)
+#define KEY_UP BIT(6)
+#define KEY_DOWN BIT(7)
+#define KEY_R BIT(8)
+#define KEY_L BIT(9)
+#define KEY_X BIT(10)
+#define KEY_Y BIT(11)
+#define KEY_TOUCH BIT(12)
+
+#define VRAM_A_MAIN_BG 1
+#define VRAM_B_MAIN_SPRITE 2
+#define VRAM_C_SUB_BG 3
+#define VRAM_D_SUB_SPRITE 4
+#define VRAM_H_SUB_BG 5
+#define VRAM_I_SUB_SPRITE 6
+#define VRAM_E_TEX_PALETTE 7
+#define VRAM_D_TEXTURE 8
+
+#define MODE_0_3D 1
+#define MODE_5_2D 2
+#define DISPLAY_BG2_ACTIVE 4
+#define DISPLAY_BG3_ACTIVE 8
+#define BG_PRIORITY(n) (n)
+
+#define LZ77 0
+#define LZ77Vram 1
+
+extern thread_local OamState oamMain;
+extern thread_local OamState oamSub;
+extern thread_local u16 BG_PALETTE[256];
+extern thread_local u16 BG_PALETTE_SUB[256];
+extern thread_local u16 SPRITE_PALETTE[256];
+extern thread_local u16 SPRITE_PALETTE_SUB[256];
+extern thread_local vu16 REG_BG0CNT;
+
+//---------------------------------------------------------------------------------
+//
+// FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+// Sprites
+void oamInit(OamState *oam, SpriteMapping mapping, bool extPalette);
+u16 *oamAllocateGfx(OamState *oam, SpriteSize size, SpriteColorFormat format);
+void oamFreeGfx(OamState *oam, const void *gfx);
+void oamSet(OamState *oam, int id, int x, int y, int priority,
+            int palette_alpha, SpriteSize size, SpriteColorFormat format,
+            const void *gfxOffset, int affineIndex, bool sizeDouble,
+            bool hide, bool hflip, bool vflip, bool mosaic);
+void oamRotateScale(OamState *oam, int rotId, int angle, int sx, int sy);
+void oamSetHidden(OamState *oam, int id, bool hide);
+void oamClearSprite(OamState *oam, int id);
+void oamClear(OamState *oam, int start, int count);
+void oamUpdate(OamState *oam);
+
+// Backgrounds
+int bgInit(int layer, BgType type, BgSize size, int mapBase, int tileBase);
+int bgInitSub(int layer, BgType type, BgSize size, int mapBase, int tileBase);
+void bgSetPriority(int id, int priority);
+void bgSetScroll(int id, int x, int y);
+u16 *bgGetGfxPtr(int id);
+u16 *bgGetMapPtr(int id);
+void bgUpdate();
+
+// Video and memory
+void videoSetMode(u32 mode);
+void videoSetModeSub(u32 mode);
+void vramSetBankA(int mode);
+void vramSetBankB(int mode);
+void vramSetBankC(int mode);
+void vramSetBankD(int mode);
+void vramSetBankE(int mode);
+void vramSetBankI(int mode);
+void dmaCopy(const void *source, void *dest, u32 size);
+void dmaFillHalfWords(u16 value, void *dest, u32 size);
+void DC_FlushRange(const void *base, u32 size);
+void decompress(const void *data, void *dst, int type);
+
+// Timing
+void cpuStartTiming(int timer);
+u32 cpuGetTiming();
+void swiWaitForVBlank();
+bool pmMainLoop();
+
+// Input, nobody pressing anything
+void scanKeys();
+u32 keysHeld();
+u32 keysDown();
+u32 keysUp();
+void touchRead(touchPosition *touch);
+
+// The console
+PrintConsole *consoleInit(PrintConsole *console, int layer, BgType type,
+                          BgSize size, int mapBase, int tileBase,
+                          bool mainDisplay, bool loadGraphics);
+void consoleDemoInit();
+void consoleClear();
+
+#endif // SELFPLAY_NDS_H
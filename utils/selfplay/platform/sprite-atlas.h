@@ -0,0 +1,79 @@
+#ifndef SELFPLAY_SPRITE_ATLAS_H
+#define SELFPLAY_SPRITE_ATLAS_H
+
+/*
+ * Stands in for the sprite-atlas.h utils/assetc generates, for the host.
+ * Nothing is drawn, so every frame is the same blank 8x8 tile. Only the
+ * animations and their frame counts matter: they time the treads the way
+ * the game does. Keep them in step with sprites/sprite-atlas.json.
+ */
+
+#include <nds.h>
+
+#ifndef SPRITE_ATLAS_TYPES
+#define SPRITE_ATLAS_TYPES
+/**
+ * @brief A frame's tiles and where they go, as in the generated header
+ */
+typedef struct SpriteAtlasFrame {
+  u32 tile_offset; // Bytes into the unpacked tiles
+  SpriteSize size; // The OAM size of the tiles
+  u8 width;
+  u8 height;
+  u8 anchor_x; // Top left of the tiles within the cell
+  u8 anchor_y;
+  u8 hflip; // The tiles are stored mirrored, flip them back
+  u8 vflip;
+  u16 cell; // The sheet cell the frame was cut from
+} SpriteAtlasFrame;
+
+/**
+ * @brief An animation's frames, in order
+ */
+typedef struct SpriteAtlasAnim {
+  u16 first_frame; // Index into the frame table
+  u16 num_frames;
+} SpriteAtlasAnim;
+#endif // SPRITE_ATLAS_TYPES
+
+enum SpriteAnim {
+  SPRITE_ANIM_TANK_BODY_BLUE,
+  SPRITE_ANIM_TANK_BODY_RED,
+  SPRITE_ANIM_TANK_BODY_BROWN,
+  SPRITE_ANIM_TANK_BODY_ASH,
+  SPRITE_ANIM_TANK_BODY_MARINE,
+  SPRITE_ANIM_TANK_BODY_YELLOW,
+  SPRITE_ANIM_TANK_BODY_PINK,
+  SPRITE_ANIM_TANK_BODY_GREEN,
+  SPRITE_ANIM_TANK_BODY_VIOLET,
+  SPRITE_ANIM_TANK_BODY_WHITE,
+  SPRITE_ANIM_TANK_BODY_BLACK,
+  SPRITE_ANIM_TANK_TURRET_BLUE,
+  SPRITE_ANIM_TANK_TURRET_RED,
+  SPRITE_ANIM_TANK_TURRET_BROWN,
+  SPRITE_ANIM_TANK_TURRET_ASH,
+  SPRITE_ANIM_TANK_TURRET_MARINE,
+  SPRITE_ANIM_TANK_TURRET_YELLOW,
+  SPRITE_ANIM_TANK_TURRET_PINK,
+  SPRITE_ANIM_TANK_TURRET_GREEN,
+  SPRITE_ANIM_TANK_TURRET_VIOLET,
+  SPRITE_ANIM_TANK_TURRET_WHITE,
+  SPRITE_ANIM_TANK_TURRET_BLACK,
+  SPRITE_ANIM_CURSOR,
+  SPRITE_ANIM_CURSOR_TAIL,
+  SPRITE_ANIM_BULLET,
+  SPRITE_ANIM_COUNT
+};
+
+#define sprite_atlasCellSize 32
+#define sprite_atlasCellsPerRow 4
+#define sprite_atlasFrameCount 47
+#define sprite_atlasTilesLen 64 // Unpacked, the one blank tile
+#define sprite_atlasPalLen 512
+
+extern const unsigned int sprite_atlasTiles[19]; // LZ77
+extern const unsigned short sprite_atlasPal[256];
+extern const SpriteAtlasFrame sprite_atlasFrames[sprite_atlasFrameCount];
+extern const SpriteAtlasAnim sprite_atlasAnims[SPRITE_ANIM_COUNT];
+
+#endif // SELFPLAY_SPRITE_ATLAS_H
@@ -0,0 +1,361 @@
+/*---------------------------------------------------------------------------------
+
+StageGenerator.cpp
+Camdyn Rasque
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "StageGenerator.h"
+#include <cstdlib>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// TankDirection toward a step of -1, 0 or 1 on each axis, [y + 1][x + 1],
+// kept in step with source/Tank.h
+static const int DIRECTIONS[3][3] = {
+    {45, 0, 315},    // NW, N, NE
+    {90, 0, 270},    // W, (none), E
+    {135, 180, 225}, // SW, S, SE
+};
+
+static const char *DIRECTION_NAMES[3][3] = {
+    {"T_DIR_NW", "T_DIR_N", "T_DIR_NE"},
+    {"T_DIR_W", "T_DIR_N", "T_DIR_E"},
+    {"T_DIR_SW", "T_DIR_S", "T_DIR_SE"},
+};
+
+// Kept in step with TankColor
+static const char *COLOR_NAMES[T_COLOR_COUNT] = {
+    "T_COLOR_BLUE",   "T_COLOR_RED",    "T_COLOR_BROWN", "T_COLOR_ASH",
+    "T_COLOR_MARINE", "T_COLOR_YELLOW", "T_COLOR_PINK",  "T_COLOR_GREEN",
+    "T_COLOR_VIOLET", "T_COLOR_WHITE",  "T_COLOR_BLACK"};
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Xorshift, like ParticleSystem's, seeded so nearby seeds differ
+ */
+struct Random {
+  uint32_t state;
+
+  explicit Random(uint32_t seed) {
+    state = (seed + 1) * 0x9E3779B9u;
+    state ^= state >> 16;
+    if (state == 0) state = 0x2545F491;
+  }
+
+  uint32_t next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  // 0 up to but not including range
+  int below(int range) { return (int)(((uint64_t)next() * range) >> 32); }
+};
+
+/**
+ * @brief Union-find over the cells, halving paths as it goes
+ */
+struct CellSets {
+  std::vector<int> parent;
+
+  explicit CellSets(int count) : parent(count) {
+    for (int i = 0; i < count; i++) parent[i] = i;
+  }
+
+  int find(int cell) {
+    while (parent[cell] != cell) {
+      parent[cell] = parent[parent[cell]];
+      cell = parent[cell];
+    }
+    return cell;
+  }
+
+  void join(int a, int b) { parent[find(a)] = find(b); }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+static bool stopsBullets(int value) {
+  return value == BARRIER_WALL || value == BARRIER_DESTRUCTIBLE;
+}
+
+static int sign(int value) { return (value > 0) - (value < 0); }
+
+/**
+ * @brief Whether a bullet could fly straight between two cells' middles.
+ *        Walks every cell the line touches; where it passes exactly through
+ *        a corner, both cells beside it have to be open.
+ */
+static bool hasLineOfSight(const GeneratedStage &stage, int col1, int row1,
+                           int col2, int row2) {
+  int dx = abs(col2 - col1), dy = abs(row2 - row1);
+  int sx = sign(col2 - col1), sy = sign(row2 - row1);
+  int col = col1, row = row1;
+  int error = dx - dy;
+  for (int steps = dx + dy; steps > 0; steps--) {
+    if (error > 0) {
+      col += sx;
+      error -= 2 * dy;
+    } else if (error < 0) {
+      row += sy;
+      error += 2 * dx;
+    } else {
+      if (stopsBullets(stage.at(col + sx, row)) ||
+          stopsBullets(stage.at(col, row + sy))) {
+        return false;
+      }
+      col += sx;
+      row += sy;
+      error += 2 * dx - 2 * dy;
+      steps--;
+    }
+    if (stopsBullets(stage.at(col, row))) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief The direction from one cell toward another, to the nearest of the
+ *        eight, as [y + 1][x + 1] into DIRECTIONS
+ */
+static void facing(int dx, int dy, int &fx, int &fy) {
+  // Diagonal when neither axis is more than twice the other
+  fx = abs(dx) * 2 >= abs(dy) ? sign(dx) : 0;
+  fy = abs(dy) * 2 >= abs(dx) ? sign(dy) : 0;
+  if (fx == 0 && fy == 0) fy = -1;
+}
+
+/**
+ * @brief Picks an open spawn cell in a range of columns, clear of the
+ *        others, or returns false if it found none in a few tries
+ */
+static bool pickSpawn(const GeneratedStage &stage, Random &random, int col1,
+                      int col2, int &col, int &row) {
+  for (int tries = 0; tries < 32; tries++) {
+    col = col1 + random.below(col2 - col1);
+    row = random.below(stage.rows);
+    bool clear = true;
+    for (const GeneratedSpawn &spawn : stage.spawns) {
+      int dc = spawn.x / STAGE_CELL_SIZE - col;
+      int dr = spawn.y / STAGE_CELL_SIZE - row;
+      if (abs(dc) < 2 && abs(dr) < 2) clear = false;
+    }
+    if (clear) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Opens the cells around a spawn so the tank can drive out
+ */
+static void clearAround(GeneratedStage &stage, int col, int row) {
+  for (int r = row - 1; r <= row + 1; r++) {
+    for (int c = col - 1; c <= col + 1; c++) {
+      if (c < 0 || r < 0 || c >= stage.cols || r >= stage.rows) continue;
+      stage.cells[r * stage.cols + c] = BARRIER_EMPTY;
+    }
+  }
+}
+
+/**
+ * @brief One random layout, valid or not
+ */
+static bool layOut(const StageOptions &options, Random &random,
+                   GeneratedStage &stage) {
+  stage.cells.assign(stage.cols * stage.rows, BARRIER_EMPTY);
+  stage.spawns.clear();
+
+  // Straight runs like the hand drawn stages have, mostly walls
+  int runs = options.runs > 0 ? options.runs : stage.cols * stage.rows / 12;
+  // A third of the way across, but no longer than on one screen so big
+  // arenas aren't cut into rooms
+  int longest = stage.cols / 3;
+  if (longest < 3) longest = 3;
+  if (longest > 5) longest = 5;
+  for (int i = 0; i < runs; i++) {
+    int roll = random.below(10);
+    int value = roll < 6   ? BARRIER_WALL
+                : roll < 8 ? BARRIER_HOLE
+                           : BARRIER_DESTRUCTIBLE;
+    bool across = random.below(2);
+    int length = 2 + random.below(longest - 1);
+    int col = random.below(stage.cols);
+    int row = random.below(stage.rows);
+    for (int j = 0; j < length; j++) {
+      int c = across ? col + j : col;
+      int r = across ? row : row + j;
+      if (c >= stage.cols || r >= stage.rows) break;
+      stage.cells[r * stage.cols + c] = value;
+    }
+  }
+
+  // The player on the left quarter, the enemies on the right three
+  int col, row;
+  int split = stage.cols / 4 > 1 ? stage.cols / 4 : 1;
+  if (!pickSpawn(stage, random, 0, split, col, row)) return false;
+  clearAround(stage, col, row);
+  stage.spawns.push_back({col * STAGE_CELL_SIZE, row * STAGE_CELL_SIZE,
+                          T_COLOR_BLUE, 0});
+
+  int colors = options.hardest - T_COLOR_BROWN + 1;
+  for (int i = 0; i < options.enemies; i++) {
+    if (!pickSpawn(stage, random, split, stage.cols, col, row)) return false;
+    clearAround(stage, col, row);
+    TankColor color = (TankColor)(T_COLOR_BROWN + random.below(colors));
+    stage.spawns.push_back(
+        {col * STAGE_CELL_SIZE, row * STAGE_CELL_SIZE, color, 0});
+  }
+
+  // Everyone faces the player, who faces the first enemy
+  const GeneratedSpawn &player = stage.spawns[0];
+  for (size_t i = 0; i < stage.spawns.size(); i++) {
+    const GeneratedSpawn &target = i == 0 ? stage.spawns[1] : player;
+    int fx, fy;
+    facing(target.x - stage.spawns[i].x, target.y - stage.spawns[i].y, fx, fy);
+    stage.spawns[i].direction = DIRECTIONS[fy + 1][fx + 1];
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+//
+// PUBLIC FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+bool validateStage(const GeneratedStage &stage, std::string *why) {
+  auto fail = [&](const std::string &problem) {
+    if (why != nullptr) *why = problem;
+    return false;
+  };
+  if (stage.spawns.size() < 2) return fail("needs a player and an enemy");
+
+  // Every spawn on its own open cell
+  std::vector<int> spawnCells;
+  for (const GeneratedSpawn &spawn : stage.spawns) {
+    int col = spawn.x / STAGE_CELL_SIZE, row = spawn.y / STAGE_CELL_SIZE;
+    if (spawn.x % STAGE_CELL_SIZE != 0 || spawn.y % STAGE_CELL_SIZE != 0 ||
+        col < 0 || row < 0 || col >= stage.cols || row >= stage.rows) {
+      return fail("spawn off the cell grid");
+    }
+    if (stage.at(col, row) != BARRIER_EMPTY) return fail("spawn in a barrier");
+    int cell = row * stage.cols + col;
+    for (int other : spawnCells) {
+      if (other == cell) return fail("two spawns on one cell");
+    }
+    spawnCells.push_back(cell);
+  }
+
+  // Join each open cell with the open cells right of and below it
+  CellSets sets(stage.cols * stage.rows);
+  for (int row = 0; row < stage.rows; row++) {
+    for (int col = 0; col < stage.cols; col++) {
+      if (stage.at(col, row) != BARRIER_EMPTY) continue;
+      int cell = row * stage.cols + col;
+      if (col + 1 < stage.cols && stage.at(col + 1, row) == BARRIER_EMPTY) {
+        sets.join(cell, cell + 1);
+      }
+      if (row + 1 < stage.rows && stage.at(col, row + 1) == BARRIER_EMPTY) {
+        sets.join(cell, cell + stage.cols);
+      }
+    }
+  }
+
+  int playerSet = sets.find(spawnCells[0]);
+  int playerCol = spawnCells[0] % stage.cols;
+  int playerRow = spawnCells[0] / stage.cols;
+  for (size_t i = 1; i < stage.spawns.size(); i++) {
+    int col = spawnCells[i] % stage.cols, row = spawnCells[i] / stage.cols;
+    const TankArchetype &archetype = TANK_ARCHETYPES[stage.spawns[i].color];
+    bool moves = archetype.movement != T_MOVEMENT_STATIONARY;
+    if (moves && sets.find(spawnCells[i]) != playerSet) {
+      return fail("an enemy can't reach the player");
+    }
+    if (hasLineOfSight(stage, col, row, playerCol, playerRow)) {
+      return fail("an enemy starts with a shot at the player");
+    }
+
+    // Somewhere the player can drive to with a shot at it. An enemy the
+    // player can reach is one.
+    bool exposed = sets.find(spawnCells[i]) == playerSet;
+    for (int cell = 0; cell < stage.cols * stage.rows && !exposed; cell++) {
+      if (stage.cells[cell] != BARRIER_EMPTY || sets.find(cell) != playerSet) {
+        continue;
+      }
+      exposed = hasLineOfSight(stage, cell % stage.cols, cell / stage.cols,
+                               col, row);
+    }
+    if (!exposed) return fail("an enemy can't be shot at");
+  }
+  return true;
+}
+
+bool generateStage(const StageOptions &options, uint32_t seed,
+                   GeneratedStage &stage) {
+  stage.width = options.width;
+  stage.height = options.height;
+  stage.cols = options.width / STAGE_CELL_SIZE;
+  stage.rows = options.height / STAGE_CELL_SIZE;
+  stage.attempts = 0;
+  if (options.enemies < 1) return false;
+  Random random(seed);
+  for (stage.attempts = 1; stage.attempts <= STAGE_MAX_ATTEMPTS;
+       stage.attempts++) {
+    if (layOut(options, random, stage) && validateStage(stage, nullptr)) {
+      return true;
+    }
+  }
+  stage.attempts = STAGE_MAX_ATTEMPTS;
+  return false;
+}
+
+BarrierGrid toBarrierGrid(const GeneratedStage &stage) {
+  BarrierGrid grid;
+  grid.width = stage.width;
+  grid.height = stage.height;
+  grid.values.resize(stage.width * stage.height);
+  for (int y = 0; y < stage.height; y++) {
+    for (int x = 0; x < stage.width; x++) {
+      grid.values[y * stage.width + x] =
+          stage.at(x / STAGE_CELL_SIZE, y / STAGE_CELL_SIZE);
+    }
+  }
+  return grid;
+}
+
+std::string spawnInitializers(const GeneratedStage &stage) {
+  std::string out;
+  for (const GeneratedSpawn &spawn : stage.spawns) {
+    const char *direction = "T_DIR_N";
+    for (int y = 0; y < 3; y++) {
+      for (int x = 0; x < 3; x++) {
+        if (DIRECTIONS[y][x] == spawn.direction) {
+          direction = DIRECTION_NAMES[y][x];
+        }
+      }
+    }
+    out += "{" + std::to_string(spawn.x) + ", " + std::to_string(spawn.y) +
+           ", " + COLOR_NAMES[spawn.color] + ", " + direction + "},\n";
+  }
+  return out;
+}
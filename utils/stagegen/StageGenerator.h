@@ -0,0 +1,101 @@
+#ifndef STAGEGEN_STAGE_GENERATOR_H
+#define STAGEGEN_STAGE_GENERATOR_H
+
+#include "Barriers.h"
+#include "TankArchetype.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+const int STAGE_CELL_SIZE = 16;   // Barriers are laid out in whole cells
+const int STAGE_MAX_ATTEMPTS = 64; // Layouts tried for a seed before giving up
+
+//---------------------------------------------------------------------------------
+//
+// TYPE DEFINITIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief What to generate. The seed picks the rest.
+ */
+struct StageOptions {
+  int width = 256; // A multiple of 32, see readBarriers
+  int height = 192;
+  int enemies = 3;
+  TankColor hardest = T_COLOR_BLACK; // Enemies are brown up to this color
+  int runs = 0; // Straight runs of barrier cells laid, 0 to scale with area
+};
+
+/**
+ * @brief A tank's spawn, the same as a TankSpawn in source/Tank.h
+ */
+struct GeneratedSpawn {
+  int x; // Top left, in pixels
+  int y;
+  TankColor color;
+  int direction; // A TankDirection, degrees counterclockwise from north
+};
+
+/**
+ * @brief A stage on the cell grid, every cell a barrier value
+ */
+struct GeneratedStage {
+  int width = 0; // In pixels
+  int height = 0;
+  int cols = 0;
+  int rows = 0;
+  std::vector<uint8_t> cells;         // Row by row
+  std::vector<GeneratedSpawn> spawns; // The player first, as stages have it
+  int attempts = 0;                   // Layouts tried to find this one
+
+  int at(int col, int row) const { return cells[row * cols + col]; }
+};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Lays out random runs of wall, hole and destructible cells, places
+ *        the player on the left and the enemies away from it, each facing
+ *        the player, and keeps trying until validateStage passes. The same
+ *        options and seed always give the same stage.
+ * @return False if no layout passed in STAGE_MAX_ATTEMPTS
+ */
+bool generateStage(const StageOptions &options, uint32_t seed,
+                   GeneratedStage &stage);
+
+/**
+ * @brief Checks a stage is playable:
+ *        - every spawn is on its own open cell
+ *        - every enemy that moves can drive to the player (union-find over
+ *          the cells tanks can cross)
+ *        - no enemy starts with a clear shot at the player
+ *        - every enemy can be shot straight at from somewhere the player
+ *          can drive to, stationary ones behind holes included
+ * @param why Set to the first problem found, if not null
+ */
+bool validateStage(const GeneratedStage &stage, std::string *why);
+
+/**
+ * @brief The stage at a pixel a barrier value, for packBarriers and
+ *        packWalls, which write it the way assetc does
+ */
+BarrierGrid toBarrierGrid(const GeneratedStage &stage);
+
+/**
+ * @brief The spawns as TankSpawn initializers, one a line, to #include in
+ *        a stage's spawn array
+ */
+std::string spawnInitializers(const GeneratedStage &stage);
+
+#endif // STAGEGEN_STAGE_GENERATOR_H
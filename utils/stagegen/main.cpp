@@ -0,0 +1,144 @@
+/*---------------------------------------------------------------------------------
+
+main.cpp
+Camdyn Rasque
+
+The procedural stage generator, run on the host:
+
+  stagegen [-w width] [-h height] [-e enemies] [-c hardest color]
+           [-s first seed] [-n count] [-o output dir]
+
+Generates and validates count stages from consecutive seeds and prints how
+fast it went. With -o, each stage is also written the way assetc writes a
+hand drawn one: gen-<seed>_barriers.bin and gen-<seed>_walls.bin, plus
+gen-<seed>_spawns.inc with its TankSpawn initializers for a stage's spawn
+array. Backgrounds are art, so none is generated; Terrain::load takes a
+null map.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "Barriers.h"
+#include "StageGenerator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+static bool writeFile(const std::string &path, const void *data, size_t size) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write((const char *)data, size);
+  return (bool)file;
+}
+
+/**
+ * @brief Writes a stage's barriers, walls and spawns
+ */
+static bool writeStage(const GeneratedStage &stage, uint32_t seed,
+                       const std::string &outDir) {
+  std::string base = outDir + "/gen-" + std::to_string(seed);
+  BarrierGrid grid = toBarrierGrid(stage);
+  std::vector<uint8_t> barriers = packBarriers(grid);
+  std::vector<uint8_t> walls = packWalls(grid);
+  std::string spawns = "// stagegen seed " + std::to_string(seed) + ", " +
+                       std::to_string(stage.width) + "x" +
+                       std::to_string(stage.height) + "\n" +
+                       spawnInitializers(stage);
+  return writeFile(base + "_barriers.bin", barriers.data(), barriers.size()) &&
+         writeFile(base + "_walls.bin", walls.data(), walls.size()) &&
+         writeFile(base + "_spawns.inc", spawns.data(), spawns.size());
+}
+
+//---------------------------------------------------------------------------------
+//
+// MAIN
+//
+//---------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  StageOptions options;
+  uint32_t firstSeed = 1;
+  int count = 1;
+  std::string outDir;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+      options.width = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-h") && i + 1 < argc) {
+      options.height = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-e") && i + 1 < argc) {
+      options.enemies = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+      options.hardest = (TankColor)atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      firstSeed = strtoul(argv[++i], nullptr, 0);
+    } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      count = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      outDir = argv[++i];
+    } else {
+      fprintf(stderr,
+              "Usage: stagegen [-w width] [-h height] [-e enemies] "
+              "[-c hardest color] [-s first seed] [-n count] "
+              "[-o output dir]\n");
+      return 1;
+    }
+  }
+
+  if (options.width % ARENA_CHUNK_SIZE != 0 ||
+      options.height % ARENA_CHUNK_SIZE != 0 ||
+      options.width < ARENA_MIN_WIDTH || options.height < ARENA_MIN_HEIGHT ||
+      options.width > ARENA_MAX_WIDTH || options.height > ARENA_MAX_HEIGHT) {
+    fprintf(stderr, "stagegen: %dx%d isn't an arena size\n", options.width,
+            options.height);
+    return 1;
+  }
+  if (options.enemies < 1 || options.hardest < T_COLOR_BROWN ||
+      options.hardest >= T_COLOR_COUNT) {
+    fprintf(stderr, "stagegen: needs an enemy or more, colors %d to %d\n",
+            T_COLOR_BROWN, T_COLOR_COUNT - 1);
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  GeneratedStage stage;
+  long attempts = 0;
+  int failed = 0;
+  for (int i = 0; i < count; i++) {
+    uint32_t seed = firstSeed + i;
+    bool generated = generateStage(options, seed, stage);
+    attempts += stage.attempts;
+    if (!generated) {
+      fprintf(stderr, "stagegen: seed %u found no valid layout\n", seed);
+      failed++;
+      continue;
+    }
+    if (!outDir.empty() && !writeStage(stage, seed, outDir)) {
+      fprintf(stderr, "stagegen: couldn't write seed %u\n", seed);
+      return 1;
+    }
+  }
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  printf("stagegen: %d stages (%d failed) in %.1f ms, %.0f a second, "
+         "%.2f layouts tried each\n",
+         count, failed, seconds * 1000, count / seconds,
+         count > 0 ? (double)attempts / count : 0.0);
+  return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+/*---------------------------------------------------------------------------------
+
+main.cpp
+Camdyn Rasque
+
+The telemetry log decoder, run on the host:
+
+  telemetry-csv <log> <output prefix>
+
+Reads a log written by source/Telemetry.cpp (tanks-telemetry.bin on the SD
+card, or next to a host build) and writes <prefix>-frames.csv, one row a
+frame with its section times in microseconds, and <prefix>-events.csv, one
+row an event. Records the game had to drop show up as "dropped" events.
+
+---------------------------------------------------------------------------------*/
+//---------------------------------------------------------------------------------
+//
+// IMPORTS
+//
+//---------------------------------------------------------------------------------
+
+#include "TelemetryFormat.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------------
+//
+// CONSTANTS & GLOBALS
+//
+//---------------------------------------------------------------------------------
+
+// In ProfileSection's order
+static const char *SECTION_NAMES[TELEMETRY_SECTIONS] = {
+    "input", "ai", "bullets", "collision", "sprites", "gl2d", "minimap",
+    "frame"};
+
+static const char *EVENT_NAMES[TELEMETRY_EVENT_COUNT] = {
+    "fire", "ricochet", "kill", "mine_laid", "mine_detonate", "quality"};
+
+// In TcmPlacement's order, see source/Tcm.h
+static const char *TCM_NAMES[] = {"RICOCHET",         "BULLET_MOVE",
+                                  "TANK_BARRIERS",    "BULLET_COLLISION",
+                                  "TERRAIN_CELLS",    "BULLET_SWEEPS"};
+
+//---------------------------------------------------------------------------------
+//
+// HELPER FUNCTIONS
+//
+//---------------------------------------------------------------------------------
+
+static bool readFile(const char *path, std::vector<uint8_t> &bytes) {
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr) return false;
+  uint8_t buffer[64 * 1024];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + count);
+  }
+  fclose(file);
+  return true;
+}
+
+static FILE *openCsv(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == nullptr) fprintf(stderr, "Can't write %s\n", path.c_str());
+  return file;
+}
+
+//---------------------------------------------------------------------------------
+//
+// MAIN
+//
+//---------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <log> <output prefix>\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<uint8_t> log;
+  if (!readFile(argv[1], log)) {
+    fprintf(stderr, "Can't read %s\n", argv[1]);
+    return 1;
+  }
+
+  TelemetryHeader header;
+  if (log.size() < sizeof(header)) {
+    fprintf(stderr, "%s is too short for a telemetry log\n", argv[1]);
+    return 1;
+  }
+  memcpy(&header, log.data(), sizeof(header));
+  if (header.magic != TELEMETRY_MAGIC) {
+    fprintf(stderr, "%s isn't a telemetry log\n", argv[1]);
+    return 1;
+  }
+  if (header.version != TELEMETRY_VERSION ||
+      header.sections != TELEMETRY_SECTIONS) {
+    fprintf(stderr, "%s is version %d with %d sections, expected %d with %d\n",
+            argv[1], header.version, header.sections, TELEMETRY_VERSION,
+            TELEMETRY_SECTIONS);
+    return 1;
+  }
+  double usPerTick = 1000.0 / header.ticks_per_ms;
+
+  std::string prefix = argv[2];
+  FILE *frames = openCsv(prefix + "-frames.csv");
+  FILE *events = openCsv(prefix + "-events.csv");
+  if (frames == nullptr || events == nullptr) return 1;
+
+  fprintf(frames, "frame");
+  for (const char *name : SECTION_NAMES) fprintf(frames, ",%s_us", name);
+  fprintf(frames, ",tanks,bullets,mines,oam,particles,heap_peak,"
+                  "sprite_vram_peak,texture_vram_peak\n");
+  fprintf(events, "frame,event,subject,x,y,count\n");
+
+  int frameCount = 0, eventCount = 0;
+  uint32_t droppedCount = 0;
+  size_t at = sizeof(header);
+  while (at < log.size()) {
+    uint8_t type = log[at++];
+    size_t left = log.size() - at;
+
+    if (type == TELEMETRY_FRAME && left >= sizeof(TelemetryFrame)) {
+      TelemetryFrame record;
+      memcpy(&record, &log[at], sizeof(record));
+      at += sizeof(record);
+      fprintf(frames, "%u", record.frame);
+      for (int i = 0; i < TELEMETRY_SECTIONS; i++) {
+        fprintf(frames, ",%.1f", record.section_ticks[i] * usPerTick);
+      }
+      fprintf(frames, ",%u,%u,%u,%u,%u,%u,%u,%u\n", record.tanks,
+              record.bullets, record.mines, record.oam, record.particles,
+              record.heap_peak, record.sprite_vram_peak,
+              record.texture_vram_peak);
+      frameCount++;
+    } else if (type == TELEMETRY_EVENT && left >= sizeof(TelemetryEvent)) {
+      TelemetryEvent record;
+      memcpy(&record, &log[at], sizeof(record));
+      at += sizeof(record);
+      const char *name = record.type < TELEMETRY_EVENT_COUNT
+                             ? EVENT_NAMES[record.type]
+                             : "unknown";
+      fprintf(events, "%u,%s,%u,%d,%d,1\n", record.frame, name,
+              record.subject, record.x, record.y);
+      eventCount++;
+    } else if (type == TELEMETRY_DROPPED &&
+               left >= sizeof(TelemetryDropped)) {
+      TelemetryDropped record;
+      memcpy(&record, &log[at], sizeof(record));
+      at += sizeof(record);
+      fprintf(events, "%u,dropped,,,,%u\n", record.frame, record.records);
+      droppedCount += record.records;
+    } else {
+      // Unknown, or cut short by the game stopping mid write
+      fprintf(stderr, "Stopped at byte %zu: %s record type %d\n", at - 1,
+              type <= TELEMETRY_DROPPED ? "truncated" : "unknown", type);
+      break;
+    }
+  }
+
+  fclose(frames);
+  fclose(events);
+  printf("%d frames, %d events, %u records dropped\n", frameCount, eventCount,
+         droppedCount);
+
+  // Logs from builds with different placements are compared by their
+  // bullets and collision times
+  printf("TCM placements:");
+  int placed = 0;
+  for (size_t i = 0; i < sizeof(TCM_NAMES) / sizeof(TCM_NAMES[0]); i++) {
+    if (header.tcm_placements & (1u << i)) {
+      printf(" %s", TCM_NAMES[i]);
+      placed++;
+    }
+  }
+  printf("%s\n", placed ? "" : " none");
+  return 0;
+}